@@ -0,0 +1,454 @@
+import argparse
+import pathlib
+import struct
+import sys
+
+# Builds bootable OFS floppy image with files placed on disk in order they're
+# read by the game, so that files read together share tracks. Also simulates
+# reading files in that order from any OFS image to estimate seek cost.
+
+block_size = 512
+block_count = 1760
+sectors_per_track = 11
+heads = 2
+blocks_per_cylinder = sectors_per_track * heads
+root_block = block_count // 2
+bitmap_block = root_block + 1
+root_track = root_block // sectors_per_track
+ht_size = 72
+ofs_data_size = block_size - 24
+name_max = 30
+
+t_header = 2
+t_data = 8
+t_list = 16
+st_root = 1
+st_userdir = 2
+st_file = 0xFFFFFFFD
+
+# Standard install bootblock: finds dos.library and returns its init
+boot_code = bytes.fromhex(
+    "43fa00184eaeffa04a80670a2040206800167000"
+    "4e7570ff60fa646f732e6c6962726172790000"
+)
+
+# Rough trackdisk timings for estimate, in ms
+step_time = 3
+settle_time = 15
+track_read_time = 200
+
+class AdfError(Exception):
+    pass
+
+def name_hash(name: str) -> int:
+    value = len(name)
+    for char in name.upper():
+        value = (value * 13 + ord(char)) & 0x7FF
+    return value % ht_size
+
+def block_checksum(block: bytearray, offset: int = 20) -> int:
+    struct.pack_into(">L", block, offset, 0)
+    total = sum(struct.unpack(">128L", block)) & 0xFFFFFFFF
+    return -total & 0xFFFFFFFF
+
+def boot_checksum(boot: bytearray) -> int:
+    struct.pack_into(">L", boot, 4, 0)
+    total = 0
+    for value in struct.unpack(">256L", boot):
+        total += value
+        if total > 0xFFFFFFFF:
+            total = (total + 1) & 0xFFFFFFFF
+    return ~total & 0xFFFFFFFF
+
+def pack_name(block: bytearray, offset: int, name: str):
+    encoded = name.encode("latin-1")
+    block[offset] = len(encoded)
+    block[offset + 1:offset + 1 + len(encoded)] = encoded
+
+def unpack_name(block: bytes, offset: int) -> str:
+    return block[offset + 1:offset + 1 + min(block[offset], name_max)].decode("latin-1")
+
+def cylinder_of(block: int) -> int:
+    return block // blocks_per_cylinder
+
+#---------------------------------------------------------------------- LAYOUT
+
+def read_order(order_path: pathlib.Path, executable: str) -> list:
+    # Returns list of (section, path) pairs
+    order = []
+    section = ""
+    for line in order_path.read_text().splitlines():
+        line = line.strip()
+        if not line or line.startswith("#"):
+            continue
+        if line.startswith("[") and line.endswith("]"):
+            section = line[1:-1]
+            continue
+        order.append((section, line.replace("$EXECUTABLE", executable)))
+    return order
+
+def collect_files(root: pathlib.Path) -> list:
+    # Directory traversal order, same as most image tools use
+    files = []
+    for path in sorted(root.iterdir(), key=lambda path: path.name.lower()):
+        if path.is_dir():
+            files += collect_files(path)
+        else:
+            files.append(path)
+    return files
+
+class Allocator:
+    def __init__(self):
+        self.used = {0, 1, root_block, bitmap_block}
+
+    def next(self) -> int:
+        # Upwards from root, then from disk start, as AmigaDOS does
+        for block in list(range(root_block, block_count)) + list(range(2, root_block)):
+            if block not in self.used:
+                self.used.add(block)
+                return block
+        raise AdfError("disk full")
+
+    def take_near_root(self, count: int) -> list:
+        # Contiguous run spanning fewest tracks, as close to root as possible,
+        # so that small files end up on root track
+        free_before = [0]
+        for block in range(block_count):
+            free_before.append(free_before[-1] + (block not in self.used))
+        best = None
+        for start in range(2, block_count - count + 1):
+            if free_before[start + count] - free_before[start] == count:
+                end = start + count - 1
+                cost = (
+                    end // sectors_per_track - start // sectors_per_track,
+                    max(
+                        abs(start // sectors_per_track - root_track),
+                        abs(end // sectors_per_track - root_track)
+                    ),
+                    max(abs(start - root_block), abs(end - root_block))
+                )
+                if best is None or cost < best[0]:
+                    best = (cost, start)
+        if best is None:
+            return [self.next() for _ in range(count)]
+        run = list(range(best[1], best[1] + count))
+        self.used.update(run)
+        return run
+
+def get_file_block_count(size: int) -> int:
+    # Data blocks and extension blocks, not counting header
+    data_count = (size + ofs_data_size - 1) // ofs_data_size
+    return data_count + max(0, (data_count - 1) // ht_size)
+
+def build_image(root: pathlib.Path, files: list, label: str, is_ordered: bool) -> bytes:
+    image = bytearray(block_count * block_size)
+    allocator = Allocator()
+    blocks = {}
+
+    def new_block(number: int) -> bytearray:
+        blocks[number] = bytearray(block_size)
+        return blocks[number]
+
+    # Directory headers are placed next to root, so that path lookups don't seek
+    dirs = {pathlib.PurePosixPath("."): root_block}
+    entries = {root_block: []}
+    for path in files:
+        rel = pathlib.PurePosixPath(path.relative_to(root).as_posix())
+        for parent in reversed(rel.parents[:-1]):
+            if parent not in dirs:
+                dirs[parent] = allocator.next()
+                entries[dirs[parent]] = []
+                entries[dirs[parent.parent]].append((parent.name, dirs[parent]))
+
+    # When ordered, files read first are placed closest to root, on both sides
+    # of it, so that seeks back to root for next lookup are short. Otherwise
+    # files are placed one after another.
+    runs = {}
+    for path in files:
+        count = 1 + get_file_block_count(path.stat().st_size)
+        if is_ordered:
+            runs[path] = allocator.take_near_root(count)
+        else:
+            runs[path] = [allocator.next() for _ in range(count)]
+
+    for path in files:
+        rel = pathlib.PurePosixPath(path.relative_to(root).as_posix())
+        data = path.read_bytes()
+        parent_block = dirs[rel.parent]
+        if len(rel.name) > name_max:
+            raise AdfError("{}: name too long".format(rel))
+        header_number, *run = runs[path]
+        entries[parent_block].append((rel.name, header_number))
+
+        # Extension blocks are placed right before data blocks they list,
+        # so that file is read in single sweep
+        chunks = [data[i:i + ofs_data_size] for i in range(0, len(data), ofs_data_size)]
+        table_blocks = [header_number]
+        data_numbers = []
+        for i in range(len(chunks)):
+            if i and i % ht_size == 0:
+                table_blocks.append(run.pop(0))
+            data_numbers.append(run.pop(0))
+
+        for i, chunk in enumerate(chunks):
+            block = new_block(data_numbers[i])
+            next_data = data_numbers[i + 1] if i + 1 < len(chunks) else 0
+            struct.pack_into(">6L", block, 0, t_data, header_number, i + 1, len(chunk), next_data, 0)
+            block[24:24 + len(chunk)] = chunk
+
+        for table_index, table_number in enumerate(table_blocks):
+            block = new_block(table_number)
+            listed = data_numbers[table_index * ht_size:(table_index + 1) * ht_size]
+            next_table = table_blocks[table_index + 1] if table_index + 1 < len(table_blocks) else 0
+            is_header = table_index == 0
+            struct.pack_into(
+                ">5L", block, 0, t_header if is_header else t_list, table_number,
+                len(listed), 0, listed[0] if is_header and listed else 0
+            )
+            for i, number in enumerate(listed):
+                struct.pack_into(">L", block, 24 + (ht_size - 1 - i) * 4, number)
+            if is_header:
+                struct.pack_into(">L", block, 0x144, len(data))
+                pack_name(block, 0x1B0, rel.name)
+            struct.pack_into(
+                ">LLL", block, 0x1F4, parent_block if is_header else header_number, next_table, st_file
+            )
+
+    for rel, number in dirs.items():
+        if number == root_block:
+            continue
+        block = new_block(number)
+        struct.pack_into(">2L", block, 0, t_header, number)
+        pack_name(block, 0x1B0, rel.name)
+        struct.pack_into(">LL", block, 0x1F4, dirs[rel.parent], 0)
+        struct.pack_into(">L", block, 0x1FC, st_userdir)
+
+    root_header = new_block(root_block)
+    struct.pack_into(">4L", root_header, 0, t_header, 0, 0, ht_size)
+    struct.pack_into(">LL", root_header, 0x138, 0xFFFFFFFF, bitmap_block)
+    pack_name(root_header, 0x1B0, label[:name_max])
+    struct.pack_into(">L", root_header, 0x1FC, st_root)
+
+    # Hash tables with chains sorted by block number
+    for dir_number, dir_entries in entries.items():
+        buckets = {}
+        for name, number in dir_entries:
+            buckets.setdefault(name_hash(name), []).append(number)
+        for bucket, numbers in buckets.items():
+            numbers.sort()
+            struct.pack_into(">L", blocks[dir_number], 24 + bucket * 4, numbers[0])
+            for number, next_number in zip(numbers, numbers[1:]):
+                struct.pack_into(">L", blocks[number], 0x1F0, next_number)
+
+    for block in blocks.values():
+        struct.pack_into(">L", block, 20, block_checksum(block))
+
+    bitmap = new_block(bitmap_block)
+    for number in range(2, block_count):
+        if number not in allocator.used:
+            index = number - 2
+            offset = 4 + (index // 32) * 4
+            value = struct.unpack_from(">L", bitmap, offset)[0] | (1 << (index % 32))
+            struct.pack_into(">L", bitmap, offset, value)
+    struct.pack_into(">L", bitmap, 0, block_checksum(bitmap, 0))
+
+    for number, block in blocks.items():
+        image[number * block_size:(number + 1) * block_size] = block
+
+    boot = bytearray(2 * block_size)
+    boot[0:4] = b"DOS\0"
+    struct.pack_into(">L", boot, 8, root_block)
+    boot[12:12 + len(boot_code)] = boot_code
+    struct.pack_into(">L", boot, 4, boot_checksum(boot))
+    image[0:len(boot)] = boot
+    return bytes(image)
+
+#-------------------------------------------------------------------- SIMULATE
+
+class Disk:
+    def __init__(self, image: bytes):
+        if len(image) != block_count * block_size or image[0:3] != b"DOS" or image[3] != 0:
+            raise AdfError("not an OFS DD floppy image")
+        self.image = image
+        boot = bytearray(image[:2 * block_size])
+        checksum = struct.unpack_from(">L", boot, 4)[0]
+        if boot_checksum(boot) != checksum:
+            raise AdfError("bad bootblock checksum")
+
+    def block(self, number: int, expected_type: int, expected_sec_type: int = None) -> bytes:
+        if not 2 <= number < block_count:
+            raise AdfError("block {} out of range".format(number))
+        block = bytearray(self.image[number * block_size:(number + 1) * block_size])
+        checksum = struct.unpack_from(">L", block, 20)[0]
+        if block_checksum(block) != checksum:
+            raise AdfError("bad checksum in block {}".format(number))
+        block_type = struct.unpack_from(">L", block, 0)[0]
+        sec_type = struct.unpack_from(">L", block, 0x1FC)[0]
+        if block_type != expected_type or (expected_sec_type is not None and sec_type != expected_sec_type):
+            raise AdfError("block {} has type {}/{:X}".format(number, block_type, sec_type))
+        return bytes(block)
+
+    def lookup(self, path: str, reads: list) -> int:
+        # Returns file header block, appending every block read on the way
+        current = root_block
+        reads.append(current)
+        parts = path.split("/")
+        for depth, name in enumerate(parts):
+            dir_block = self.block(current, t_header)
+            number = struct.unpack_from(">L", dir_block, 24 + name_hash(name) * 4)[0]
+            is_last = depth == len(parts) - 1
+            while number:
+                reads.append(number)
+                entry = self.block(number, t_header)
+                if unpack_name(entry, 0x1B0).upper() == name.upper():
+                    sec_type = struct.unpack_from(">L", entry, 0x1FC)[0]
+                    if sec_type != (st_file if is_last else st_userdir):
+                        raise AdfError("{}: wrong entry type".format(path))
+                    break
+                number = struct.unpack_from(">L", entry, 0x1F0)[0]
+            if not number:
+                raise AdfError("{}: not found".format(path))
+            current = number
+        return current
+
+    def read_file(self, header_number: int, reads: list) -> bytes:
+        header = self.block(header_number, t_header, st_file)
+        size = struct.unpack_from(">L", header, 0x144)[0]
+        data = bytearray()
+        table = header
+        table_index = 0
+        expected_seq = 1
+        while len(data) < size:
+            if table_index == ht_size:
+                next_table = struct.unpack_from(">L", table, 0x1F8)[0]
+                reads.append(next_table)
+                table = self.block(next_table, t_list, st_file)
+                table_index = 0
+            number = struct.unpack_from(">L", table, 24 + (ht_size - 1 - table_index) * 4)[0]
+            table_index += 1
+            reads.append(number)
+            block = self.block(number, t_data)
+            owner, seq, length = struct.unpack_from(">3L", block, 4)
+            if owner != header_number or seq != expected_seq or not 0 < length <= ofs_data_size:
+                raise AdfError("bad data block {}".format(number))
+            data += block[24:24 + length]
+            expected_seq += 1
+        if len(data) != size:
+            raise AdfError("file size mismatch in {}".format(header_number))
+        return bytes(data)
+
+class Drive:
+    def __init__(self):
+        # Bootblock was just read from track 0
+        self.track = 0
+        self.steps = 0
+        self.seeks = 0
+        self.track_reads = 1
+
+    def read(self, block: int):
+        # Trackdisk keeps last read track in buffer, other ones are read whole
+        track = block // sectors_per_track
+        if track == self.track:
+            return
+        distance = abs(cylinder_of(block) - self.track // heads)
+        if distance:
+            self.steps += distance
+            self.seeks += 1
+        self.track = track
+        self.track_reads += 1
+
+    def get_time(self) -> int:
+        return self.steps * step_time + self.seeks * settle_time + self.track_reads * track_read_time
+
+def simulate(image: bytes, order: list, verify_root: pathlib.Path = None) -> list:
+    # Returns stats for each section, with drive state carried between them
+    disk = Disk(image)
+    drive = Drive()
+    stats = []
+    for section, path in order:
+        if not stats or stats[-1]["section"] != section:
+            stats.append({
+                "section": section, "steps": drive.steps, "seeks": drive.seeks,
+                "track_reads": drive.track_reads, "time": drive.get_time()
+            })
+        reads = []
+        data = disk.read_file(disk.lookup(path, reads), reads)
+        if verify_root and (verify_root / path).read_bytes() != data:
+            raise AdfError("{}: content differs from source file".format(path))
+        for block in reads:
+            drive.read(block)
+    stats.append({
+        "section": None, "steps": drive.steps, "seeks": drive.seeks,
+        "track_reads": drive.track_reads, "time": drive.get_time()
+    })
+    return [
+        {
+            "section": start["section"], "steps": end["steps"] - start["steps"],
+            "seeks": end["seeks"] - start["seeks"],
+            "track_reads": end["track_reads"] - start["track_reads"],
+            "time": end["time"] - start["time"]
+        }
+        for start, end in zip(stats, stats[1:])
+    ]
+
+#------------------------------------------------------------------------ MAIN
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Build or simulate seek-ordered floppy image")
+    parser.add_argument("--order", type=pathlib.Path, required=True, help="file access order")
+    parser.add_argument("--executable", required=True, help="substituted for $EXECUTABLE")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    build = commands.add_parser("build", help="build image from directory")
+    build.add_argument("image", type=pathlib.Path)
+    build.add_argument("root", type=pathlib.Path, help="directory with disk contents")
+    build.add_argument("--label", default="slipgates")
+    build.add_argument(
+        "--unordered", action="store_true",
+        help="place files in directory order, one after another, for comparison"
+    )
+
+    report = commands.add_parser("simulate", help="estimate seeks when reading files in order")
+    report.add_argument("images", nargs="+", type=pathlib.Path)
+    report.add_argument("--verify", type=pathlib.Path, help="compare read files with this directory")
+    args = parser.parse_args()
+
+    order = read_order(args.order, args.executable)
+    try:
+        if args.command == "build":
+            files = collect_files(args.root)
+            if not args.unordered:
+                # Files missing from order are placed after listed ones
+                ordered = []
+                for _, path in order:
+                    full_path = args.root / path
+                    if not full_path.is_file():
+                        print("{}: listed in order but missing".format(path), file=sys.stderr)
+                        return 1
+                    if full_path not in ordered:
+                        ordered.append(full_path)
+                files = ordered + [path for path in files if path not in ordered]
+            args.image.write_bytes(build_image(args.root, files, args.label, not args.unordered))
+            print("Wrote {}, {} files".format(args.image, len(files)))
+            return 0
+
+        for image_path in args.images:
+            print("{}:".format(image_path))
+            stats = simulate(image_path.read_bytes(), order, args.verify)
+            for section in stats + [{
+                "section": "total", **{
+                    key: sum(section[key] for section in stats)
+                    for key in ("steps", "seeks", "track_reads", "time")
+                }
+            }]:
+                print("  {:8} {:4} track reads, {:3} seeks, {:4} cylinders stepped, ~{:.1f} s".format(
+                    section["section"] or "-", section["track_reads"], section["seeks"],
+                    section["steps"], section["time"] / 1000
+                ))
+    except AdfError as error:
+        print(error, file=sys.stderr)
+        return 1
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
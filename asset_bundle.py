@@ -0,0 +1,260 @@
+import argparse
+import pathlib
+import struct
+import sys
+
+# Packs ACE .bm bitmaps into single bundle read by assetsGameCreate(),
+# optionally compressing their plane data, or verifies existing bundle
+# against them. Keep in sync with ASSETS_BUNDLE_* in src/assets.c.
+
+bundle_magic = b"SLBN"
+header_size = 8
+entry_size = 32
+entry_name_size = 16
+entries_max = 16
+
+entry_flag_interleaved = 1
+entry_flag_packed = 2
+
+bm_header_size = 9
+bm_flag_interleaved = 1
+
+# Packed stream: control byte with literal run or back-reference into already
+# unpacked bitmap data, followed by literal bytes or big-endian offset
+lz_match = 0x80
+lz_count_mask = 0x7F
+lz_literal_max = lz_count_mask + 1
+lz_match_min = 3
+lz_match_max = lz_count_mask + lz_match_min
+lz_offset_max = 0xFFFF
+lz_chain_max = 256
+
+class BundleError(Exception):
+    pass
+
+def bm_data_size(width: int, height: int, depth: int) -> int:
+    return ((width + 15) // 16) * 2 * height * depth
+
+def read_bm(path: pathlib.Path) -> dict:
+    data = path.read_bytes()
+    if len(data) < bm_header_size:
+        raise BundleError("{}: truncated header".format(path))
+    width, height, depth, _version, flags = struct.unpack_from(">HHBBB", data)
+    size = bm_data_size(width, height, depth)
+    if not 1 <= depth <= 8 or len(data) != bm_header_size + size:
+        raise BundleError("{}: expected {} data bytes for {}x{}x{}, got {}".format(
+            path, size, width, height, depth, len(data) - bm_header_size
+        ))
+    name = path.stem.encode("ascii")
+    if len(name) >= entry_name_size:
+        raise BundleError("{}: name longer than {} chars".format(path, entry_name_size - 1))
+    return {
+        "name": name, "width": width, "height": height, "depth": depth,
+        "flags": flags & bm_flag_interleaved, "data": data[bm_header_size:]
+    }
+
+def lz_pack(data: bytes) -> bytes:
+    out = bytearray()
+    literals = bytearray()
+    chains = {}
+
+    def flush_literals():
+        while literals:
+            chunk = literals[:lz_literal_max]
+            del literals[:lz_literal_max]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+
+    def insert(pos: int):
+        if pos + lz_match_min <= len(data):
+            chains.setdefault(data[pos:pos + lz_match_min], []).append(pos)
+
+    pos = 0
+    while pos < len(data):
+        best_length = 0
+        best_offset = 0
+        candidates = chains.get(data[pos:pos + lz_match_min], [])
+        for ref in reversed(candidates[-lz_chain_max:]):
+            offset = pos - ref
+            if offset > lz_offset_max:
+                break
+            # Matches may overlap with themselves, same as in unpacker
+            length = 0
+            while (
+                length < lz_match_max and pos + length < len(data) and
+                data[ref + length] == data[pos + length]
+            ):
+                length += 1
+            if length > best_length:
+                best_length = length
+                best_offset = offset
+                if length == lz_match_max:
+                    break
+
+        if best_length < lz_match_min:
+            literals.append(data[pos])
+            insert(pos)
+            pos += 1
+            continue
+
+        flush_literals()
+        out.append(lz_match | (best_length - lz_match_min))
+        out.extend(struct.pack(">H", best_offset))
+        for i in range(best_length):
+            insert(pos + i)
+        pos += best_length
+    flush_literals()
+    return bytes(out)
+
+def lz_unpack(packed: bytes, size: int) -> bytes:
+    out = bytearray()
+    pos = 0
+    while len(out) < size and pos < len(packed):
+        control = packed[pos]
+        pos += 1
+        if control & lz_match:
+            length = (control & lz_count_mask) + lz_match_min
+            offset = struct.unpack_from(">H", packed, pos)[0] if pos + 2 <= len(packed) else 0
+            pos += 2
+            if not 0 < offset <= len(out):
+                raise BundleError("back-reference before start of bitmap")
+            for _ in range(length):
+                out.append(out[-offset])
+        else:
+            length = control + 1
+            out += packed[pos:pos + length]
+            pos += length
+    if len(out) != size or pos != len(packed):
+        raise BundleError("malformed packed bitmap")
+    return bytes(out)
+
+def pack(bitmaps: list, compress: bool) -> bytes:
+    directory = bytearray()
+    blob = bytearray()
+    for bitmap in bitmaps:
+        flags = bitmap["flags"]
+        stored = bitmap["data"]
+        if compress:
+            packed = lz_pack(stored)
+            # Round-trip before trusting it
+            if lz_unpack(packed, len(stored)) != stored:
+                raise BundleError("{}: compression round-trip failed".format(
+                    bitmap["name"].decode()
+                ))
+            if len(packed) < len(stored):
+                flags |= entry_flag_packed
+                stored = packed
+            print("{}: {} -> {} bytes".format(
+                bitmap["name"].decode(), len(bitmap["data"]), len(stored)
+            ))
+
+        # Data is stored in directory order, so that it's read sequentially
+        directory += struct.pack(
+            ">{}sHHBBHLL".format(entry_name_size), bitmap["name"],
+            bitmap["width"], bitmap["height"], bitmap["depth"], flags, 0,
+            len(stored), len(bitmap["data"])
+        )
+        blob += stored
+    header = bundle_magic + struct.pack(">HH", len(bitmaps), 0)
+    return bytes(header + directory + blob)
+
+def unpack(bundle: bytes) -> dict:
+    if len(bundle) < header_size or not bundle.startswith(bundle_magic):
+        raise BundleError("not a bitmap bundle")
+    count = struct.unpack_from(">H", bundle, 4)[0]
+    data_start = header_size + count * entry_size
+    if not 1 <= count <= entries_max or len(bundle) < data_start:
+        raise BundleError("bad entry count: {}".format(count))
+
+    bitmaps = {}
+    pos = data_start
+    for i in range(count):
+        name, width, height, depth, flags, _, stored_size, size = struct.unpack_from(
+            ">{}sHHBBHLL".format(entry_name_size), bundle, header_size + i * entry_size
+        )
+        name = name.rstrip(b"\0")
+        if name in bitmaps:
+            raise BundleError("duplicate entry: {}".format(name.decode()))
+        if size != bm_data_size(width, height, depth):
+            raise BundleError("{}: bad size".format(name.decode()))
+        if pos + stored_size > len(bundle):
+            raise BundleError("{}: data past end of bundle".format(name.decode()))
+        stored = bundle[pos:pos + stored_size]
+        pos += stored_size
+        if flags & entry_flag_packed:
+            data = lz_unpack(stored, size)
+        elif stored_size == size:
+            data = stored
+        else:
+            raise BundleError("{}: bad stored size".format(name.decode()))
+        bitmaps[name] = {
+            "name": name, "width": width, "height": height, "depth": depth,
+            "flags": flags & entry_flag_interleaved, "data": data
+        }
+    if pos != len(bundle):
+        raise BundleError("{} trailing bytes".format(len(bundle) - pos))
+    return bitmaps
+
+def verify(bundle: bytes, bitmaps: list) -> list:
+    errors = []
+    packed = unpack(bundle)
+    for bitmap in bitmaps:
+        name = bitmap["name"].decode()
+        entry = packed.pop(bitmap["name"], None)
+        if entry is None:
+            errors.append("{}: missing from bundle".format(name))
+            continue
+        for field in ("width", "height", "depth", "flags"):
+            if entry[field] != bitmap[field]:
+                errors.append("{}: {} is {}, expected {}".format(
+                    name, field, entry[field], bitmap[field]
+                ))
+        if entry["data"] != bitmap["data"]:
+            first_diff = next(
+                i for i, (a, b) in enumerate(zip(entry["data"], bitmap["data"])) if a != b
+            )
+            errors.append("{}: data differs at byte {}".format(name, first_diff))
+    for name in packed:
+        errors.append("{}: not in source bitmaps".format(name.decode()))
+    return errors
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Pack bitmaps into single bundle")
+    parser.add_argument("bundle", type=pathlib.Path, help="bundle path")
+    parser.add_argument("bitmaps", nargs="+", type=pathlib.Path, help=".bm files to pack")
+    parser.add_argument("--compress", action="store_true", help="compress bitmap data")
+    parser.add_argument(
+        "--verify", action="store_true",
+        help="compare existing bundle byte-for-byte against given files instead of packing"
+    )
+    args = parser.parse_args()
+
+    if len(args.bitmaps) > entries_max:
+        print("Too many bitmaps: {}, max {}".format(len(args.bitmaps), entries_max), file=sys.stderr)
+        return 1
+    try:
+        bitmaps = [read_bm(path) for path in args.bitmaps]
+        if args.verify:
+            errors = verify(args.bundle.read_bytes(), bitmaps)
+            for error in errors:
+                print(error, file=sys.stderr)
+            if errors:
+                return 1
+            print("Bundle matches {} bitmaps".format(len(bitmaps)))
+            return 0
+
+        bundle = pack(bitmaps, args.compress)
+    except BundleError as error:
+        print(error, file=sys.stderr)
+        return 1
+    args.bundle.write_bytes(bundle)
+    size_raw = sum(len(bitmap["data"]) for bitmap in bitmaps)
+    size_stored = len(bundle) - header_size - len(bitmaps) * entry_size
+    print("Packed {} bitmaps, {} bytes".format(len(bitmaps), len(bundle)))
+    print("Bitmap data {} -> {} bytes, ratio {:.3f}".format(
+        size_raw, size_stored, size_stored / size_raw
+    ))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
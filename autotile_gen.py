@@ -0,0 +1,829 @@
+import os
+import re
+import struct
+import sys
+
+import level_convert
+import level_pack
+
+# Compiles autotile rules into lookup tables used by autotileGetVisTile().
+#
+# Each neighbour tile is reduced to a class, each (center kind, direction, class)
+# contributes signature bits, and the signature indexes the kind's part of
+# a dense vis tile table. Neighbourhoods with gateways, pipes, exits and such
+# next to walls/bg are rare and have too many combinations for a dense table -
+# their signatures get the escape bit and autotile.c resolves them with code
+# before falling back to the table.
+#
+# Usage:
+#   autotile_gen.py path/to/autotile_lut.h   - generate tables
+#   autotile_gen.py --verify paths...         - check tables on levels, given as
+#                                              level files, dirs or level packs
+
+script_dir = os.path.dirname(os.path.abspath(__file__))
+
+def parse_enum(path, enum_name):
+    with open(path) as file_in:
+        src = file_in.read()
+    body = re.search(r"typedef enum " + enum_name + r" \{(.*?)\} " + enum_name, src, re.S).group(1)
+    values = {}
+    next_value = 0
+    for line in body.split("\n"):
+        line = line.split("//")[0].strip().rstrip(",")
+        if not line:
+            continue
+        if "=" in line:
+            name, expr = [part.strip() for part in line.split("=", 1)]
+            next_value = eval_tile_expr(expr, values)
+        else:
+            name = line
+        values[name] = next_value
+        next_value += 1
+    return values
+
+tile_layers = {
+    "TILE_LAYER_WALLS": 1 << 15,
+    "TILE_LAYER_GRATES": 1 << 14,
+    "TILE_LAYER_LETHALS": 1 << 13,
+    "TILE_LAYER_SLIPGATES": 1 << 12,
+    "TILE_LAYER_SLIPGATABLE": 1 << 11,
+    "TILE_LAYER_EXIT": 1 << 10,
+    "TILE_LAYER_BUTTON": 1 << 9,
+    "TILE_LAYER_ACTIVE_TURRET": 1 << 8,
+}
+
+def eval_tile_expr(expr, values):
+    result = 0
+    for part in expr.split("|"):
+        part = part.strip()
+        if part in tile_layers:
+            result |= tile_layers[part]
+        elif part in values:
+            result |= values[part]
+        else:
+            result |= int(part, 0)
+    return result
+
+tiles = parse_enum(os.path.join(script_dir, "src", "tile.h"), "tTile")
+vis_tiles = parse_enum(os.path.join(script_dir, "src", "vis_tile.h"), "tVisTile")
+vis_tile_names = {}
+for name, value in vis_tiles.items():
+    vis_tile_names.setdefault(value, name)
+
+tile_index_count = 32
+tile_index_mask = 0xFF
+tile_codes = {}
+for name, code in tiles.items():
+    tile_codes[code & tile_index_mask] = code
+tile_names = {code: name for name, code in tiles.items()}
+
+def index_of(name):
+    return tiles[name] & tile_index_mask
+
+map_width = 40
+map_height = 32
+unhandled = 0xFF
+
+# Directions in NEIGHBOR_FLAG bit order
+dir_n, dir_ne, dir_e, dir_se, dir_s, dir_sw, dir_w, dir_nw = range(8)
+dir_offsets = [(0, -1), (1, -1), (1, 0), (1, 1), (0, 1), (-1, 1), (-1, 0), (-1, -1)]
+dirs_orth = [dir_n, dir_e, dir_s, dir_w]
+dirs_diag = [dir_ne, dir_se, dir_sw, dir_nw]
+mask_orth = sum(1 << d for d in dirs_orth)
+
+#------------------------------------------------------------------- PREDICATES
+
+gateway_kinds = [
+    ("TILE_DOOR_CLOSED", "VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP"),
+    ("TILE_DOOR_OPEN", "VIS_TILE_DOOR_LEFT_OPEN_WALL_TOP"),
+    ("TILE_GRATE", "VIS_TILE_GRATE_LEFT_WALL_TOP"),
+    ("TILE_DEATH_FIELD", "VIS_TILE_DEATH_FIELD_LEFT_WALL_TOP"),
+]
+gateway_fronts = [index_of(front) for front, _ in gateway_kinds]
+
+def is_slipgate(index):
+    return (tile_codes[index] & tile_layers["TILE_LAYER_SLIPGATES"]) != 0
+
+def is_button(index):
+    return (tile_codes[index] & tile_layers["TILE_LAYER_BUTTON"]) != 0
+
+def is_exit(index):
+    return (tile_codes[index] & tile_layers["TILE_LAYER_EXIT"]) != 0
+
+# Same as mapTileIsOnWall()
+def is_on_wall(index):
+    return (
+        is_slipgate(index) or is_button(index) or is_exit(index) or index in [
+            index_of("TILE_WALL_BLOCKED"), index_of("TILE_WALL"),
+            index_of("TILE_SPIKES_OFF_FLOOR"), index_of("TILE_SPIKES_ON_FLOOR"),
+            index_of("TILE_RECEIVER"), index_of("TILE_BOUNCER_SPAWNER"),
+            index_of("TILE_PIPE"),
+        ]
+    )
+
+def is_tile(name):
+    return lambda index, center: index == index_of(name)
+
+def on_wall(index, center):
+    return is_on_wall(index)
+
+def same(index, center):
+    return index == center
+
+def is_gateway_front(index, center):
+    return index in gateway_fronts
+
+def is_bg_feature_orth(index, center):
+    return index in [
+        index_of("TILE_BOUNCER_SPAWNER"), index_of("TILE_RECEIVER"), index_of("TILE_PIPE")
+    ]
+
+def is_bg_feature_side(index, center):
+    return is_exit(index)
+
+def is_bg_feature_below(index, center):
+    return index in gateway_fronts or is_button(index)
+
+#------------------------------------------------------------------------ RULES
+
+def vis(name):
+    return vis_tiles[name]
+
+def gateway_vis(first, name):
+    return vis(first) + vis(name) - vis("VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP")
+
+wall_shapes = {
+    "E SE S SW W": "VIS_TILE_WALL_CONVEX_N",
+    "S SW W": "VIS_TILE_WALL_CONVEX_NE",
+    "N S SW W NW": "VIS_TILE_WALL_CONVEX_E",
+    "N W NW": "VIS_TILE_WALL_CONVEX_SE",
+    "N NE E W NW": "VIS_TILE_WALL_CONVEX_S",
+    "N NE E": "VIS_TILE_WALL_CONVEX_SW",
+    "N NE E SE S": "VIS_TILE_WALL_CONVEX_W",
+    "E SE S": "VIS_TILE_WALL_CONVEX_NW",
+    "N NE E SE S SW W NW": "VIS_TILE_WALL_1",
+    "N NE E SE W NW": "VIS_TILE_WALL_CONCAVE_N",
+    "N NE E SW W NW": "VIS_TILE_WALL_CONCAVE_N",
+    "N NE E SE S W NW": "VIS_TILE_WALL_CONCAVE_NE",
+    "N NE E SE S NW": "VIS_TILE_WALL_CONCAVE_E",
+    "N NE E SE S SW": "VIS_TILE_WALL_CONCAVE_E",
+    "N NE E SE S SW W": "VIS_TILE_WALL_CONCAVE_SE",
+    "NE E SE S SW W": "VIS_TILE_WALL_CONCAVE_S",
+    "E SE S SW W NW": "VIS_TILE_WALL_CONCAVE_S",
+    "E SE S SW W NW N": "VIS_TILE_WALL_CONCAVE_SW",
+    "SE S SW W NW N": "VIS_TILE_WALL_CONCAVE_W",
+    "S SW W NW N NE": "VIS_TILE_WALL_CONCAVE_W",
+    "S SW W NW N NE E": "VIS_TILE_WALL_CONCAVE_NW",
+}
+
+bg_shapes = {
+    "SE S SW": "VIS_TILE_BG_CONVEX_N",
+    "S SW": "VIS_TILE_BG_CONVEX_N",
+    "SE S": "VIS_TILE_BG_CONVEX_N",
+    "S": "VIS_TILE_BG_CONVEX_N",
+    "SE E NE N NW": "VIS_TILE_BG_CONCAVE_NE",
+    "E NE N NW": "VIS_TILE_BG_CONCAVE_NE",
+    "SE E NE N": "VIS_TILE_BG_CONCAVE_NE",
+    "E NE N": "VIS_TILE_BG_CONCAVE_NE",
+    "SW W NW": "VIS_TILE_BG_CONVEX_E",
+    "W NW": "VIS_TILE_BG_CONVEX_E",
+    "SW W": "VIS_TILE_BG_CONVEX_E",
+    "W": "VIS_TILE_BG_CONVEX_E",
+    "NE E SE S SW": "VIS_TILE_BG_CONCAVE_SE",
+    "E SE S SW": "VIS_TILE_BG_CONCAVE_SE",
+    "NE E SE S": "VIS_TILE_BG_CONCAVE_SE",
+    "E SE S": "VIS_TILE_BG_CONCAVE_SE",
+    "NE N NW": "VIS_TILE_BG_CONVEX_S",
+    "N NW": "VIS_TILE_BG_CONVEX_S",
+    "NE N": "VIS_TILE_BG_CONVEX_S",
+    "N": "VIS_TILE_BG_CONVEX_S",
+    "SE S SW W NW": "VIS_TILE_BG_CONCAVE_SW",
+    "S SW W NW": "VIS_TILE_BG_CONCAVE_SW",
+    "SE S SW W": "VIS_TILE_BG_CONCAVE_SW",
+    "S SW W": "VIS_TILE_BG_CONCAVE_SW",
+    "SE E NE": "VIS_TILE_BG_CONVEX_W",
+    "E NE": "VIS_TILE_BG_CONVEX_W",
+    "SE E": "VIS_TILE_BG_CONVEX_W",
+    "E": "VIS_TILE_BG_CONVEX_W",
+    "SW W NW N NE": "VIS_TILE_BG_CONCAVE_NW",
+    "SW W NW N": "VIS_TILE_BG_CONCAVE_NW",
+    "W NW N NE": "VIS_TILE_BG_CONCAVE_NW",
+    "W NW N": "VIS_TILE_BG_CONCAVE_NW",
+    "SW": "VIS_TILE_BG_CONVEX_NE",
+    "NW": "VIS_TILE_BG_CONVEX_SE",
+    "NE": "VIS_TILE_BG_CONVEX_SW",
+    "SE": "VIS_TILE_BG_CONVEX_NW",
+}
+
+def shape_masks(shapes):
+    dir_names = ["N", "NE", "E", "SE", "S", "SW", "W", "NW"]
+    return {
+        sum(1 << dir_names.index(d) for d in pattern.split()): vis(name)
+        for pattern, name in shapes.items()
+    }
+
+wall_shape_masks = shape_masks(wall_shapes)
+bg_shape_masks = shape_masks(bg_shapes)
+
+def wall_features():
+    return [("wall_" + str(d), [d], on_wall) for d in range(8)]
+
+def rule_wall(bits, is_right):
+    mask = sum(1 << d for d in range(8) if bits["wall_" + str(d)])
+    return wall_shape_masks.get(mask, unhandled)
+
+def rule_wall_blocked(bits, is_right):
+    vis_tile = rule_wall(bits, is_right)
+    if vis_tile == unhandled:
+        return unhandled
+    return vis_tile + vis("VIS_TILE_BLOCKED_WALL_CONVEX_N") - vis("VIS_TILE_WALL_CONVEX_N")
+
+def rule_bg(bits, is_right):
+    mask = sum(1 << d for d in range(8) if bits["wall_" + str(d)])
+    vis_tile = bg_shape_masks.get(mask)
+    if vis_tile is None:
+        return vis("VIS_TILE_BG_1")
+    if bits["blocked_orth"] or ((mask & mask_orth) == 0 and bits["blocked_diag"]):
+        return vis_tile + vis("VIS_TILE_BLOCKED_BG_CONVEX_N") - vis("VIS_TILE_BG_CONVEX_N")
+    return vis_tile
+
+def rule_first_missing(order, default):
+    def rule(bits, is_right):
+        for feature, name in order:
+            if not bits[feature]:
+                return vis(name)
+        return vis(default)
+    return rule
+
+def rule_pipe(bits, is_right):
+    n, e, s, w = bits["pipe_n"], bits["pipe_e"], bits["pipe_s"], bits["pipe_w"]
+    if n and s and w and e:
+        return vis("VIS_TILE_PIPE_NESW")
+    if n and s:
+        return vis("VIS_TILE_PIPE_NS")
+    if w and e:
+        return vis("VIS_TILE_PIPE_EW")
+    if n:
+        return vis("VIS_TILE_BLOCKED_WALL_PIPE_S" if bits["blocked_w"] else "VIS_TILE_WALL_PIPE_S")
+    if s:
+        return vis("VIS_TILE_BLOCKED_WALL_PIPE_N" if bits["blocked_w"] else "VIS_TILE_WALL_PIPE_N")
+    if w:
+        return vis("VIS_TILE_BLOCKED_WALL_PIPE_E" if bits["blocked_s"] else "VIS_TILE_WALL_PIPE_E")
+    if e:
+        return vis("VIS_TILE_BLOCKED_WALL_PIPE_W" if bits["blocked_s"] else "VIS_TILE_WALL_PIPE_W")
+    return vis("VIS_TILE_BG_1")
+
+def rule_button(bits, is_right):
+    side = "RIGHT" if is_right else "LEFT"
+    return vis("VIS_TILE_BUTTON_WALL_{}_{}".format(side, 1 if bits["same_e"] else 2))
+
+def rule_exit(bits, is_right):
+    side = "RIGHT" if is_right else "LEFT"
+    if not bits["same_n"]:
+        return vis("VIS_TILE_EXIT_WALL_{}_TOP".format(side))
+    if not bits["same_s"]:
+        return vis("VIS_TILE_EXIT_WALL_{}_BOTTOM".format(side))
+    return vis("VIS_TILE_EXIT_WALL_{}_MID".format(side))
+
+def rule_gateway_front(first):
+    def rule(bits, is_right):
+        if bits["same_w"] or bits["same_e"]:
+            if not bits["same_w"]:
+                return gateway_vis(first, "VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_LEFT")
+            if not bits["same_e"]:
+                return gateway_vis(first, "VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_RIGHT")
+            return gateway_vis(first, "VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_MID")
+        side = "RIGHT" if is_right else "LEFT"
+        if not bits["same_n"]:
+            return gateway_vis(first, "VIS_TILE_DOOR_{}_CLOSED_TOP".format(side))
+        if not bits["same_s"]:
+            return gateway_vis(first, "VIS_TILE_DOOR_{}_CLOSED_BOTTOM".format(side))
+        return gateway_vis(first, "VIS_TILE_DOOR_{}_CLOSED_MID".format(side))
+    return rule
+
+def rule_constant(name):
+    return lambda bits, is_right: vis(name)
+
+same_orth = [
+    ("same_n", [dir_n], same), ("same_e", [dir_e], same),
+    ("same_s", [dir_s], same), ("same_w", [dir_w], same),
+]
+
+# Center kinds: tiles, features and a rule picking vis tile from feature values.
+# Feature is set if its predicate holds for any neighbour in given directions.
+# Features named "escape" mark neighbourhoods resolved by code in autotile.c.
+# Kinds marked "bitboard" only look at wall and blocked wall neighbours unless
+# there's a feature tile nearby, so their signatures can be built from column
+# bitmasks in autotileRecalcAllVisTiles().
+kinds = [
+    {
+        "name": "wall", "tiles": ["TILE_WALL"], "uses_half": False, "bitboard": True,
+        "features": wall_features() + [("escape", dirs_orth, is_gateway_front)],
+        "rule": rule_wall,
+    },
+    {
+        "name": "wall_blocked", "tiles": ["TILE_WALL_BLOCKED"], "uses_half": False, "bitboard": True,
+        "features": wall_features() + [("escape", dirs_orth, is_gateway_front)],
+        "rule": rule_wall_blocked,
+    },
+    {
+        "name": "bg", "tiles": ["TILE_BG"], "uses_half": False, "bitboard": True,
+        "features": wall_features() + [
+            ("blocked_orth", dirs_orth, is_tile("TILE_WALL_BLOCKED")),
+            ("blocked_diag", dirs_diag, is_tile("TILE_WALL_BLOCKED")),
+            ("escape", dirs_orth, is_bg_feature_orth),
+            ("escape", [dir_w, dir_e], is_bg_feature_side),
+            ("escape", [dir_s], is_bg_feature_below),
+        ],
+        "rule": rule_bg,
+    },
+    {
+        "name": "bouncer_spawner", "tiles": ["TILE_BOUNCER_SPAWNER"], "uses_half": False,
+        "features": [
+            ("wall_n", [dir_n], on_wall), ("wall_e", [dir_e], on_wall),
+            ("wall_s", [dir_s], on_wall), ("wall_w", [dir_w], on_wall),
+        ],
+        "rule": rule_first_missing([
+            ("wall_s", "VIS_TILE_BOUNCER_SPAWNER_WALL_DOWN"),
+            ("wall_n", "VIS_TILE_BOUNCER_SPAWNER_WALL_UP"),
+            ("wall_e", "VIS_TILE_BOUNCER_SPAWNER_WALL_RIGHT"),
+            ("wall_w", "VIS_TILE_BOUNCER_SPAWNER_WALL_LEFT"),
+        ], "VIS_TILE_BG_1"),
+    },
+    {
+        "name": "receiver", "tiles": ["TILE_RECEIVER"], "uses_half": False,
+        "features": [
+            ("wall_n", [dir_n], on_wall), ("wall_e", [dir_e], on_wall),
+            ("wall_s", [dir_s], on_wall), ("wall_w", [dir_w], on_wall),
+        ],
+        "rule": rule_first_missing([
+            ("wall_s", "VIS_TILE_RECEIVER_WALL_DOWN"),
+            ("wall_n", "VIS_TILE_RECEIVER_WALL_UP"),
+            ("wall_e", "VIS_TILE_RECEIVER_WALL_RIGHT"),
+            ("wall_w", "VIS_TILE_RECEIVER_WALL_LEFT"),
+        ], "VIS_TILE_BG_1"),
+    },
+    {
+        "name": "pipe", "tiles": ["TILE_PIPE"], "uses_half": False,
+        "features": [
+            ("pipe_n", [dir_n], same), ("pipe_e", [dir_e], same),
+            ("pipe_s", [dir_s], same), ("pipe_w", [dir_w], same),
+            ("blocked_w", [dir_w], is_tile("TILE_WALL_BLOCKED")),
+            ("blocked_s", [dir_s], is_tile("TILE_WALL_BLOCKED")),
+        ],
+        "rule": rule_pipe,
+    },
+    {
+        "name": "button",
+        "tiles": ["TILE_BUTTON_" + letter for letter in "ABCDEFGH"], "uses_half": True,
+        "features": [("same_e", [dir_e], same)],
+        "rule": rule_button,
+    },
+    {
+        "name": "exit", "tiles": ["TILE_EXIT", "TILE_EXIT_HUB"], "uses_half": True,
+        "features": [("same_n", [dir_n], same), ("same_s", [dir_s], same)],
+        "rule": rule_exit,
+    },
+] + [
+    {
+        "name": "gateway_" + front[len("TILE_"):].lower(), "tiles": [front], "uses_half": True,
+        "features": same_orth, "rule": rule_gateway_front(first),
+    } for front, first in gateway_kinds
+] + [
+    {
+        "name": tile[len("TILE_"):].lower(), "tiles": [tile], "uses_half": False,
+        "features": [], "rule": rule_constant(name),
+    } for tile, name in [
+        ("TILE_TURRET_ACTIVE", "VIS_TILE_TURRET_ACTIVE"),
+        ("TILE_TURRET_INACTIVE", "VIS_TILE_TURRET_INACTIVE"),
+        ("TILE_SPIKES_OFF_BG", "VIS_TILE_SPIKES_OFF_BG_1"),
+        ("TILE_SPIKES_OFF_FLOOR", "VIS_TILE_SPIKES_OFF_FLOOR_1"),
+        ("TILE_SPIKES_ON_BG", "VIS_TILE_SPIKES_ON_BG_1"),
+        ("TILE_SPIKES_ON_FLOOR", "VIS_TILE_SPIKES_ON_FLOOR_1"),
+    ]
+]
+
+# Everything else
+kinds.append({
+    "name": "other", "tiles": [], "uses_half": False,
+    "features": [], "rule": rule_constant("VIS_TILE_BG_1"),
+})
+
+#--------------------------------------------------------------------- COMPILER
+
+escape_bit = 1 << 15
+
+def feature_bits(kind):
+    names = []
+    for name, _, _ in kind["features"]:
+        if name != "escape" and name not in names:
+            names.append(name)
+    bits = {name: 1 << i for i, name in enumerate(names)}
+    bits["escape"] = escape_bit
+    half_bit = (1 << len(names)) if kind["uses_half"] else 0
+    sig_size = 1 << (len(names) + (1 if kind["uses_half"] else 0))
+    return names, bits, half_bit, sig_size
+
+def kind_of_center(index):
+    for kind in kinds:
+        if any(index_of(tile) == index for tile in kind["tiles"]):
+            return kind
+    return kinds[-1]
+
+# Neighbour classes - tiles which no predicate can tell apart, unless
+# neighbour is same as center, which gets its own class.
+predicates = [
+    on_wall, is_gateway_front, is_bg_feature_orth, is_bg_feature_side, is_bg_feature_below,
+    is_tile("TILE_WALL_BLOCKED"),
+]
+
+def class_key(index):
+    # "same" is handled by class_same, so center never equals neighbour here
+    return tuple(predicate(index, -1) for predicate in predicates)
+
+class_reps = []
+tile_classes = []
+for index in range(tile_index_count):
+    key = class_key(index)
+    for class_index, rep in enumerate(class_reps):
+        if class_key(rep) == key:
+            break
+    else:
+        class_index = len(class_reps)
+        class_reps.append(index)
+    tile_classes.append(class_index)
+class_same = len(class_reps)
+class_count = class_same + 1
+
+# Bitboard flags - 3x3 window is indexed by left, center and right column
+# bits, lowest bit of each being the row above.
+bitboard_on_wall = 1
+bitboard_blocked = 2
+bitboard_feature = 4
+window_dirs = {
+    dir_nw: 0, dir_w: 1, dir_sw: 2, dir_n: 3, dir_s: 5, dir_ne: 6, dir_e: 7, dir_se: 8
+}
+window_orth = sum(1 << window_dirs[d] for d in dirs_orth)
+window_diag = sum(1 << window_dirs[d] for d in dirs_diag)
+
+def bitboard_flags(index):
+    flags = 0
+    if is_on_wall(index):
+        flags |= bitboard_on_wall
+    if index == index_of("TILE_WALL_BLOCKED"):
+        flags |= bitboard_blocked
+    if any(predicate(index, -1) for predicate in [
+        is_gateway_front, is_bg_feature_orth, is_bg_feature_side, is_bg_feature_below
+    ]):
+        flags |= bitboard_feature
+    return flags
+
+def wall_window_bits(window):
+    # Same as wall_N..wall_NW feature bits of bitboard kinds
+    return sum(1 << d for d in range(8) if window & (1 << window_dirs[d]))
+
+def kind_bitboard_bits(kind):
+    if not kind.get("bitboard"):
+        return 0, 0
+    _, bits, _, _ = feature_bits(kind)
+    return bits.get("blocked_orth", 0), bits.get("blocked_diag", 0)
+
+def kind_bit_map(kind, center):
+    _, bits, _, _ = feature_bits(kind)
+    bit_map = []
+    for d in range(8):
+        row = []
+        for class_index in range(class_count):
+            # Class reps never match center, unless it's the "same" class
+            if class_index == class_same:
+                index, rep_center = center, center
+            else:
+                index, rep_center = class_reps[class_index], -1
+            value = 0
+            for name, feature_dirs, predicate in kind["features"]:
+                if d in feature_dirs and predicate(index, rep_center):
+                    value |= bits[name]
+            row.append(value)
+        bit_map.append(row)
+    return bit_map
+
+def eval_signature(kind, signature):
+    names, bits, half_bit, _ = feature_bits(kind)
+    values = {name: (signature & bits[name]) != 0 for name in names}
+    return kind["rule"](values, (signature & half_bit) != 0)
+
+def compile_tables():
+    bit_maps = []
+    lut = []
+    kind_offsets = {}
+    kind_entries = []
+    for index in range(tile_index_count):
+        kind = kind_of_center(index)
+        names, bits, half_bit, sig_size = feature_bits(kind)
+        bit_map = kind_bit_map(kind, index)
+        if bit_map not in bit_maps:
+            bit_maps.append(bit_map)
+        if kind["name"] not in kind_offsets:
+            kind_offsets[kind["name"]] = len(lut)
+            lut += [eval_signature(kind, sig) for sig in range(sig_size)]
+        kind_entries.append((
+            kind_offsets[kind["name"]], half_bit, bit_maps.index(bit_map), kind["name"],
+            kind.get("bitboard", False)
+        ) + kind_bitboard_bits(kind))
+    return bit_maps, lut, kind_entries
+
+def vis_tile_name(value):
+    if value == unhandled:
+        return "AUTOTILE_UNHANDLED"
+    return vis_tile_names[value]
+
+def write_header(path):
+    bit_maps, lut, kind_entries = compile_tables()
+    lines = []
+    lines.append("// Generated by autotile_gen.py - don't edit, change rules there instead.")
+    lines.append("")
+    lines.append("#ifndef SLIPGATES_AUTOTILE_LUT_H")
+    lines.append("#define SLIPGATES_AUTOTILE_LUT_H")
+    lines.append("")
+    lines.append("#include <ace/types.h>")
+    lines.append("#include \"vis_tile.h\"")
+    lines.append("")
+    lines.append("#define AUTOTILE_TILE_INDEX_COUNT {}".format(tile_index_count))
+    lines.append("#define AUTOTILE_CLASS_COUNT {}".format(class_count))
+    lines.append("#define AUTOTILE_CLASS_SAME {}".format(class_same))
+    lines.append("#define AUTOTILE_SIGNATURE_ESCAPE 0x{:04X}".format(escape_bit))
+    lines.append("#define AUTOTILE_UNHANDLED 0x{:02X}".format(unhandled))
+    lines.append("")
+    lines.append("#define AUTOTILE_BITBOARD_ON_WALL {}".format(bitboard_on_wall))
+    lines.append("#define AUTOTILE_BITBOARD_BLOCKED {}".format(bitboard_blocked))
+    lines.append("#define AUTOTILE_BITBOARD_FEATURE {}".format(bitboard_feature))
+    lines.append("#define AUTOTILE_WINDOW_ORTH 0x{:03X}".format(window_orth))
+    lines.append("#define AUTOTILE_WINDOW_DIAG 0x{:03X}".format(window_diag))
+    lines.append("")
+    lines.append("typedef struct tAutotileKind {")
+    lines.append("\tUWORD uwLutOffset;")
+    lines.append("\tUWORD uwRightHalfBits;")
+    lines.append("\tUWORD uwBlockedOrthBits;")
+    lines.append("\tUWORD uwBlockedDiagBits;")
+    lines.append("\tUBYTE ubBitMap;")
+    lines.append("\tUBYTE isBitboard;")
+    lines.append("} tAutotileKind;")
+    lines.append("")
+    lines.append("static const UBYTE s_pAutotileClasses[AUTOTILE_TILE_INDEX_COUNT] = {")
+    for index in range(tile_index_count):
+        lines.append("\t{}, // {}".format(tile_classes[index], tile_names[tile_codes[index]]))
+    lines.append("};")
+    lines.append("")
+    lines.append("static const tAutotileKind s_pAutotileKinds[AUTOTILE_TILE_INDEX_COUNT] = {")
+    for index, (offset, half_bit, bit_map, name, is_bitboard, orth, diag) in enumerate(kind_entries):
+        lines.append("\t{{{}, 0x{:04X}, 0x{:04X}, 0x{:04X}, {}, {}}}, // {}: {}".format(
+            offset, half_bit, orth, diag, bit_map, 1 if is_bitboard else 0,
+            tile_names[tile_codes[index]], name
+        ))
+    lines.append("};")
+    lines.append("")
+    lines.append("static const UBYTE s_pAutotileBitboardFlags[AUTOTILE_TILE_INDEX_COUNT] = {")
+    for index in range(tile_index_count):
+        lines.append("\t{}, // {}".format(bitboard_flags(index), tile_names[tile_codes[index]]))
+    lines.append("};")
+    lines.append("")
+    lines.append("// Wall signature bits of bitboard kinds, by 3x3 on-wall window")
+    lines.append("static const UBYTE s_pAutotileWallWindow[512] = {")
+    for window in range(0, 512, 16):
+        lines.append("\t" + ", ".join(
+            "0x{:02X}".format(wall_window_bits(w)) for w in range(window, window + 16)
+        ) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("// Signature bits contributed by neighbour, by direction and class")
+    lines.append("static const UWORD s_pAutotileBits[][8][AUTOTILE_CLASS_COUNT] = {")
+    for bit_map in bit_maps:
+        lines.append("\t{")
+        for row in bit_map:
+            lines.append("\t\t{" + ", ".join("0x{:04X}".format(value) for value in row) + "},")
+        lines.append("\t},")
+    lines.append("};")
+    lines.append("")
+    lines.append("static const UBYTE s_pAutotileLut[] = {")
+    offset_names = {}
+    for offset, _, _, name, _, _, _ in kind_entries:
+        offset_names[offset] = name
+    for offset, value in enumerate(lut):
+        if offset in offset_names:
+            lines.append("\t// {}".format(offset_names[offset]))
+        lines.append("\t{},".format(vis_tile_name(value)))
+    lines.append("};")
+    lines.append("")
+    lines.append("#endif // SLIPGATES_AUTOTILE_LUT_H")
+    with open(path, "w") as file_out:
+        file_out.write("\n".join(lines) + "\n")
+    print("Autotile: {} classes, {} bit maps, {} table entries".format(
+        class_count, len(bit_maps), len(lut)
+    ))
+
+#----------------------------------------------------------------- VERIFICATION
+
+def bg_escaped_vis(level, x, y):
+    # Mirrors the escape path in autotile.c
+    t = lambda dx, dy: level[x + dx][y + dy] & tile_index_mask
+    above, below, left, right = t(0, -1), t(0, 1), t(-1, 0), t(1, 0)
+    for name, results in [
+        ("TILE_BOUNCER_SPAWNER", "BOUNCER_SPAWNER"), ("TILE_RECEIVER", "RECEIVER")
+    ]:
+        tile = index_of(name)
+        for neighbor, suffix in [(above, "DOWN"), (below, "UP"), (left, "RIGHT"), (right, "LEFT")]:
+            if neighbor == tile:
+                return vis("VIS_TILE_{}_BG_{}".format(results, suffix))
+    pipe = index_of("TILE_PIPE")
+    blocked = index_of("TILE_WALL_BLOCKED")
+    for neighbor, corner, suffix in [
+        (above, t(-1, -1), "S"), (below, t(-1, 1), "N"), (left, t(-1, 1), "E"), (right, t(1, 1), "W")
+    ]:
+        if neighbor == pipe:
+            return vis("VIS_TILE_{}BG_PIPE_{}".format("BLOCKED_" if corner == blocked else "", suffix))
+    for neighbor, dx, side in [(left, -1, "LEFT"), (right, 1, "RIGHT")]:
+        if is_exit(neighbor):
+            if not is_exit(t(dx, -1)):
+                return vis("VIS_TILE_EXIT_BG_{}_TOP".format(side))
+            if not is_exit(t(dx, 1)):
+                return vis("VIS_TILE_EXIT_BG_{}_BOTTOM".format(side))
+            return vis("VIS_TILE_EXIT_BG_{}_MID".format(side))
+    for front, first in gateway_kinds:
+        if below == index_of(front):
+            if t(-1, 1) != below:
+                return gateway_vis(first, "VIS_TILE_DOOR_DOWN_CLOSED_TOP_LEFT")
+            if t(1, 1) != below:
+                return gateway_vis(first, "VIS_TILE_DOOR_DOWN_CLOSED_TOP_RIGHT")
+            return gateway_vis(first, "VIS_TILE_DOOR_DOWN_CLOSED_TOP_MID")
+    if is_button(below):
+        side = "LEFT" if x < map_width // 2 else "RIGHT"
+        return vis("VIS_TILE_BUTTON_BG_{}_{}".format(side, 1 if t(1, 1) == below else 2))
+    return vis("VIS_TILE_BG_1")
+
+def wall_escaped_vis(level, x, y):
+    t = lambda dx, dy: level[x + dx][y + dy] & tile_index_mask
+    side = "LEFT" if x < map_width // 2 else "RIGHT"
+    for front, first in gateway_kinds:
+        front = index_of(front)
+        if t(0, -1) == front:
+            return gateway_vis(first, "VIS_TILE_DOOR_{}_CLOSED_WALL_BOTTOM".format(side))
+        if t(0, 1) == front:
+            return gateway_vis(first, "VIS_TILE_DOOR_{}_CLOSED_WALL_TOP".format(side))
+        if t(-1, 0) == front:
+            return gateway_vis(first, "VIS_TILE_DOOR_DOWN_CLOSED_WALL_RIGHT")
+        if t(1, 0) == front:
+            return gateway_vis(first, "VIS_TILE_DOOR_DOWN_CLOSED_WALL_LEFT")
+    return vis("VIS_TILE_BG_1")
+
+def direct_vis(level, x, y):
+    # Evaluates rules straight on neighbour tiles, without compiled tables
+    if x == 0 or x == map_width - 1 or y == 0 or y == map_height - 1:
+        return vis("VIS_TILE_WALL_1")
+    center = level[x][y] & tile_index_mask
+    kind = kind_of_center(center)
+    names, _, _, _ = feature_bits(kind)
+    values = {name: False for name in names + ["escape"]}
+    for name, feature_dirs, predicate in kind["features"]:
+        for d in feature_dirs:
+            dx, dy = dir_offsets[d]
+            if predicate(level[x + dx][y + dy] & tile_index_mask, center):
+                values[name] = True
+    if values["escape"]:
+        escaped = (bg_escaped_vis if kind["name"] == "bg" else wall_escaped_vis)(level, x, y)
+        if escaped != vis("VIS_TILE_BG_1"):
+            return escaped
+    vis_tile = kind["rule"](values, x >= map_width // 2)
+    return vis("VIS_TILE_BG_1") if vis_tile == unhandled else vis_tile
+
+def table_vis(tables, level, x, y):
+    # Mirrors autotileGetVisTile()
+    bit_maps, lut, kind_entries = tables
+    if x == 0 or x == map_width - 1 or y == 0 or y == map_height - 1:
+        return vis("VIS_TILE_WALL_1")
+    center = level[x][y] & tile_index_mask
+    offset, half_bit, bit_map, name, _, _, _ = kind_entries[center]
+    signature = half_bit if x >= map_width // 2 else 0
+    for d in range(8):
+        dx, dy = dir_offsets[d]
+        neighbor = level[x + dx][y + dy] & tile_index_mask
+        neighbor_class = class_same if neighbor == center else tile_classes[neighbor]
+        signature |= bit_maps[bit_map][d][neighbor_class]
+    if signature & escape_bit:
+        escaped = (bg_escaped_vis if name == "bg" else wall_escaped_vis)(level, x, y)
+        if escaped != vis("VIS_TILE_BG_1"):
+            return escaped
+        signature &= ~escape_bit
+    vis_tile = lut[offset + signature]
+    return vis("VIS_TILE_BG_1") if vis_tile == unhandled else vis_tile
+
+def bitboard_vis(tables, level, x, y):
+    # Mirrors autotileRecalcAllVisTiles()
+    _, lut, kind_entries = tables
+    center = level[x][y] & tile_index_mask
+    offset, _, _, _, is_bitboard, orth, diag = kind_entries[center]
+    if x == 0 or x == map_width - 1 or y == 0 or y == map_height - 1 or not is_bitboard:
+        return table_vis(tables, level, x, y)
+    on_wall_window = 0
+    blocked_window = 0
+    for dx in range(3):
+        for dy in range(3):
+            flags = bitboard_flags(level[x + dx - 1][y + dy - 1] & tile_index_mask)
+            if flags & bitboard_feature:
+                return table_vis(tables, level, x, y)
+            if flags & bitboard_on_wall:
+                on_wall_window |= 1 << (dx * 3 + dy)
+            if flags & bitboard_blocked:
+                blocked_window |= 1 << (dx * 3 + dy)
+    signature = wall_window_bits(on_wall_window)
+    if blocked_window & window_orth:
+        signature |= orth
+    if blocked_window & window_diag:
+        signature |= diag
+    vis_tile = lut[offset + signature]
+    return table_vis(tables, level, x, y) if vis_tile == unhandled else vis_tile
+
+def read_level_planes(data):
+    # Follows mapLoadLevelFromFile(): v2 with raw or packed planes, else v1
+    plane_words = map_width * map_height
+    if data.startswith(level_pack.level_magic):
+        if len(data) < level_pack.level_header_size:
+            raise level_convert.LevelFormatError("truncated header")
+        if data[4] != level_convert.level_version:
+            raise level_convert.LevelFormatError("unsupported version {}".format(data[4]))
+        payload = data[level_pack.level_header_size:]
+        if data[level_pack.level_flags_offset] & level_pack.level_flag_packed_planes:
+            words, _size, _ahead = level_pack.rle_unpack_prefix(payload, 2 * plane_words)
+        else:
+            if len(payload) < level_pack.planes_size:
+                raise level_convert.LevelFormatError("truncated planes")
+            words = struct.unpack_from(">{}H".format(2 * plane_words), payload)
+        tile_codes_yx = words[:plane_words]
+        vis_codes_yx = words[plane_words:]
+    else:
+        level = level_convert.parse_v1(data)
+        tile_codes_yx = struct.unpack(">{}H".format(plane_words), level["tiles"])
+        vis_codes_yx = struct.unpack(">{}H".format(plane_words), level["vis_tiles"])
+    level = [[tile_codes_yx[y * map_width + x] for y in range(map_height)] for x in range(map_width)]
+    stored = [[vis_codes_yx[y * map_width + x] for y in range(map_height)] for x in range(map_width)]
+    return level, stored
+
+def read_levels(path):
+    # Yields name and data of each level in given level file, dir or pack
+    if os.path.isdir(path):
+        for file_name in sorted(os.listdir(path)):
+            yield from read_levels(os.path.join(path, file_name))
+        return
+    with open(path, "rb") as file_in:
+        data = file_in.read()
+    if not data.startswith(level_pack.pack_magic):
+        yield os.path.basename(path), data
+        return
+    count = struct.unpack_from(">H", data, 4)[0]
+    for i in range(count):
+        index, _, size, offset = struct.unpack_from(
+            ">BBHL", data, level_pack.header_size + i * level_pack.entry_size
+        )
+        yield "{}:L{:03d}".format(os.path.basename(path), index), data[offset:offset + size]
+
+def verify(paths):
+    # Levels which can't be read count as failures too
+    tables = compile_tables()
+    level_count = 0
+    failure_count = 0
+    for path in paths:
+        for name, data in read_levels(path):
+            try:
+                level, stored = read_level_planes(data)
+            except (level_convert.LevelFormatError, ValueError) as error:
+                print("{}: can't be read: {}".format(name, error))
+                failure_count += 1
+                continue
+            level_count += 1
+            level_mismatches = 0
+            stale_count = 0
+            for y in range(map_height):
+                for x in range(map_width):
+                    expected = direct_vis(level, x, y)
+                    if table_vis(tables, level, x, y) != expected:
+                        level_mismatches += 1
+                        print("{}: mismatch at {},{}".format(name, x, y))
+                    elif bitboard_vis(tables, level, x, y) != expected:
+                        level_mismatches += 1
+                        print("{}: bitboard mismatch at {},{}".format(name, x, y))
+                    if stored[x][y] != expected:
+                        stale_count += 1
+            failure_count += level_mismatches
+            print("{}: {} mismatches, {} stored vis tiles differ from rules".format(
+                name, level_mismatches, stale_count
+            ))
+    print("Checked {} levels, {} failures".format(level_count, failure_count))
+    return failure_count
+
+if __name__ == "__main__":
+    if len(sys.argv) >= 3 and sys.argv[1] == "--verify":
+        sys.exit(1 if verify(sys.argv[2:]) else 0)
+    elif len(sys.argv) == 2:
+        write_header(sys.argv[1])
+    else:
+        print("Usage: {} autotile_lut.h | --verify levels...".format(sys.argv[0]))
+        sys.exit(1)
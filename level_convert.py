@@ -0,0 +1,141 @@
+import argparse
+import pathlib
+import struct
+import sys
+
+# Converts v1 levels (field-by-field dump of game structs) to v2 layout read
+# by mapTryLoad() in one go. Keep in sync with MAP_LEVEL_* in src/map.c.
+
+tile_width = 40
+tile_height = 32
+interactions_max = 10
+interaction_targets_max = 10
+boxes_max = 5
+spikes_max = 10
+turrets_max = 5
+story_text_max = 200
+
+level_magic = b"SLVL"
+level_version = 2
+header_size = 32
+plane_size = tile_width * tile_height * 2
+
+class LevelFormatError(Exception):
+    pass
+
+class Reader:
+    def __init__(self, data: bytes):
+        self.data = data
+        self.pos = 0
+
+    def read(self, fmt: str):
+        size = struct.calcsize(fmt)
+        if self.pos + size > len(self.data):
+            raise LevelFormatError("unexpected end of file at {}".format(self.pos))
+        values = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += size
+        return values if len(values) > 1 else values[0]
+
+    def read_bytes(self, size: int) -> bytes:
+        if self.pos + size > len(self.data):
+            raise LevelFormatError("unexpected end of file at {}".format(self.pos))
+        out = self.data[self.pos:self.pos + size]
+        self.pos += size
+        return out
+
+def check_count(name: str, count: int, count_max: int):
+    if count > count_max:
+        raise LevelFormatError("{} count {} exceeds {}".format(name, count, count_max))
+
+def parse_v1(data: bytes) -> dict:
+    # Enums are int-sized on m68k gcc, hence the 'l' for kinds and tile codes
+    reader = Reader(data)
+    level = {"spawn": reader.read(">ll"), "interactions": []}
+    for _ in range(interactions_max):
+        target_count, button_mask, _was_active = reader.read(">BHB")
+        check_count("interaction target", target_count, interaction_targets_max)
+        targets = []
+        for _ in range(target_count):
+            kind, tile_on, tile_off, vis_on, vis_off, pos = reader.read(">lllllH")
+            targets.append((pos, kind, tile_on, tile_off, vis_on, vis_off))
+        level["interactions"].append((button_mask, targets))
+
+    box_count = reader.read(">B")
+    check_count("box", box_count, boxes_max)
+    level["boxes"] = [reader.read(">ll") for _ in range(box_count)]
+
+    spike_count = reader.read(">B")
+    check_count("spike", spike_count, spikes_max)
+    level["spikes"] = [reader.read(">H") for _ in range(spike_count)]
+
+    turret_count = reader.read(">B")
+    check_count("turret", turret_count, turrets_max)
+    level["turrets"] = [reader.read(">H") for _ in range(turret_count)]
+
+    story_length = reader.read(">B")
+    if story_length >= story_text_max:
+        raise LevelFormatError("story text too long: {}".format(story_length))
+    level["story"] = reader.read_bytes(story_length)
+
+    # Two reserved counts, always zero
+    reader.read(">BB")
+
+    level["tiles"] = reader.read_bytes(plane_size)
+    level["vis_tiles"] = reader.read_bytes(plane_size)
+    if reader.pos != len(data):
+        raise LevelFormatError("{} trailing bytes".format(len(data) - reader.pos))
+    return level
+
+def build_v2(level: dict) -> bytes:
+    payload = bytearray()
+    payload += level["tiles"]
+    payload += level["vis_tiles"]
+    for button_mask, targets in level["interactions"]:
+        payload += struct.pack(">H", button_mask)
+        for target in targets:
+            payload += struct.pack(">6H", *(value & 0xFFFF for value in target))
+    for box in level["boxes"]:
+        payload += struct.pack(">ll", *box)
+    for spike in level["spikes"]:
+        payload += struct.pack(">H", spike)
+    for turret in level["turrets"]:
+        payload += struct.pack(">H", turret)
+    payload += level["story"]
+
+    header = bytearray(level_magic)
+    header += struct.pack(
+        ">BBHll", level_version, len(level["story"]), len(payload), *level["spawn"]
+    )
+    header += bytes(len(targets) for _, targets in level["interactions"])
+    header += struct.pack(
+        ">BBB", len(level["boxes"]), len(level["spikes"]), len(level["turrets"])
+    )
+    header += bytes(header_size - len(header))
+    return bytes(header) + bytes(payload)
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Convert v1 level files to v2 layout")
+    parser.add_argument("levels", nargs="+", type=pathlib.Path, help="L*.dat files to convert")
+    parser.add_argument("--out-dir", type=pathlib.Path, help="write here instead of in place")
+    args = parser.parse_args()
+
+    errors = 0
+    for path in args.levels:
+        data = path.read_bytes()
+        if data.startswith(level_magic):
+            print("{}: already v2, skipping".format(path))
+            continue
+        try:
+            converted = build_v2(parse_v1(data))
+        except LevelFormatError as error:
+            print("{}: not a valid v1 level: {}".format(path, error), file=sys.stderr)
+            errors += 1
+            continue
+
+        out_path = args.out_dir / path.name if args.out_dir else path
+        out_path.write_bytes(converted)
+        print("{}: {} -> {} bytes".format(path, len(data), len(converted)))
+    return 1 if errors else 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,196 @@
+import argparse
+import pathlib
+import re
+import struct
+import sys
+
+# Packs L*.dat level files into single archive read by mapOpenLevelPack(),
+# optionally compressing tile planes of v2 levels.
+# Keep in sync with MAP_LEVEL_PACK_* in src/map.c and PLANE_RLE_* in src/plane_rle.h.
+
+pack_magic = b"SLPK"
+header_size = 8
+entry_size = 8
+entries_max = 64
+
+level_magic = b"SLVL"
+level_header_size = 32
+level_flags_offset = 29
+level_flag_packed_planes = 1
+row_words = 40
+planes_size = 2 * row_words * 32 * 2
+unpack_margin = 32
+
+rle_literal = 0x00
+rle_fill = 0x40
+rle_copy_up = 0x80
+rle_repeat = 0xC0
+rle_count_max = 64
+
+def rle_pack(words: list) -> bytes:
+    out = bytearray()
+    literals = []
+
+    def flush_literals():
+        while literals:
+            chunk = literals[:rle_count_max]
+            del literals[:rle_count_max]
+            out.append(rle_literal | (len(chunk) - 1))
+            out.extend(struct.pack(">{}H".format(len(chunk)), *chunk))
+
+    def run_length(pos: int, ref_pos: int) -> int:
+        length = 0
+        while (
+            length < rle_count_max and pos + length < len(words) and
+            words[pos + length] == words[ref_pos + length]
+        ):
+            length += 1
+        return length
+
+    pos = 0
+    while pos < len(words):
+        # Reference runs may overlap with themselves, same as in unpacker
+        repeat = 0
+        if pos > 0:
+            while (
+                repeat < rle_count_max and pos + repeat < len(words) and
+                words[pos + repeat] == words[pos - 1]
+            ):
+                repeat += 1
+        copy_up = run_length(pos, pos - row_words) if pos >= row_words else 0
+        fill = min(run_length(pos + 1, pos) + 1, rle_count_max)
+
+        # Fill costs extra word, so it needs to be longer to pay off
+        best = max(repeat, copy_up, fill - 1)
+        if best < 2:
+            literals.append(words[pos])
+            pos += 1
+            continue
+
+        flush_literals()
+        if repeat == best:
+            out.append(rle_repeat | (repeat - 1))
+            pos += repeat
+        elif copy_up == best:
+            out.append(rle_copy_up | (copy_up - 1))
+            pos += copy_up
+        else:
+            out.append(rle_fill | (fill - 1))
+            out.extend(struct.pack(">H", words[pos]))
+            pos += fill
+    flush_literals()
+    return bytes(out)
+
+def rle_unpack_prefix(packed: bytes, word_count: int) -> tuple:
+    # Unpacks planes from start of given data, which may be followed by level
+    # sections. Returns words, packed size and max unpacked bytes ahead of
+    # read position.
+    words = []
+    pos = 0
+    ahead = 0
+    try:
+        while len(words) < word_count:
+            control = packed[pos]
+            pos += 1
+            count = (control & (rle_count_max - 1)) + 1
+            op = control & rle_repeat
+            if op == rle_literal:
+                words.extend(struct.unpack_from(">{}H".format(count), packed, pos))
+                pos += 2 * count
+            elif op == rle_fill:
+                words.extend([struct.unpack_from(">H", packed, pos)[0]] * count)
+                pos += 2
+            else:
+                offset = row_words if op == rle_copy_up else 1
+                for _ in range(count):
+                    words.append(words[-offset])
+            ahead = max(ahead, 2 * len(words) - pos)
+    except (IndexError, struct.error):
+        raise ValueError("truncated packed planes")
+    if len(words) != word_count:
+        raise ValueError("malformed packed planes")
+    return words, pos, ahead
+
+def rle_unpack(packed: bytes, word_count: int) -> tuple:
+    # Also returns slack needed to unpack in place, see planeRleUnpack()
+    words, pos, ahead = rle_unpack_prefix(packed, word_count)
+    if pos != len(packed):
+        raise ValueError("malformed packed planes")
+    return words, max(0, ahead - (2 * word_count - len(packed)))
+
+def compress_level(data: bytes) -> bytes:
+    # Returns data unchanged if it's not v2 or compression doesn't fit
+    if not data.startswith(level_magic) or data[level_flags_offset] & level_flag_packed_planes:
+        return data
+    planes = data[level_header_size:level_header_size + planes_size]
+    words = list(struct.unpack(">{}H".format(len(planes) // 2), planes))
+    packed = rle_pack(words)
+
+    # Round-trip before trusting it
+    unpacked, slack = rle_unpack(packed, len(words))
+    if unpacked != words:
+        raise ValueError("plane compression round-trip failed")
+    if slack > unpack_margin or len(packed) >= len(planes):
+        return data
+
+    sections = data[level_header_size + planes_size:]
+    header = bytearray(data[:level_header_size])
+    header[level_flags_offset] |= level_flag_packed_planes
+    struct.pack_into(">H", header, level_flags_offset + 1, len(packed) + len(sections))
+    return bytes(header) + packed + sections
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Pack level files into single archive")
+    parser.add_argument("pack", type=pathlib.Path, help="output pack path")
+    parser.add_argument("levels", nargs="+", type=pathlib.Path, help="L*.dat files to pack")
+    parser.add_argument("--compress", action="store_true", help="compress v2 level planes")
+    args = parser.parse_args()
+
+    size_raw = 0
+
+    levels = {}
+    for path in args.levels:
+        match = re.fullmatch(r"L(\d{3})\.dat", path.name)
+        if not match or int(match.group(1)) > 255:
+            print("{}: not a level file name".format(path), file=sys.stderr)
+            return 1
+        data = path.read_bytes()
+        size_raw += len(data)
+        if args.compress:
+            try:
+                data = compress_level(data)
+            except ValueError as error:
+                print("{}: {}".format(path, error), file=sys.stderr)
+                return 1
+        if len(data) > 0xFFFF:
+            print("{}: too big for pack entry".format(path), file=sys.stderr)
+            return 1
+        levels[int(match.group(1))] = data
+
+    if len(levels) > entries_max:
+        print("Too many levels: {}, max {}".format(len(levels), entries_max), file=sys.stderr)
+        return 1
+
+    # Levels are stored in index order so that consecutive ones are close on disk
+    index = bytearray()
+    blob = bytearray()
+    offset = header_size + len(levels) * entry_size
+    for level_index in sorted(levels):
+        data = levels[level_index]
+        index += struct.pack(">BBHL", level_index, 0, len(data), offset + len(blob))
+        blob += data
+        # Keep each level word-aligned
+        if len(blob) % 2:
+            blob += b"\0"
+
+    header = pack_magic + struct.pack(">HH", len(levels), 0)
+    args.pack.write_bytes(header + index + blob)
+    size_levels = sum(len(data) for data in levels.values())
+    print("Packed {} levels, {} bytes".format(len(levels), len(header) + len(index) + len(blob)))
+    print("Level data {} -> {} bytes, ratio {:.3f}".format(
+        size_raw, size_levels, size_levels / size_raw
+    ))
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,25 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "arena.h"
+
+void arenaInit(tArena *pArena, void *pBase, ULONG ulSize) {
+	pArena->pBase = pBase;
+	pArena->ulSize = ulSize;
+	pArena->ulUsed = 0;
+}
+
+void *arenaAlloc(tArena *pArena, ULONG ulSize) {
+	ULONG ulAlignedSize = ARENA_ALIGN(ulSize);
+	if(ulAlignedSize < ulSize || ulAlignedSize > pArena->ulSize - pArena->ulUsed) {
+		return 0;
+	}
+
+	void *pBlock = &pArena->pBase[pArena->ulUsed];
+	pArena->ulUsed += ulAlignedSize;
+	if(pArena->ulUsed > pArena->ulHighWater) {
+		pArena->ulHighWater = pArena->ulUsed;
+	}
+	return pBlock;
+}
@@ -0,0 +1,35 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_ARENA_H
+#define SLIPGATES_ARENA_H
+
+#include <ace/types.h>
+
+// Enough for blitter and for AGA fetch modes
+#define ARENA_ALIGNMENT 8
+#define ARENA_ALIGN(ulSize) (((ulSize) + ARENA_ALIGNMENT - 1) & ~(ULONG)(ARENA_ALIGNMENT - 1))
+
+// Storage is owned by caller, arena only hands out consecutive parts of it
+typedef struct tArena {
+	UBYTE *pBase;
+	ULONG ulSize;
+	ULONG ulUsed;
+	ULONG ulHighWater;
+} tArena;
+
+/**
+ * @brief Sets up arena over given storage, which should be aligned
+ * to ARENA_ALIGNMENT. High water mark is kept.
+ */
+void arenaInit(tArena *pArena, void *pBase, ULONG ulSize);
+
+/**
+ * @brief Takes next ARENA_ALIGNMENT-aligned block from arena.
+ *
+ * @return Block of given size, zero if arena has not enough space left.
+ */
+void *arenaAlloc(tArena *pArena, ULONG ulSize);
+
+#endif // SLIPGATES_ARENA_H
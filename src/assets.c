@@ -4,8 +4,256 @@
 
 #include "assets.h"
 #include <ace/managers/system.h>
+#include <ace/managers/memory.h>
+#include <ace/utils/disk_file.h>
+#include "arena.h"
+#include "chip_arena.h"
 
 #define COLOR_WHITE 15
+#define ASSETS_WHITE_FRAME_SIZE 16
+#define ASSETS_WHITE_FRAME_BPP 5
+#define ASSETS_BUNDLE_PATH "data/game.bnd"
+#define ASSETS_BUNDLE_HEADER_SIZE 8
+#define ASSETS_BUNDLE_ENTRY_SIZE 32
+#define ASSETS_BUNDLE_ENTRY_NAME_SIZE 16
+#define ASSETS_BUNDLE_ENTRIES_MAX 16
+#define ASSETS_BUNDLE_FLAG_INTERLEAVED BV(0)
+#define ASSETS_BUNDLE_FLAG_PACKED BV(1)
+#define ASSETS_BUNDLE_UNPACK_BUFFER_SIZE 512
+#define ASSETS_BUNDLE_LZ_MATCH 0x80 // Big-endian offset back into unpacked data follows
+#define ASSETS_BUNDLE_LZ_COUNT_MASK 0x7F
+#define ASSETS_BUNDLE_LZ_MATCH_MIN 3
+// Longest op is control byte followed by max literal run
+#define ASSETS_BUNDLE_LZ_OP_SIZE_MAX (1 + ASSETS_BUNDLE_LZ_COUNT_MASK + 1)
+
+#if !defined(GAME_ASSETS_RESIDENT_CHIP_FREE_MIN)
+#define GAME_ASSETS_RESIDENT_CHIP_FREE_MIN (128 * 1024)
+#endif
+
+typedef struct tAssetsBundleBitmap {
+	const char *szName;
+	tBitMap **pBitMap;
+} tAssetsBundleBitmap;
+
+static const UBYTE s_pBundleMagic[4] = {'S', 'L', 'B', 'N'};
+
+static const tAssetsBundleBitmap s_pBundleBitmapDefs[] = {
+	{"player", &g_pPlayerFrames},
+	{"player_mask", &g_pPlayerMasks},
+	{"arm", &g_pArmFrames},
+	{"arm_mask", &g_pArmMasks},
+	{"box", &g_pBoxFrames},
+	{"box_mask", &g_pBoxMasks},
+	{"bouncer", &g_pBouncerFrames},
+	{"bouncer_mask", &g_pBouncerMasks},
+	{"slipgate_a", &g_pSlipgateFramesA},
+	{"slipgate_b", &g_pSlipgateFramesB},
+	{"slipgates_mask", &g_pSlipgateMasks},
+	{"aim", &g_pAim},
+	{"aim_mask", &g_pAimMasks},
+	{"slip_vfx", &g_pSlipVfx},
+	{"slip_vfx_mask", &g_pSlipVfxMasks},
+	{"tiles", &g_pBmTiles},
+};
+
+#define ASSETS_BUNDLE_BITMAP_COUNT (sizeof(s_pBundleBitmapDefs) / sizeof(s_pBundleBitmapDefs[0]))
+
+// Bitmap structs point into assets chip arena, so they're not created
+// nor destroyed with bitmapCreate()/bitmapDestroy()
+static tBitMap s_pBundleBitMaps[ASSETS_BUNDLE_BITMAP_COUNT];
+static UBYTE *s_pBundleData;
+static ULONG s_ulBundleDataSize;
+static UBYTE s_pUnpackBuffer[ASSETS_BUNDLE_UNPACK_BUFFER_SIZE];
+static UBYTE s_isGameResident;
+static tAssetsResidencyStats s_sResidencyStats;
+
+static UWORD assetsReadUword(const UBYTE *pSrc) {
+	return (pSrc[0] << 8) | pSrc[1];
+}
+
+static ULONG assetsReadUlong(const UBYTE *pSrc) {
+	return ((ULONG)assetsReadUword(&pSrc[0]) << 16) | assetsReadUword(&pSrc[2]);
+}
+
+static UBYTE assetsGetBundleBitmapIndex(const UBYTE *pName) {
+	for(UBYTE i = 0; i < ASSETS_BUNDLE_BITMAP_COUNT; ++i) {
+		if(!strncmp(
+			(const char*)pName, s_pBundleBitmapDefs[i].szName, ASSETS_BUNDLE_ENTRY_NAME_SIZE
+		)) {
+			return i;
+		}
+	}
+	return ASSETS_BUNDLE_BITMAP_COUNT;
+}
+
+static UBYTE assetsSetBundleBitmap(const UBYTE *pEntry, ULONG ulOffset) {
+	UBYTE ubIndex = assetsGetBundleBitmapIndex(pEntry);
+	if(ubIndex >= ASSETS_BUNDLE_BITMAP_COUNT || *s_pBundleBitmapDefs[ubIndex].pBitMap) {
+		logWrite("ERR: Unknown or duplicate bundle bitmap: %.16s\n", pEntry);
+		return 0;
+	}
+
+	const UBYTE *pData = &pEntry[ASSETS_BUNDLE_ENTRY_NAME_SIZE];
+	UWORD uwWidth = assetsReadUword(&pData[0]);
+	UWORD uwHeight = assetsReadUword(&pData[2]);
+	UBYTE ubDepth = pData[4];
+	UBYTE isInterleaved = pData[5] & ASSETS_BUNDLE_FLAG_INTERLEAVED;
+	ULONG ulStoredSize = assetsReadUlong(&pData[8]);
+	ULONG ulSize = assetsReadUlong(&pData[12]);
+
+	UWORD uwPlaneRowSize = ((uwWidth + 15) >> 4) << 1;
+	if(
+		!ubDepth || ubDepth > 8 ||
+		ulSize != (ULONG)uwPlaneRowSize * uwHeight * ubDepth ||
+		(!(pData[5] & ASSETS_BUNDLE_FLAG_PACKED) && ulStoredSize != ulSize)
+	) {
+		logWrite("ERR: Malformed bundle bitmap: %.16s\n", pEntry);
+		return 0;
+	}
+
+	tBitMap *pBitMap = &s_pBundleBitMaps[ubIndex];
+	chipArenaBitmapInit(
+		pBitMap, uwWidth, uwHeight, ubDepth,
+		isInterleaved ? BMF_INTERLEAVED : 0, &s_pBundleData[ulOffset]
+	);
+	*s_pBundleBitmapDefs[ubIndex].pBitMap = pBitMap;
+	return 1;
+}
+
+static UBYTE assetsUnpackBitmap(
+	tFile *pFile, UBYTE *pDst, ULONG ulStoredSize, ULONG ulSize
+) {
+	// Packed data is streamed through small buffer, so that only destination
+	// bitmap needs to fit in memory
+	UBYTE *pDstStart = pDst;
+	UBYTE *pDstEnd = &pDst[ulSize];
+	const UBYTE *pSrc = s_pUnpackBuffer;
+	UWORD uwBuffered = 0;
+	while(pDst < pDstEnd) {
+		if(uwBuffered < ASSETS_BUNDLE_LZ_OP_SIZE_MAX && ulStoredSize) {
+			memmove(s_pUnpackBuffer, pSrc, uwBuffered);
+			UWORD uwRead = MIN(ulStoredSize, sizeof(s_pUnpackBuffer) - uwBuffered);
+			if(fileRead(pFile, &s_pUnpackBuffer[uwBuffered], uwRead) != uwRead) {
+				return 0;
+			}
+			ulStoredSize -= uwRead;
+			uwBuffered += uwRead;
+			pSrc = s_pUnpackBuffer;
+		}
+		if(!uwBuffered) {
+			return 0;
+		}
+
+		UBYTE ubControl = *(pSrc++);
+		--uwBuffered;
+		if(ubControl & ASSETS_BUNDLE_LZ_MATCH) {
+			UWORD uwCount = (ubControl & ASSETS_BUNDLE_LZ_COUNT_MASK) + ASSETS_BUNDLE_LZ_MATCH_MIN;
+			if(uwBuffered < 2) {
+				return 0;
+			}
+			UWORD uwOffset = assetsReadUword(pSrc);
+			pSrc += 2;
+			uwBuffered -= 2;
+			if(!uwOffset || uwOffset > pDst - pDstStart || uwCount > pDstEnd - pDst) {
+				return 0;
+			}
+			// Byte by byte since match may overlap with itself
+			const UBYTE *pRef = pDst - uwOffset;
+			do {
+				*(pDst++) = *(pRef++);
+			} while(--uwCount);
+		}
+		else {
+			UWORD uwCount = ubControl + 1;
+			if(uwCount > uwBuffered || uwCount > pDstEnd - pDst) {
+				return 0;
+			}
+			memcpy(pDst, pSrc, uwCount);
+			pDst += uwCount;
+			pSrc += uwCount;
+			uwBuffered -= uwCount;
+		}
+	}
+	return !ulStoredSize && !uwBuffered;
+}
+
+static UBYTE assetsLoadBundle(void) {
+	for(UBYTE i = 0; i < ASSETS_BUNDLE_BITMAP_COUNT; ++i) {
+		*s_pBundleBitmapDefs[i].pBitMap = 0;
+	}
+
+	tFile *pFile = diskFileOpen(ASSETS_BUNDLE_PATH, "rb");
+	if(!pFile) {
+		logWrite("ERR: Can't open bitmap bundle " ASSETS_BUNDLE_PATH "\n");
+		return 0;
+	}
+
+	UBYTE pHeader[ASSETS_BUNDLE_HEADER_SIZE];
+	UWORD uwEntryCount = 0;
+	if(
+		fileRead(pFile, pHeader, sizeof(pHeader)) == sizeof(pHeader) &&
+		!memcmp(pHeader, s_pBundleMagic, sizeof(s_pBundleMagic))
+	) {
+		uwEntryCount = assetsReadUword(&pHeader[sizeof(s_pBundleMagic)]);
+	}
+	UBYTE pDirectory[ASSETS_BUNDLE_ENTRIES_MAX * ASSETS_BUNDLE_ENTRY_SIZE];
+	UWORD uwDirectorySize = uwEntryCount * ASSETS_BUNDLE_ENTRY_SIZE;
+	if(
+		uwEntryCount != ASSETS_BUNDLE_BITMAP_COUNT ||
+		fileRead(pFile, pDirectory, uwDirectorySize) != uwDirectorySize
+	) {
+		logWrite("ERR: Malformed bitmap bundle, entry count: %hu\n", uwEntryCount);
+		fileClose(pFile);
+		return 0;
+	}
+
+	s_ulBundleDataSize = 0;
+	for(UBYTE i = 0; i < uwEntryCount; ++i) {
+		const UBYTE *pEntry = &pDirectory[i * ASSETS_BUNDLE_ENTRY_SIZE];
+		s_ulBundleDataSize += assetsReadUlong(&pEntry[ASSETS_BUNDLE_ENTRY_NAME_SIZE + 12]);
+	}
+	// White frame is made along with bundle bitmaps, so that they share arena
+	ULONG ulArenaSize = ARENA_ALIGN(s_ulBundleDataSize) + chipArenaGetBitmapSize(
+		ASSETS_WHITE_FRAME_SIZE, ASSETS_WHITE_FRAME_SIZE, ASSETS_WHITE_FRAME_BPP
+	);
+	if(!chipArenaOpen(CHIP_ARENA_SCOPE_ASSETS, ulArenaSize)) {
+		fileClose(pFile);
+		return 0;
+	}
+	s_pBundleData = chipArenaAlloc(CHIP_ARENA_SCOPE_ASSETS, s_ulBundleDataSize);
+
+	// Data is stored in directory order. Unpacked bitmaps are read straight
+	// into chip mem, consecutive ones in single read.
+	ULONG ulOffset = 0;
+	ULONG ulReadStart = 0;
+	UBYTE isOk = 1;
+	for(UBYTE i = 0; isOk && i < uwEntryCount; ++i) {
+		const UBYTE *pEntry = &pDirectory[i * ASSETS_BUNDLE_ENTRY_SIZE];
+		const UBYTE *pData = &pEntry[ASSETS_BUNDLE_ENTRY_NAME_SIZE];
+		ULONG ulSize = assetsReadUlong(&pData[12]);
+		isOk = assetsSetBundleBitmap(pEntry, ulOffset);
+		if(isOk && (pData[5] & ASSETS_BUNDLE_FLAG_PACKED)) {
+			ULONG ulReadSize = ulOffset - ulReadStart;
+			isOk = (
+				fileRead(pFile, &s_pBundleData[ulReadStart], ulReadSize) == ulReadSize &&
+				assetsUnpackBitmap(
+					pFile, &s_pBundleData[ulOffset], assetsReadUlong(&pData[8]), ulSize
+				)
+			);
+			ulReadStart = ulOffset + ulSize;
+		}
+		ulOffset += ulSize;
+	}
+	if(isOk) {
+		ULONG ulReadSize = ulOffset - ulReadStart;
+		isOk = fileRead(pFile, &s_pBundleData[ulReadStart], ulReadSize) == ulReadSize;
+	}
+	fileClose(pFile);
+	if(!isOk) {
+		logWrite("ERR: Bitmap bundle truncated or malformed\n");
+	}
+	return isOk;
+}
 
 void assetsGlobalCreate(void) {
 	systemUse();
@@ -23,54 +271,71 @@ void assetsGlobalDestroy(void) {
 	systemUnuse();
 }
 
-void assetsGameCreate(void) {
+static void assetsGameFree(void) {
+	chipArenaClose(CHIP_ARENA_SCOPE_ASSETS);
+	s_pBundleData = 0;
+	g_pPlayerWhiteFrame = 0;
+}
+
+UBYTE assetsGameCreate(void) {
+	if(s_isGameResident) {
+		++s_sResidencyStats.uwHits;
+		return 1;
+	}
+	++s_sResidencyStats.uwMisses;
+
 	systemUse();
-	g_pPlayerFrames = bitmapCreateFromPath("data/player.bm", 0);
-	g_pPlayerMasks = bitmapCreateFromPath("data/player_mask.bm", 0);
-	g_pArmFrames = bitmapCreateFromPath("data/arm.bm", 0);
-	g_pArmMasks = bitmapCreateFromPath("data/arm_mask.bm", 0);
-	g_pBoxFrames = bitmapCreateFromPath("data/box.bm", 0);
-	g_pBoxMasks = bitmapCreateFromPath("data/box_mask.bm", 0);
-	g_pBouncerFrames = bitmapCreateFromPath("data/bouncer.bm", 0);
-	g_pBouncerMasks = bitmapCreateFromPath("data/bouncer_mask.bm", 0);
-	g_pSlipgateFramesA = bitmapCreateFromPath("data/slipgate_a.bm", 0);
-	g_pSlipgateFramesB = bitmapCreateFromPath("data/slipgate_b.bm", 0);
-	g_pSlipgateMasks = bitmapCreateFromPath("data/slipgates_mask.bm", 0);
-	g_pAim = bitmapCreateFromPath("data/aim.bm", 0);
-	g_pAimMasks = bitmapCreateFromPath("data/aim_mask.bm", 0);
-	g_pSlipVfx = bitmapCreateFromPath("data/slip_vfx.bm", 0);
-	g_pSlipVfxMasks = bitmapCreateFromPath("data/slip_vfx_mask.bm", 0);
-
-	g_pBmTiles = bitmapCreateFromPath("data/tiles.bm", 0);
-
-	g_pPlayerWhiteFrame = bitmapCreate(16, 16, 5, BMF_INTERLEAVED);
-	blitRect(g_pPlayerWhiteFrame, 0, 0, 16, 16, COLOR_WHITE);
+	// Leftovers of failed load, if any
+	assetsGameFree();
+	s_isGameResident = assetsLoadBundle();
+
+	if(s_isGameResident) {
+		g_pPlayerWhiteFrame = chipArenaBitmapCreate(
+			CHIP_ARENA_SCOPE_ASSETS, ASSETS_WHITE_FRAME_SIZE, ASSETS_WHITE_FRAME_SIZE,
+			ASSETS_WHITE_FRAME_BPP, BMF_INTERLEAVED
+		);
+		s_isGameResident = (g_pPlayerWhiteFrame != 0);
+	}
+	if(s_isGameResident) {
+		blitRect(
+			g_pPlayerWhiteFrame, 0, 0, ASSETS_WHITE_FRAME_SIZE, ASSETS_WHITE_FRAME_SIZE,
+			COLOR_WHITE
+		);
+		chipArenaCheckUsed(CHIP_ARENA_SCOPE_ASSETS);
+	}
 
 	systemUnuse();
+	return s_isGameResident;
+}
+
+void assetsGameRelease(void) {
+	// Called after game state has freed the rest of its memory, so this is
+	// roughly what menu and cutscenes will have at their disposal
+	ULONG ulChipFree = memGetFreeChipSize();
+	if(ulChipFree < GAME_ASSETS_RESIDENT_CHIP_FREE_MIN) {
+		logWrite("Evicting game assets, free chip: %lu\n", ulChipFree);
+		assetsGameEvict();
+	}
+}
+
+void assetsGameEvict(void) {
+	if(s_isGameResident) {
+		++s_sResidencyStats.uwEvictions;
+	}
+	assetsGameDestroy();
 }
 
 void assetsGameDestroy(void) {
+	s_isGameResident = 0;
 	systemUse();
-	bitmapDestroy(g_pPlayerFrames);
-	bitmapDestroy(g_pPlayerMasks);
-	bitmapDestroy(g_pArmFrames);
-	bitmapDestroy(g_pArmMasks);
-	bitmapDestroy(g_pBoxFrames);
-	bitmapDestroy(g_pBoxMasks);
-	bitmapDestroy(g_pBouncerFrames);
-	bitmapDestroy(g_pBouncerMasks);
-	bitmapDestroy(g_pSlipgateFramesA);
-	bitmapDestroy(g_pSlipgateFramesB);
-	bitmapDestroy(g_pSlipgateMasks);
-	bitmapDestroy(g_pAim);
-	bitmapDestroy(g_pAimMasks);
-	bitmapDestroy(g_pSlipVfx);
-	bitmapDestroy(g_pSlipVfxMasks);
-	bitmapDestroy(g_pBmTiles);
-	bitmapDestroy(g_pPlayerWhiteFrame);
+	assetsGameFree();
 	systemUnuse();
 }
 
+const tAssetsResidencyStats *assetsGetResidencyStats(void) {
+	return &s_sResidencyStats;
+}
+
 //------------------------------------------------------------------ GLOBAL VARS
 
 tBitMap *g_pPlayerFrames;
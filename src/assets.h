@@ -12,10 +12,41 @@ void assetsGlobalCreate(void);
 
 void assetsGlobalDestroy(void);
 
-void assetsGameCreate(void);
+typedef struct tAssetsResidencyStats {
+	UWORD uwHits;
+	UWORD uwMisses;
+	UWORD uwEvictions;
+} tAssetsResidencyStats;
 
+/**
+ * @brief Loads game assets, unless they're still resident from previous
+ * game state.
+ *
+ * @return 1 if assets are loaded, 0 if bundle is missing or malformed
+ * or there's not enough chip mem for it.
+ */
+UBYTE assetsGameCreate(void);
+
+/**
+ * @brief Marks game assets as unused. They're kept loaded for next game
+ * state unless free chip mem is below GAME_ASSETS_RESIDENT_CHIP_FREE_MIN.
+ */
+void assetsGameRelease(void);
+
+/**
+ * @brief Frees game assets regardless of chip mem left, e.g. to make room
+ * for other state's chip allocations.
+ */
+void assetsGameEvict(void);
+
+/**
+ * @brief Frees game assets on exit. Unlike assetsGameEvict(), it isn't
+ * counted in residency stats.
+ */
 void assetsGameDestroy(void);
 
+const tAssetsResidencyStats *assetsGetResidencyStats(void);
+
 //------------------------------------------------------------------ GLOBAL VARS
 
 extern tBitMap *g_pPlayerFrames;
@@ -0,0 +1,328 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "autotile.h"
+#include <ace/managers/log.h>
+#include "autotile_lut.h"
+
+#define AUTOTILE_COLUMN_WINDOW_MASK 7
+
+#if MAP_TILE_HEIGHT > 32
+#error "autotileRecalcAllVisTiles() needs whole tile column to fit in ULONG"
+#endif
+
+typedef struct tGatewayKind {
+	tTile eTileFront;
+	tVisTile eVisTileFirst;
+} tGatewayKind;
+
+static const tGatewayKind s_pGatewayKinds[] = {
+	{.eTileFront = TILE_DOOR_CLOSED, .eVisTileFirst = VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP},
+	{.eTileFront = TILE_DOOR_OPEN, .eVisTileFirst = VIS_TILE_DOOR_LEFT_OPEN_WALL_TOP},
+	{.eTileFront = TILE_GRATE, .eVisTileFirst = VIS_TILE_GRATE_LEFT_WALL_TOP},
+	{.eTileFront = TILE_DEATH_FIELD, .eVisTileFirst = VIS_TILE_DEATH_FIELD_LEFT_WALL_TOP},
+};
+#define AUTOTILE_GATEWAY_KIND_COUNT (sizeof(s_pGatewayKinds) / sizeof(s_pGatewayKinds[0]))
+
+// Offsets in pTiles, in order of autotile directions: N, NE, E, SE, S, SW, W, NW
+static const WORD s_pNeighborOffsets[8] = {
+	-1, MAP_TILE_HEIGHT - 1, MAP_TILE_HEIGHT, MAP_TILE_HEIGHT + 1,
+	1, -MAP_TILE_HEIGHT + 1, -MAP_TILE_HEIGHT, -MAP_TILE_HEIGHT - 1,
+};
+
+static tVisTile autotileGetGatewayWallVisTile(
+	const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
+	tTile eTile, tVisTile eVisTileFirst
+) {
+	tTile eTileLeft = pLevel->pTiles[ubTileX - 1][ubTileY];
+	tTile eTileRight = pLevel->pTiles[ubTileX + 1][ubTileY];
+	tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
+	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+
+	if(eTileAbove == eTile) {
+		return (eVisTileFirst + (
+			(ubTileX < MAP_TILE_WIDTH / 2) ?
+			VIS_TILE_DOOR_LEFT_CLOSED_WALL_BOTTOM :
+			VIS_TILE_DOOR_RIGHT_CLOSED_WALL_BOTTOM
+		) - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP);
+	}
+	if(eTileBelow == eTile) {
+		return (eVisTileFirst + (
+			(ubTileX < MAP_TILE_WIDTH / 2) ?
+			VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP :
+			VIS_TILE_DOOR_RIGHT_CLOSED_WALL_TOP
+		) - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP);
+	}
+	if(eTileLeft == eTile) {
+		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_WALL_RIGHT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	}
+	if(eTileRight == eTile) {
+		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_WALL_LEFT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	}
+
+	return VIS_TILE_BG_1;
+}
+
+static tVisTile autotileGetGatewayBgVisTile(
+	const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
+	tTile eTile, tVisTile eVisTileFirst
+) {
+	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+
+	if(eTileBelow == eTile) {
+		if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] != eTile) {
+			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_LEFT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+		}
+		if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] != eTile) {
+			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_RIGHT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+		}
+		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	}
+	return VIS_TILE_BG_1;
+}
+
+static tVisTile autotileGetEscapedBgVisTile(
+	const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY
+) {
+	tTile eTileLeft = pLevel->pTiles[ubTileX - 1][ubTileY];
+	tTile eTileRight = pLevel->pTiles[ubTileX + 1][ubTileY];
+	tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
+	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+
+	if(eTileAbove == TILE_BOUNCER_SPAWNER) {
+		return VIS_TILE_BOUNCER_SPAWNER_BG_DOWN;
+	}
+	if(eTileBelow == TILE_BOUNCER_SPAWNER) {
+		return VIS_TILE_BOUNCER_SPAWNER_BG_UP;
+	}
+	if(eTileLeft == TILE_BOUNCER_SPAWNER) {
+		return VIS_TILE_BOUNCER_SPAWNER_BG_RIGHT;
+	}
+	if(eTileRight == TILE_BOUNCER_SPAWNER) {
+		return VIS_TILE_BOUNCER_SPAWNER_BG_LEFT;
+	}
+	if(eTileAbove == TILE_RECEIVER) {
+		return VIS_TILE_RECEIVER_BG_DOWN;
+	}
+	if(eTileBelow == TILE_RECEIVER) {
+		return VIS_TILE_RECEIVER_BG_UP;
+	}
+	if(eTileLeft == TILE_RECEIVER) {
+		return VIS_TILE_RECEIVER_BG_RIGHT;
+	}
+	if(eTileRight == TILE_RECEIVER) {
+		return VIS_TILE_RECEIVER_BG_LEFT;
+	}
+	if(eTileAbove == TILE_PIPE) {
+		if(pLevel->pTiles[ubTileX - 1][ubTileY - 1] == TILE_WALL_BLOCKED) {
+			return VIS_TILE_BLOCKED_BG_PIPE_S;
+		}
+		return VIS_TILE_BG_PIPE_S;
+	}
+	if(eTileBelow == TILE_PIPE) {
+		if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
+			return VIS_TILE_BLOCKED_BG_PIPE_N;
+		}
+		return VIS_TILE_BG_PIPE_N;
+	}
+	if(eTileLeft == TILE_PIPE) {
+		if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
+			return VIS_TILE_BLOCKED_BG_PIPE_E;
+		}
+		return VIS_TILE_BG_PIPE_E;
+	}
+	if(eTileRight == TILE_PIPE) {
+		if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
+			return VIS_TILE_BLOCKED_BG_PIPE_W;
+		}
+		return VIS_TILE_BG_PIPE_W;
+	}
+	if(mapTileIsExit(eTileLeft)) {
+		if(!mapTileIsExit(pLevel->pTiles[ubTileX - 1][ubTileY - 1])) {
+			return VIS_TILE_EXIT_BG_LEFT_TOP;
+		}
+		if(!mapTileIsExit(pLevel->pTiles[ubTileX - 1][ubTileY + 1])) {
+			return VIS_TILE_EXIT_BG_LEFT_BOTTOM;
+		}
+		return VIS_TILE_EXIT_BG_LEFT_MID;
+	}
+	if(mapTileIsExit(eTileRight)) {
+		if(!mapTileIsExit(pLevel->pTiles[ubTileX + 1][ubTileY - 1])) {
+			return VIS_TILE_EXIT_BG_RIGHT_TOP;
+		}
+		if(!mapTileIsExit(pLevel->pTiles[ubTileX + 1][ubTileY + 1])) {
+			return VIS_TILE_EXIT_BG_RIGHT_BOTTOM;
+		}
+		return VIS_TILE_EXIT_BG_RIGHT_MID;
+	}
+
+	for(UBYTE i = 0; i < AUTOTILE_GATEWAY_KIND_COUNT; ++i) {
+		tVisTile eVisTile = autotileGetGatewayBgVisTile(
+			pLevel, ubTileX, ubTileY,
+			s_pGatewayKinds[i].eTileFront, s_pGatewayKinds[i].eVisTileFirst
+		);
+		if(eVisTile != VIS_TILE_BG_1) {
+			return eVisTile;
+		}
+	}
+
+	if(mapTileIsButton(eTileBelow)) {
+		if(ubTileX < MAP_TILE_WIDTH / 2) {
+			if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == eTileBelow) {
+				return VIS_TILE_BUTTON_BG_LEFT_1;
+			}
+			return VIS_TILE_BUTTON_BG_LEFT_2;
+		}
+		else {
+			if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == eTileBelow) {
+				return VIS_TILE_BUTTON_BG_RIGHT_1;
+			}
+			return VIS_TILE_BUTTON_BG_RIGHT_2;
+		}
+	}
+
+	return VIS_TILE_BG_1;
+}
+
+static tVisTile autotileGetEscapedWallVisTile(
+	const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY
+) {
+	for(UBYTE i = 0; i < AUTOTILE_GATEWAY_KIND_COUNT; ++i) {
+		tVisTile eVisTile = autotileGetGatewayWallVisTile(
+			pLevel, ubTileX, ubTileY,
+			s_pGatewayKinds[i].eTileFront, s_pGatewayKinds[i].eVisTileFirst
+		);
+		if(eVisTile != VIS_TILE_BG_1) {
+			return eVisTile;
+		}
+	}
+	return VIS_TILE_BG_1;
+}
+
+tVisTile autotileGetVisTile(
+	const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY
+) {
+	if(
+		ubTileX == 0 || ubTileX == MAP_TILE_WIDTH - 1 ||
+		ubTileY == 0 || ubTileY == MAP_TILE_HEIGHT - 1
+	) {
+		return VIS_TILE_WALL_1;
+	}
+
+	// Rules are compiled by autotile_gen.py - each neighbour adds bits
+	// depending on its class, resulting signature indexes kind's table part.
+	const tTile *pTile = &pLevel->pTiles[ubTileX][ubTileY];
+	UBYTE ubTileIndex = *pTile & MAP_TILE_INDEX_MASK;
+	const tAutotileKind *pKind = &s_pAutotileKinds[ubTileIndex];
+	const UWORD (*pBits)[AUTOTILE_CLASS_COUNT] = s_pAutotileBits[pKind->ubBitMap];
+	UWORD uwSignature = (ubTileX < MAP_TILE_WIDTH / 2) ? 0 : pKind->uwRightHalfBits;
+	for(UBYTE ubDir = 0; ubDir < 8; ++ubDir) {
+		UBYTE ubNeighborIndex = pTile[s_pNeighborOffsets[ubDir]] & MAP_TILE_INDEX_MASK;
+		UBYTE ubClass = (
+			ubNeighborIndex == ubTileIndex ?
+			AUTOTILE_CLASS_SAME : s_pAutotileClasses[ubNeighborIndex]
+		);
+		uwSignature |= pBits[ubDir][ubClass];
+	}
+
+	if(uwSignature & AUTOTILE_SIGNATURE_ESCAPE) {
+		// Rare neighbourhoods with too many combinations for a table
+		tVisTile eVisTile = (
+			*pTile == TILE_BG ?
+			autotileGetEscapedBgVisTile(pLevel, ubTileX, ubTileY) :
+			autotileGetEscapedWallVisTile(pLevel, ubTileX, ubTileY)
+		);
+		if(eVisTile != VIS_TILE_BG_1) {
+			return eVisTile;
+		}
+		uwSignature &= ~AUTOTILE_SIGNATURE_ESCAPE;
+	}
+
+	UBYTE ubVisTile = s_pAutotileLut[pKind->uwLutOffset + uwSignature];
+	if(ubVisTile == AUTOTILE_UNHANDLED) {
+		logWrite("Unhandled tile at %hhu,%hhu", ubTileX, ubTileY);
+		return VIS_TILE_BG_1;
+	}
+	return ubVisTile;
+}
+
+void autotileRecalcAllVisTiles(tLevel *pLevel) {
+	// Column is exactly 32 tiles high, so bit y of column's mask is tile x,y
+	ULONG pOnWallMasks[MAP_TILE_WIDTH];
+	ULONG pBlockedMasks[MAP_TILE_WIDTH];
+	ULONG pFeatureMasks[MAP_TILE_WIDTH];
+	for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+		ULONG ulOnWall = 0, ulBlocked = 0, ulFeature = 0;
+		for(UBYTE ubY = MAP_TILE_HEIGHT; ubY--;) {
+			UBYTE ubFlags = s_pAutotileBitboardFlags[
+				pLevel->pTiles[ubX][ubY] & MAP_TILE_INDEX_MASK
+			];
+			ulOnWall = (ulOnWall << 1) | (ubFlags & AUTOTILE_BITBOARD_ON_WALL);
+			ulBlocked = (ulBlocked << 1) | ((ubFlags & AUTOTILE_BITBOARD_BLOCKED) != 0);
+			ulFeature = (ulFeature << 1) | ((ubFlags & AUTOTILE_BITBOARD_FEATURE) != 0);
+		}
+		pOnWallMasks[ubX] = ulOnWall;
+		pBlockedMasks[ubX] = ulBlocked;
+		pFeatureMasks[ubX] = ulFeature;
+	}
+
+	for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+		pLevel->pVisTiles[ubX][0] = VIS_TILE_WALL_1;
+		pLevel->pVisTiles[ubX][MAP_TILE_HEIGHT - 1] = VIS_TILE_WALL_1;
+	}
+	for(UBYTE ubY = 1; ubY < MAP_TILE_HEIGHT - 1; ++ubY) {
+		pLevel->pVisTiles[0][ubY] = VIS_TILE_WALL_1;
+		pLevel->pVisTiles[MAP_TILE_WIDTH - 1][ubY] = VIS_TILE_WALL_1;
+	}
+
+	for(UBYTE ubX = 1; ubX < MAP_TILE_WIDTH - 1; ++ubX) {
+		// Lowest 3 bits of each mask are the 3x3 window's columns, shifting
+		// them right moves the window one tile down.
+		ULONG ulOnWallW = pOnWallMasks[ubX - 1];
+		ULONG ulOnWallC = pOnWallMasks[ubX];
+		ULONG ulOnWallE = pOnWallMasks[ubX + 1];
+		ULONG ulBlockedW = pBlockedMasks[ubX - 1];
+		ULONG ulBlockedC = pBlockedMasks[ubX];
+		ULONG ulBlockedE = pBlockedMasks[ubX + 1];
+		ULONG ulFeature = (
+			pFeatureMasks[ubX - 1] | pFeatureMasks[ubX] | pFeatureMasks[ubX + 1]
+		);
+		for(UBYTE ubY = 1; ubY < MAP_TILE_HEIGHT - 1; ++ubY) {
+			const tAutotileKind *pKind = &s_pAutotileKinds[
+				pLevel->pTiles[ubX][ubY] & MAP_TILE_INDEX_MASK
+			];
+			UBYTE ubVisTile = AUTOTILE_UNHANDLED;
+			if(pKind->isBitboard && !(ulFeature & AUTOTILE_COLUMN_WINDOW_MASK)) {
+				UWORD uwSignature = s_pAutotileWallWindow[
+					(ulOnWallW & AUTOTILE_COLUMN_WINDOW_MASK) | ((ulOnWallC & AUTOTILE_COLUMN_WINDOW_MASK) << 3) |
+					((ulOnWallE & AUTOTILE_COLUMN_WINDOW_MASK) << 6)
+				];
+				UWORD uwBlocked = (
+					(ulBlockedW & AUTOTILE_COLUMN_WINDOW_MASK) | ((ulBlockedC & AUTOTILE_COLUMN_WINDOW_MASK) << 3) |
+					((ulBlockedE & AUTOTILE_COLUMN_WINDOW_MASK) << 6)
+				);
+				if(uwBlocked & AUTOTILE_WINDOW_ORTH) {
+					uwSignature |= pKind->uwBlockedOrthBits;
+				}
+				if(uwBlocked & AUTOTILE_WINDOW_DIAG) {
+					uwSignature |= pKind->uwBlockedDiagBits;
+				}
+				ubVisTile = s_pAutotileLut[pKind->uwLutOffset + uwSignature];
+			}
+			if(ubVisTile == AUTOTILE_UNHANDLED) {
+				// Features nearby or shape not in table - let per-tile path handle it
+				ubVisTile = autotileGetVisTile(pLevel, ubX, ubY);
+			}
+			pLevel->pVisTiles[ubX][ubY] = ubVisTile;
+
+			ulOnWallW >>= 1;
+			ulOnWallC >>= 1;
+			ulOnWallE >>= 1;
+			ulBlockedW >>= 1;
+			ulBlockedC >>= 1;
+			ulBlockedE >>= 1;
+			ulFeature >>= 1;
+		}
+	}
+}
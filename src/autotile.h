@@ -0,0 +1,28 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_AUTOTILE_H
+#define SLIPGATES_AUTOTILE_H
+
+#include "map.h"
+
+/**
+ * @brief Calculates vis tile from given tile and its neighbours, using
+ * tables generated by autotile_gen.py.
+ *
+ * @param pLevel Level with logic tiles to be checked.
+ * @param ubTileX X of tile.
+ * @param ubTileY Y of tile.
+ * @return Vis tile, wall on map's edges.
+ */
+tVisTile autotileGetVisTile(const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY);
+
+/**
+ * @brief Fills all vis tiles of given level. Gives the same result as
+ * autotileGetVisTile() on each tile, but most of them are resolved at once
+ * from per-column bitmasks.
+ */
+void autotileRecalcAllVisTiles(tLevel *pLevel);
+
+#endif // SLIPGATES_AUTOTILE_H
@@ -37,11 +37,26 @@ void bodyInit(
 	pBody->isSlipgatable = 1;
 }
 
+static UBYTE bodyGetSlipgateIndexAt(
+	UWORD uwTileX, UWORD uwTileY, tDirection eNormal
+) {
+	// DIRECTION_NONE accepts slipgate with any normal
+	UBYTE ubIndex = mapGetSlipgateIndexAt(uwTileX, uwTileY);
+	if(
+		ubIndex == SLIPGATE_INDEX_NONE || !mapIsSlipgateTunnelOpen(ubIndex) ||
+		(eNormal != DIRECTION_NONE && g_pSlipgates[ubIndex].eNormal != eNormal)
+	) {
+		return SLIPGATE_INDEX_NONE;
+	}
+	return ubIndex;
+}
+
 static UBYTE bodyTryMoveViaSlipgate(tBodyBox *pBody, UBYTE ubIndexSrc) {
 	if(!pBody->isSlipgatable) {
 		return 0;
 	}
 
+	UBYTE ubIndexDst = g_pSlipgates[ubIndexSrc].ubLinkedIndex;
 	fix16_t fOldX = pBody->fPosX;
 	fix16_t fOldY = pBody->fPosY;
 
@@ -49,34 +64,34 @@ static UBYTE bodyTryMoveViaSlipgate(tBodyBox *pBody, UBYTE ubIndexSrc) {
 
 	switch(g_pSlipgates[ubIndexSrc].eNormal) {
 		case DIRECTION_UP:
-			switch(g_pSlipgates[!ubIndexSrc].eNormal) {
+			switch(g_pSlipgates[ubIndexDst].eNormal) {
 				case DIRECTION_UP: {
-					WORD wDeltaX = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE);
+					WORD wDeltaX = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[ubIndexDst].sTilePositions[0].ubX * MAP_TILE_SIZE);
 					pBody->fPosX = fix16_add(pBody->fPosX, fix16_from_int(wDeltaX));
 					pBody->fVelocityY = -pBody->fVelocityY;
 					if(pBody->fVelocityY > -(fix16_one)) {
 						pBody->fVelocityY = -(fix16_one);
 					}
 					// Be sure to teleport exactly at same height, otherwise U-loop will increase velocity
-					UWORD wDeltaY = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					UWORD wDeltaY = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 					pBody->fPosY = fix16_add(pBody->fPosY, fix16_from_int(wDeltaY));
 				} break;
 				case DIRECTION_DOWN: {
-					WORD wDeltaX = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE);
+					WORD wDeltaX = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[ubIndexDst].sTilePositions[0].ubX * MAP_TILE_SIZE);
 					pBody->fPosX = fix16_add(pBody->fPosX, fix16_from_int(wDeltaX));
-					pBody->fPosY = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY + 1) * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubY + 1) * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_LEFT: {
 					pBody->fVelocityX = -pBody->fVelocityY;
 					pBody->fVelocityY = 0; // faster / easier to control (?) than swapped variant
-					pBody->fPosX = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE - pBody->ubWidth);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubX * MAP_TILE_SIZE - pBody->ubWidth);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_RIGHT: {
 					pBody->fVelocityX = pBody->fVelocityY;
 					pBody->fVelocityY = 0; // faster / easier to control (?) than swapped variant
-					pBody->fPosX = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_NONE:
 				case DIRECTION_COUNT:
@@ -84,31 +99,31 @@ static UBYTE bodyTryMoveViaSlipgate(tBodyBox *pBody, UBYTE ubIndexSrc) {
 			}
 			break;
 		case DIRECTION_DOWN:
-			switch(g_pSlipgates[!ubIndexSrc].eNormal) {
+			switch(g_pSlipgates[ubIndexDst].eNormal) {
 				case DIRECTION_UP: {
-					WORD wDeltaX = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE);
+					WORD wDeltaX = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[ubIndexDst].sTilePositions[0].ubX * MAP_TILE_SIZE);
 					pBody->fPosX = fix16_add(pBody->fPosX, fix16_from_int(wDeltaX));
-					pBody->fPosY = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY) * MAP_TILE_SIZE - pBody->ubHeight);
+					pBody->fPosY = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubY) * MAP_TILE_SIZE - pBody->ubHeight);
 				} break;
 				case DIRECTION_DOWN: {
-					WORD wDeltaX = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE);
+					WORD wDeltaX = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[ubIndexDst].sTilePositions[0].ubX * MAP_TILE_SIZE);
 					pBody->fPosX = fix16_add(pBody->fPosX, fix16_from_int(wDeltaX));
 					pBody->fVelocityY = -pBody->fVelocityY;
 					// Be sure to teleport exactly at same height, otherwise U-loop will increase velocity
-					UWORD wDeltaY = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					UWORD wDeltaY = -(WORD)(g_pSlipgates[ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE) + (WORD)(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 					pBody->fPosY = fix16_add(pBody->fPosY, fix16_from_int(wDeltaY));
 				} break;
 				case DIRECTION_LEFT: {
 					pBody->fVelocityX = pBody->fVelocityY;
 					pBody->fVelocityY = 0; // faster / easier to control (?) than swapped variant
-					pBody->fPosX = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX) * MAP_TILE_SIZE - pBody->ubWidth);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubX) * MAP_TILE_SIZE - pBody->ubWidth);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_RIGHT: {
 					pBody->fVelocityX = -pBody->fVelocityY;
 					pBody->fVelocityY = 0; // faster / easier to control (?) than swapped variant
-					pBody->fPosX = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_NONE:
 				case DIRECTION_COUNT:
@@ -116,27 +131,27 @@ static UBYTE bodyTryMoveViaSlipgate(tBodyBox *pBody, UBYTE ubIndexSrc) {
 			}
 			break;
 		case DIRECTION_LEFT:
-			switch(g_pSlipgates[!ubIndexSrc].eNormal) {
+			switch(g_pSlipgates[ubIndexDst].eNormal) {
 				case DIRECTION_UP: {
 					pBody->fVelocityY = -pBody->fVelocityX;
 					pBody->fVelocityX = 0; // faster / easier to control (?) than swapped variant
-					pBody->fPosX = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE - pBody->ubHeight);
+					pBody->fPosX = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE - pBody->ubHeight);
 				} break;
 				case DIRECTION_DOWN: {
 					pBody->fVelocityY = pBody->fVelocityX;
 					pBody->fVelocityX = 0; // faster / easier to control (?) than swapped variant
-					pBody->fPosX = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
-					pBody->fPosY = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY + 1) * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubY + 1) * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_LEFT: {
 					pBody->fVelocityX = -pBody->fVelocityX;
-					pBody->fPosX = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE - pBody->ubWidth);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubX * MAP_TILE_SIZE - pBody->ubWidth);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_RIGHT: {
-					pBody->fPosX = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_NONE:
 				case DIRECTION_COUNT:
@@ -144,27 +159,27 @@ static UBYTE bodyTryMoveViaSlipgate(tBodyBox *pBody, UBYTE ubIndexSrc) {
 			}
 			break;
 		case DIRECTION_RIGHT:
-			switch(g_pSlipgates[!ubIndexSrc].eNormal) {
+			switch(g_pSlipgates[ubIndexDst].eNormal) {
 				case DIRECTION_UP: {
 					pBody->fVelocityY = pBody->fVelocityX;
 					pBody->fVelocityX = 0; // faster / easier to control (?) than swapped variant
-					pBody->fPosX = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE - pBody->ubHeight);
+					pBody->fPosX = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubX * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE - pBody->ubHeight);
 				} break;
 				case DIRECTION_DOWN: {
 					pBody->fVelocityY = -pBody->fVelocityX;
 					pBody->fVelocityX = 0; // faster / easier to control (?) than swapped variant
-					pBody->fPosX = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX * MAP_TILE_SIZE);
-					pBody->fPosY = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY + 1) * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubX * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubY + 1) * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_LEFT: {
-					pBody->fPosX = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX) * MAP_TILE_SIZE- pBody->ubWidth);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubX) * MAP_TILE_SIZE- pBody->ubWidth);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_RIGHT: {
 					pBody->fVelocityX = -pBody->fVelocityX;
-					pBody->fPosX = fix16_from_int((g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
-					pBody->fPosY = fix16_from_int(g_pSlipgates[!ubIndexSrc].sTilePositions[0].ubY * MAP_TILE_SIZE);
+					pBody->fPosX = fix16_from_int((g_pSlipgates[ubIndexDst].sTilePositions[0].ubX + 1) * MAP_TILE_SIZE);
+					pBody->fPosY = fix16_from_int(g_pSlipgates[ubIndexDst].sTilePositions[0].ubY * MAP_TILE_SIZE);
 				} break;
 				case DIRECTION_NONE:
 				case DIRECTION_COUNT:
@@ -182,7 +197,7 @@ static UBYTE bodyTryMoveViaSlipgate(tBodyBox *pBody, UBYTE ubIndexSrc) {
 	}
 
 	vfxStartSlipgate(
-		ubIndexSrc,
+		g_pSlipgates[ubIndexSrc].ubColor,
 		fix16_to_int(fOldX), fix16_to_int(fOldY),
 		fix16_to_int(pBody->fPosX), fix16_to_int(pBody->fPosY)
 	);
@@ -211,6 +226,7 @@ void bodySimulate(tBodyBox *pBody) {
 	UWORD uwLeft = fix16_to_int(fNewPosX);
 	UWORD uwRight = uwLeft + pBody->ubWidth - 1;
 
+	UBYTE ubSlipgateIndex;
 	pBody->isOnGround = 0;
 	if(fVeloClampedX > 0) {
 		// moving right
@@ -225,27 +241,10 @@ void bodySimulate(tBodyBox *pBody) {
 			fNewPosX = fix16_from_int(uwTileRight * MAP_TILE_SIZE - pBody->ubWidth);
 			pBody->fVelocityX = 0;
 		}
-		else if(
-			mapGetTileAt(uwTileRight, uwBottom  / MAP_TILE_SIZE) == TILE_SLIPGATE_A &&
-			g_pSlipgates[SLIPGATE_A].eNormal == DIRECTION_LEFT
-		) {
-			// Slipgate A
-			if(bodyTryMoveViaSlipgate(pBody, 0)) {
-				fNewPosX = pBody->fPosX;
-				fNewPosY = pBody->fPosY;
-			}
-			else {
-				// collide with wall
-				fNewPosX = fix16_from_int(uwTileRight * MAP_TILE_SIZE - pBody->ubWidth);
-				pBody->fVelocityX = 0;
-			}
-		}
-		else if(
-			mapGetTileAt(uwTileRight, uwBottom  / MAP_TILE_SIZE) == TILE_SLIPGATE_B &&
-			g_pSlipgates[SLIPGATE_B].eNormal == DIRECTION_LEFT
-		) {
-			// Slipgate B
-			if(bodyTryMoveViaSlipgate(pBody, 1)) {
+		else if((ubSlipgateIndex = bodyGetSlipgateIndexAt(
+			uwTileRight, uwBottom / MAP_TILE_SIZE, DIRECTION_LEFT
+		)) != SLIPGATE_INDEX_NONE) {
+			if(bodyTryMoveViaSlipgate(pBody, ubSlipgateIndex)) {
 				fNewPosX = pBody->fPosX;
 				fNewPosY = pBody->fPosY;
 			}
@@ -268,27 +267,10 @@ void bodySimulate(tBodyBox *pBody) {
 			fNewPosX = fix16_from_int((uwTileLeft + 1) * MAP_TILE_SIZE);
 			pBody->fVelocityX = 0;
 		}
-		else if(
-			mapGetTileAt(uwTileLeft, uwBottom  / MAP_TILE_SIZE) == TILE_SLIPGATE_A &&
-			g_pSlipgates[SLIPGATE_A].eNormal == DIRECTION_RIGHT
-		) {
-			// Slipgate A
-			if(bodyTryMoveViaSlipgate(pBody, 0)) {
-				fNewPosX = pBody->fPosX;
-				fNewPosY = pBody->fPosY;
-			}
-			else {
-				// collide with wall
-				fNewPosX = fix16_from_int((uwTileLeft + 1) * MAP_TILE_SIZE);
-				pBody->fVelocityX = 0;
-			}
-		}
-		else if(
-			mapGetTileAt(uwTileLeft, uwBottom  / MAP_TILE_SIZE) == TILE_SLIPGATE_B &&
-			g_pSlipgates[SLIPGATE_B].eNormal == DIRECTION_RIGHT
-		) {
-			// Slipgate B
-			if(bodyTryMoveViaSlipgate(pBody, 1)) {
+		else if((ubSlipgateIndex = bodyGetSlipgateIndexAt(
+			uwTileLeft, uwBottom / MAP_TILE_SIZE, DIRECTION_RIGHT
+		)) != SLIPGATE_INDEX_NONE) {
+			if(bodyTryMoveViaSlipgate(pBody, ubSlipgateIndex)) {
 				fNewPosX = pBody->fPosX;
 				fNewPosY = pBody->fPosY;
 			}
@@ -339,36 +321,10 @@ void bodySimulate(tBodyBox *pBody) {
 				}
 			}
 		}
-		else if(
-			mapGetTileAt(uwLeft / MAP_TILE_SIZE, uwTileBottom) == TILE_SLIPGATE_A &&
-			g_pSlipgates[SLIPGATE_A].eNormal == DIRECTION_UP
-		) {
-			// Slipgate A
-			if(bodyTryMoveViaSlipgate(pBody, 0)) {
-				fNewPosY = pBody->fPosY;
-			}
-			else {
-				// collide with floor
-				uwTop = ((uwTileBottom) * MAP_TILE_SIZE) - pBody->ubHeight;
-				fNewPosY = fix16_from_int(uwTop);
-				pBody->fVelocityY = 0;
-				pBody->isOnGround = 1;
-				if(pBody->fVelocityX) {
-					if(pBody->fVelocityX > 0) {
-						pBody->fVelocityX = fix16_max(fix16_sub(pBody->fVelocityX, s_fFriction), 0);
-					}
-					else {
-						pBody->fVelocityX = fix16_min(fix16_add(pBody->fVelocityX, s_fFriction), 0);
-					}
-				}
-			}
-		}
-		else if(
-			mapGetTileAt(uwLeft / MAP_TILE_SIZE, uwTileBottom) == TILE_SLIPGATE_B &&
-			g_pSlipgates[SLIPGATE_B].eNormal == DIRECTION_UP
-		) {
-			// Slipgate B
-			if(bodyTryMoveViaSlipgate(pBody, 1)) {
+		else if((ubSlipgateIndex = bodyGetSlipgateIndexAt(
+			uwLeft / MAP_TILE_SIZE, uwTileBottom, DIRECTION_UP
+		)) != SLIPGATE_INDEX_NONE) {
+			if(bodyTryMoveViaSlipgate(pBody, ubSlipgateIndex)) {
 				fNewPosY = pBody->fPosY;
 			}
 			else {
@@ -398,20 +354,10 @@ void bodySimulate(tBodyBox *pBody) {
 			fNewPosY = fix16_from_int((uwTop / MAP_TILE_SIZE + 1) * MAP_TILE_SIZE);
 			pBody->fVelocityY = 0;
 		}
-		else if(mapGetTileAt(uwLeft / MAP_TILE_SIZE, uwTop / MAP_TILE_SIZE) == TILE_SLIPGATE_A) {
-			// Slipgate A
-			if(bodyTryMoveViaSlipgate(pBody, 0)) {
-				fNewPosY = pBody->fPosY;
-			}
-			else {
-				// collide with ceil
-				fNewPosY = fix16_from_int((uwTop / MAP_TILE_SIZE + 1) * MAP_TILE_SIZE);
-				pBody->fVelocityY = 0;
-			}
-		}
-		else if(mapGetTileAt(uwLeft / MAP_TILE_SIZE, uwTop / MAP_TILE_SIZE) == TILE_SLIPGATE_B) {
-			// Slipgate B
-			if(bodyTryMoveViaSlipgate(pBody, 1)) {
+		else if((ubSlipgateIndex = bodyGetSlipgateIndexAt(
+			uwLeft / MAP_TILE_SIZE, uwTop / MAP_TILE_SIZE, DIRECTION_NONE
+		)) != SLIPGATE_INDEX_NONE) {
+			if(bodyTryMoveViaSlipgate(pBody, ubSlipgateIndex)) {
 				fNewPosY = pBody->fPosY;
 			}
 			else {
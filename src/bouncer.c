@@ -4,6 +4,7 @@
 
 #include "bouncer.h"
 #include "game.h"
+#include "timer_wheel.h"
 
 #define BOUNCER_LIFE_COOLDOWN 500
 #define BOUNCER_SPAWN_COOLDOWN 100
@@ -21,7 +22,7 @@ static UBYTE s_hasBouncerNewVelocity;
 static fix16_t s_fNewBouncerVelocityX;
 static fix16_t s_fNewBouncerVelocityY;
 static tBouncerState s_eBouncerState;
-static UWORD s_uwBouncerCooldown;
+static tTimer s_sBouncerTimer;
 static fix16_t s_fSpawnVelocityX;
 static fix16_t s_fSpawnVelocityY;
 static fix16_t s_fSpawnPositionX;
@@ -29,6 +30,22 @@ static fix16_t s_fSpawnPositionY;
 
 //------------------------------------------------------------------ PRIVATE FNS
 
+static void bouncerOnLifeEnd(void *pData);
+
+static void bouncerOnSpawn(UNUSED_ARG void *pData) {
+	s_sBodyBouncer.fPosX = s_fSpawnPositionX;
+	s_sBodyBouncer.fPosY = s_fSpawnPositionY;
+	s_sBodyBouncer.fVelocityX = s_fSpawnVelocityX;
+	s_sBodyBouncer.fVelocityY = s_fSpawnVelocityY;
+	s_eBouncerState = BOUNCER_STATE_MOVING;
+	timerWheelSchedule(&s_sBouncerTimer, BOUNCER_LIFE_COOLDOWN, bouncerOnLifeEnd, 0);
+}
+
+static void bouncerOnLifeEnd(UNUSED_ARG void *pData) {
+	s_eBouncerState = BOUNCER_STATE_WAITING_FOR_SPAWN;
+	timerWheelSchedule(&s_sBouncerTimer, BOUNCER_SPAWN_COOLDOWN, bouncerOnSpawn, 0);
+}
+
 static UBYTE bouncerCollisionHandler(
 	tTile eTile, UNUSED_ARG UBYTE ubTileX, UNUSED_ARG UBYTE ubTileY,
 	UNUSED_ARG void *pData, UNUSED_ARG tDirection eBodyMovementDirection
@@ -37,10 +54,13 @@ static UBYTE bouncerCollisionHandler(
 	if(isColliding) {
 		if(eTile == TILE_RECEIVER) {
 			s_eBouncerState = BOUNCER_STATE_RECEIVER_REACHED;
+			timerWheelCancel(&s_sBouncerTimer);
 		}
 		else {
 			if(eTile == TILE_BOUNCER_SPAWNER) {
-				s_uwBouncerCooldown = BOUNCER_LIFE_COOLDOWN;
+				timerWheelSchedule(
+					&s_sBouncerTimer, BOUNCER_LIFE_COOLDOWN, bouncerOnLifeEnd, 0
+				);
 			}
 			s_hasBouncerNewVelocity = 1;
 			s_fNewBouncerVelocityX = -s_sBodyBouncer.fVelocityX;
@@ -53,6 +73,7 @@ static UBYTE bouncerCollisionHandler(
 //------------------------------------------------------------------- PUBLIC FNS
 
 void bouncerInit(UBYTE ubSpawnerTileX, UBYTE ubSpawnerTileY) {
+	timerWheelCancel(&s_sBouncerTimer);
 	if(ubSpawnerTileX == BOUNCER_TILE_INVALID || ubSpawnerTileY == BOUNCER_TILE_INVALID) {
 		s_eBouncerState = BOUNCER_STATE_INVALID;
 		return;
@@ -89,7 +110,7 @@ void bouncerInit(UBYTE ubSpawnerTileX, UBYTE ubSpawnerTileY) {
 	s_sBodyBouncer.fAccelerationY = 0;
 	s_hasBouncerNewVelocity = 0;
 	s_eBouncerState = BOUNCER_STATE_WAITING_FOR_SPAWN;
-	s_uwBouncerCooldown = 1;
+	timerWheelSchedule(&s_sBouncerTimer, 1, bouncerOnSpawn, 0);
 }
 
 UBYTE bouncerProcess(void) {
@@ -97,43 +118,30 @@ UBYTE bouncerProcess(void) {
 		case BOUNCER_STATE_INVALID:
 			break;
 		case BOUNCER_STATE_WAITING_FOR_SPAWN:
-			if(--s_uwBouncerCooldown == 0) {
-				s_sBodyBouncer.fPosX = s_fSpawnPositionX;
-				s_sBodyBouncer.fPosY = s_fSpawnPositionY;
-				s_sBodyBouncer.fVelocityX = s_fSpawnVelocityX;
-				s_sBodyBouncer.fVelocityY = s_fSpawnVelocityY;
-				s_uwBouncerCooldown = BOUNCER_LIFE_COOLDOWN;
-				s_eBouncerState = BOUNCER_STATE_MOVING;
-			}
+			// Spawned by timer
 			break;
-		case BOUNCER_STATE_MOVING:
-			if(--s_uwBouncerCooldown == 0) {
-				s_uwBouncerCooldown = BOUNCER_SPAWN_COOLDOWN;
-				s_eBouncerState = BOUNCER_STATE_WAITING_FOR_SPAWN;
+		case BOUNCER_STATE_MOVING: {
+			bodySimulate(&s_sBodyBouncer);
+			if(s_hasBouncerNewVelocity) {
+				s_sBodyBouncer.fVelocityX = s_fNewBouncerVelocityX;
+				s_sBodyBouncer.fVelocityY = s_fNewBouncerVelocityY;
+				s_hasBouncerNewVelocity = 0;
 			}
-			else {
-				bodySimulate(&s_sBodyBouncer);
-				if(s_hasBouncerNewVelocity) {
-					s_sBodyBouncer.fVelocityX = s_fNewBouncerVelocityX;
-					s_sBodyBouncer.fVelocityY = s_fNewBouncerVelocityY;
-					s_hasBouncerNewVelocity = 0;
-				}
-
-				// Collision with player
-				tPlayer *pPlayer = gameGetPlayer();
-				UBYTE isCollidingWithPlayer = (
-					s_sBodyBouncer.sBob.sPos.uwX < pPlayer->sBody.sBob.sPos.uwX + pPlayer->sBody.ubWidth &&
-					s_sBodyBouncer.sBob.sPos.uwX + s_sBodyBouncer.ubWidth > pPlayer->sBody.sBob.sPos.uwX &&
-					s_sBodyBouncer.sBob.sPos.uwY < pPlayer->sBody.sBob.sPos.uwY + pPlayer->sBody.ubHeight &&
-					s_sBodyBouncer.sBob.sPos.uwY + s_sBodyBouncer.ubHeight > pPlayer->sBody.sBob.sPos.uwY
-				);
-				if(isCollidingWithPlayer) {
-					playerDamage(pPlayer, 100);
-				}
 
-				return 1;
+			// Collision with player
+			tPlayer *pPlayer = gameGetPlayer();
+			UBYTE isCollidingWithPlayer = (
+				s_sBodyBouncer.sBob.sPos.uwX < pPlayer->sBody.sBob.sPos.uwX + pPlayer->sBody.ubWidth &&
+				s_sBodyBouncer.sBob.sPos.uwX + s_sBodyBouncer.ubWidth > pPlayer->sBody.sBob.sPos.uwX &&
+				s_sBodyBouncer.sBob.sPos.uwY < pPlayer->sBody.sBob.sPos.uwY + pPlayer->sBody.ubHeight &&
+				s_sBodyBouncer.sBob.sPos.uwY + s_sBodyBouncer.ubHeight > pPlayer->sBody.sBob.sPos.uwY
+			);
+			if(isCollidingWithPlayer) {
+				playerDamage(pPlayer, 100);
 			}
-			break;
+
+			return 1;
+		}
 		case BOUNCER_STATE_RECEIVER_REACHED:
 			mapPressButtonIndex(MAP_BOUNCER_BUTTON_INDEX);
 			break;
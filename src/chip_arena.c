@@ -0,0 +1,172 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "chip_arena.h"
+#include <ace/managers/memory.h>
+#include <ace/managers/log.h>
+#include "arena.h"
+
+// Bitmap structs aren't read by custom chips, so they're kept in fast mem,
+// linked per scope so that they're freed along with scope's chip block.
+typedef struct tChipArenaFastBlock {
+	struct tChipArenaFastBlock *pNext;
+	ULONG ulSize;
+} tChipArenaFastBlock;
+
+static const char *s_pScopeNames[CHIP_ARENA_SCOPE_COUNT] = {"assets", "state"};
+
+static tArena s_pArenas[CHIP_ARENA_SCOPE_COUNT];
+static ULONG s_pScopeSizesMax[CHIP_ARENA_SCOPE_COUNT];
+static tChipArenaFastBlock *s_pFastBlocks[CHIP_ARENA_SCOPE_COUNT];
+
+static UWORD chipArenaGetPlaneRowSize(UWORD uwWidth) {
+	return ((uwWidth + 15) >> 4) << 1;
+}
+
+static void *chipArenaAllocFast(tChipArenaScope eScope, ULONG ulSize) {
+	ULONG ulBlockSize = sizeof(tChipArenaFastBlock) + ulSize;
+	tChipArenaFastBlock *pBlock = memAllocFast(ulBlockSize);
+	if(!pBlock) {
+		logWrite("ERR: No fast mem for %s arena struct: %lu\n", s_pScopeNames[eScope], ulSize);
+		return 0;
+	}
+	pBlock->pNext = s_pFastBlocks[eScope];
+	pBlock->ulSize = ulBlockSize;
+	s_pFastBlocks[eScope] = pBlock;
+	return &pBlock[1];
+}
+
+UBYTE chipArenaOpen(tChipArenaScope eScope, ULONG ulSize) {
+	tArena *pArena = &s_pArenas[eScope];
+	if(pArena->pBase) {
+		logWrite("ERR: Chip arena %s already open\n", s_pScopeNames[eScope]);
+		return 0;
+	}
+
+	UBYTE *pBase = memAllocChip(ulSize);
+	if(!pBase) {
+		logWrite("ERR: No chip mem for %s arena: %lu\n", s_pScopeNames[eScope], ulSize);
+		return 0;
+	}
+	arenaInit(pArena, pBase, ulSize);
+	if(ulSize > s_pScopeSizesMax[eScope]) {
+		s_pScopeSizesMax[eScope] = ulSize;
+	}
+	return 1;
+}
+
+void chipArenaClose(tChipArenaScope eScope) {
+	tArena *pArena = &s_pArenas[eScope];
+	if(pArena->pBase) {
+		memFree(pArena->pBase, pArena->ulSize);
+		pArena->pBase = 0;
+	}
+	while(s_pFastBlocks[eScope]) {
+		tChipArenaFastBlock *pBlock = s_pFastBlocks[eScope];
+		s_pFastBlocks[eScope] = pBlock->pNext;
+		memFree(pBlock, pBlock->ulSize);
+	}
+}
+
+UBYTE chipArenaCheckUsed(tChipArenaScope eScope) {
+	const tArena *pArena = &s_pArenas[eScope];
+	if(pArena->ulUsed != pArena->ulSize) {
+		logWrite(
+			"ERR: Chip arena %s size doesn't match allocations, used %lu/%lu\n",
+			s_pScopeNames[eScope], pArena->ulUsed, pArena->ulSize
+		);
+		return 0;
+	}
+	return 1;
+}
+
+void *chipArenaAlloc(tChipArenaScope eScope, ULONG ulSize) {
+	void *pBlock = arenaAlloc(&s_pArenas[eScope], ulSize);
+	if(!pBlock) {
+		logWrite(
+			"ERR: Chip arena %s exhausted, requested %lu, used %lu/%lu\n",
+			s_pScopeNames[eScope], ulSize, s_pArenas[eScope].ulUsed,
+			s_pArenas[eScope].ulSize
+		);
+	}
+	return pBlock;
+}
+
+ULONG chipArenaGetBitmapSize(UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth) {
+	return ARENA_ALIGN((ULONG)chipArenaGetPlaneRowSize(uwWidth) * uwHeight * ubDepth);
+}
+
+ULONG chipArenaGetTextBitMapSize(UWORD uwWidth, UWORD uwHeight) {
+	return chipArenaGetBitmapSize(uwWidth, uwHeight, 1);
+}
+
+void chipArenaBitmapInit(
+	tBitMap *pBitMap, UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth,
+	UBYTE ubFlags, UBYTE *pPlanes
+) {
+	UWORD uwPlaneRowSize = chipArenaGetPlaneRowSize(uwWidth);
+	pBitMap->Rows = uwHeight;
+	pBitMap->Depth = ubDepth;
+	pBitMap->Planes[0] = pPlanes;
+	if(ubFlags & BMF_INTERLEAVED) {
+		pBitMap->Flags = BMF_INTERLEAVED;
+		pBitMap->BytesPerRow = uwPlaneRowSize * ubDepth;
+		for(UBYTE i = 1; i < ubDepth; ++i) {
+			pBitMap->Planes[i] = pBitMap->Planes[i - 1] + uwPlaneRowSize;
+		}
+	}
+	else {
+		pBitMap->Flags = 0;
+		pBitMap->BytesPerRow = uwPlaneRowSize;
+		for(UBYTE i = 1; i < ubDepth; ++i) {
+			pBitMap->Planes[i] = pBitMap->Planes[i - 1] + uwPlaneRowSize * uwHeight;
+		}
+	}
+}
+
+tBitMap *chipArenaBitmapCreate(
+	tChipArenaScope eScope, UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth,
+	UBYTE ubFlags
+) {
+	ULONG ulPlanesSize = (ULONG)chipArenaGetPlaneRowSize(uwWidth) * uwHeight * ubDepth;
+	tBitMap *pBitMap = chipArenaAllocFast(eScope, sizeof(*pBitMap));
+	UBYTE *pPlanes = chipArenaAlloc(eScope, ulPlanesSize);
+	if(!pBitMap || !pPlanes) {
+		return 0;
+	}
+
+	chipArenaBitmapInit(pBitMap, uwWidth, uwHeight, ubDepth, ubFlags, pPlanes);
+	if(ubFlags & BMF_CLEAR) {
+		memset(pPlanes, 0, ulPlanesSize);
+	}
+	return pBitMap;
+}
+
+tTextBitMap *chipArenaTextBitMapCreate(
+	tChipArenaScope eScope, UWORD uwWidth, UWORD uwHeight
+) {
+	tTextBitMap *pTextBitMap = chipArenaAllocFast(eScope, sizeof(*pTextBitMap));
+	if(!pTextBitMap) {
+		return 0;
+	}
+	pTextBitMap->pBitMap = chipArenaBitmapCreate(
+		eScope, uwWidth, uwHeight, 1, BMF_CLEAR
+	);
+	if(!pTextBitMap->pBitMap) {
+		return 0;
+	}
+	pTextBitMap->uwActualWidth = 0;
+	pTextBitMap->uwActualHeight = 0;
+	return pTextBitMap;
+}
+
+void chipArenaLogStats(void) {
+	logWrite("Chip arena stats:\n");
+	for(UBYTE i = 0; i < CHIP_ARENA_SCOPE_COUNT; ++i) {
+		logWrite(
+			"  %s: size max %lu, high water %lu\n",
+			s_pScopeNames[i], s_pScopeSizesMax[i], s_pArenas[i].ulHighWater
+		);
+	}
+}
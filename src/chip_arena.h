@@ -0,0 +1,84 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_CHIP_ARENA_H
+#define SLIPGATES_CHIP_ARENA_H
+
+#include <ace/utils/font.h>
+
+typedef enum tChipArenaScope {
+	CHIP_ARENA_SCOPE_ASSETS, // Resident game assets, may outlive game states
+	CHIP_ARENA_SCOPE_STATE, // Current top-level state: menu, cutscene or game
+	CHIP_ARENA_SCOPE_COUNT
+} tChipArenaScope;
+
+/**
+ * @brief Allocates chip mem block for given scope. Everything allocated
+ * in scope is taken from that block.
+ *
+ * @param ulSize Block size, sum of chipArenaGet*Size() of all allocations.
+ * @return 1 on success, 0 if scope is already open or there's no chip mem.
+ */
+UBYTE chipArenaOpen(tChipArenaScope eScope, ULONG ulSize);
+
+/**
+ * @brief Releases all allocations of given scope, chip ones with single free.
+ */
+void chipArenaClose(tChipArenaScope eScope);
+
+/**
+ * @brief Checks that size passed to chipArenaOpen() was used up exactly,
+ * i.e. that it was summed from the same allocations as were made.
+ *
+ * @return 1 if whole block is used, otherwise 0 and error is logged.
+ */
+UBYTE chipArenaCheckUsed(tChipArenaScope eScope);
+
+void *chipArenaAlloc(tChipArenaScope eScope, ULONG ulSize);
+
+/**
+ * @brief Returns chip mem taken by bitmap planes. Struct itself is in fast mem.
+ */
+ULONG chipArenaGetBitmapSize(UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth);
+
+ULONG chipArenaGetTextBitMapSize(UWORD uwWidth, UWORD uwHeight);
+
+/**
+ * @brief Fills bitmap struct so that it uses given plane data, laid out
+ * the same way as in bitmapCreate().
+ *
+ * @param ubFlags BMF_INTERLEAVED or zero.
+ */
+void chipArenaBitmapInit(
+	tBitMap *pBitMap, UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth,
+	UBYTE ubFlags, UBYTE *pPlanes
+);
+
+/**
+ * @brief Counterpart of bitmapCreate() taking plane memory from given
+ * scope. Struct is in fast mem, freed on chipArenaClose(). Bitmap must not
+ * be passed to bitmapDestroy().
+ *
+ * @param ubFlags Combination of BMF_INTERLEAVED and BMF_CLEAR.
+ */
+tBitMap *chipArenaBitmapCreate(
+	tChipArenaScope eScope, UWORD uwWidth, UWORD uwHeight, UBYTE ubDepth,
+	UBYTE ubFlags
+);
+
+/**
+ * @brief Counterpart of fontCreateTextBitMap() taking plane memory from
+ * given scope, like chipArenaBitmapCreate(). Text bitmap must not be passed
+ * to fontDestroyTextBitMap().
+ */
+tTextBitMap *chipArenaTextBitMapCreate(
+	tChipArenaScope eScope, UWORD uwWidth, UWORD uwHeight
+);
+
+/**
+ * @brief Writes size and high water mark of each scope to log.
+ */
+void chipArenaLogStats(void);
+
+#endif // SLIPGATES_CHIP_ARENA_H
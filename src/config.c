@@ -3,42 +3,191 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "config.h"
+#include <stddef.h>
 #include <ace/managers/system.h>
+#include <ace/managers/log.h>
 #include <ace/utils/disk_file.h>
 
+#define CONFIG_SAVE_PATH "save.dat"
+#define CONFIG_SAVE_BACKUP_PATH "save.bak"
+#define CONFIG_SAVE_LEGACY_SIZE 2
+#define CONFIG_SAVE_SLOT_COUNT 2
+#define CONFIG_SAVE_CHECKSUM_SEED 0x534C5356 // "SLSV"
+
+// Slots are written alternately, so that torn write of one of them
+// leaves previous save intact in the other one.
+typedef struct tConfigSaveSlot {
+	ULONG ulGeneration;
+	UBYTE ubUnlockedLevels;
+	UBYTE ubCurrentLevel;
+	UWORD uwReserved;
+	ULONG ulChecksum;
+} tConfigSaveSlot;
+
+// Generation of last loaded or written slot, zero if there's no valid save
+static ULONG s_ulSaveGeneration;
+// Set if save file has valid slots, so that only one of them needs rewriting
+static UBYTE s_isSaveFileValid;
+// Set if progress comes from backup, meaning that save file is unusable
+static UBYTE s_isBackupLoaded;
+
+static ULONG configGetSlotChecksum(const tConfigSaveSlot *pSlot) {
+	const UBYTE *pData = (const UBYTE*)pSlot;
+	ULONG ulChecksum = CONFIG_SAVE_CHECKSUM_SEED;
+	for(UBYTE i = 0; i < offsetof(tConfigSaveSlot, ulChecksum); ++i) {
+		ulChecksum = ((ulChecksum << 5) | (ulChecksum >> 27)) ^ pData[i];
+	}
+	return ulChecksum;
+}
+
+static UBYTE configIsSlotValid(const tConfigSaveSlot *pSlot) {
+	return (
+		pSlot->ulGeneration != 0 &&
+		pSlot->ulChecksum == configGetSlotChecksum(pSlot)
+	);
+}
+
+static ULONG configReadFile(const char *szPath, tConfigSaveSlot *pSlots) {
+	tFile *pFile = diskFileOpen(szPath, "rb");
+	if(!pFile) {
+		return 0;
+	}
+	ULONG ulRead = fileRead(pFile, pSlots, sizeof(*pSlots) * CONFIG_SAVE_SLOT_COUNT);
+	fileClose(pFile);
+	return ulRead;
+}
+
+static UBYTE configLoadSlots(const tConfigSaveSlot *pSlots) {
+	const tConfigSaveSlot *pLatest = 0;
+	for(UBYTE i = 0; i < CONFIG_SAVE_SLOT_COUNT; ++i) {
+		if(
+			configIsSlotValid(&pSlots[i]) &&
+			(!pLatest || pSlots[i].ulGeneration > pLatest->ulGeneration)
+		) {
+			pLatest = &pSlots[i];
+		}
+	}
+	if(!pLatest) {
+		return 0;
+	}
+	g_sConfig.ubUnlockedLevels = pLatest->ubUnlockedLevels;
+	g_sConfig.ubCurrentLevel = pLatest->ubCurrentLevel;
+	s_ulSaveGeneration = pLatest->ulGeneration;
+	return 1;
+}
+
+static UBYTE configLoadLegacy(const UBYTE *pProgress) {
+	// Old format with just the progress bytes, converted on next save.
+	// Rejects start of interrupted conversion, which has zeros there.
+	if(!pProgress[0] || !pProgress[1]) {
+		return 0;
+	}
+	g_sConfig.ubUnlockedLevels = pProgress[0];
+	g_sConfig.ubCurrentLevel = pProgress[1];
+	return 1;
+}
+
 void configResetProgress(void) {
 	g_sConfig.ubCurrentLevel = 1;
 	g_sConfig.ubUnlockedLevels = 1;
 }
 
+static UBYTE configWriteSlot(const tConfigSaveSlot *pSlot, UBYTE ubSlot) {
+	tFile *pFile = diskFileOpen(CONFIG_SAVE_PATH, "r+b");
+	if(!pFile) {
+		return 0;
+	}
+	fileSeek(pFile, ubSlot * sizeof(*pSlot), FILE_SEEK_SET);
+	UBYTE isWritten = fileWrite(pFile, pSlot, sizeof(*pSlot)) == sizeof(*pSlot);
+	fileClose(pFile);
+	return isWritten;
+}
+
+static UBYTE configWriteFile(const tConfigSaveSlot *pSlot) {
+	// Create file with the same progress in both slots. Previous file is kept
+	// as backup until new one is fully written - unless progress was loaded
+	// from backup, in which case previous file is an interrupted rewrite.
+	if(!s_isBackupLoaded) {
+		diskFileDelete(CONFIG_SAVE_BACKUP_PATH);
+		diskFileMove(CONFIG_SAVE_PATH, CONFIG_SAVE_BACKUP_PATH);
+	}
+	tConfigSaveSlot pSlots[CONFIG_SAVE_SLOT_COUNT];
+	for(UBYTE i = 0; i < CONFIG_SAVE_SLOT_COUNT; ++i) {
+		pSlots[i] = *pSlot;
+	}
+	UBYTE isWritten = 0;
+	tFile *pFile = diskFileOpen(CONFIG_SAVE_PATH, "wb");
+	if(pFile) {
+		isWritten = fileWrite(pFile, pSlots, sizeof(pSlots)) == sizeof(pSlots);
+		fileClose(pFile);
+	}
+	if(isWritten) {
+		diskFileDelete(CONFIG_SAVE_BACKUP_PATH);
+	}
+	return isWritten;
+}
+
 void configLoad(void) {
 	// Initialize with default values
 	configResetProgress();
+	s_ulSaveGeneration = 0;
+	s_isSaveFileValid = 0;
+	s_isBackupLoaded = 0;
 
 	systemUse();
-	tFile *pFile = diskFileOpen("save.dat", "rb");
-	if(!pFile) {
-		pFile = diskFileOpen("save.bak", "rb");
+	tConfigSaveSlot pSlots[CONFIG_SAVE_SLOT_COUNT];
+	ULONG ulRead = configReadFile(CONFIG_SAVE_PATH, pSlots);
+	if(ulRead == sizeof(pSlots) && configLoadSlots(pSlots)) {
+		s_isSaveFileValid = 1;
 	}
-	if(pFile) {
-		fileRead(pFile, &g_sConfig.ubUnlockedLevels, sizeof(g_sConfig.ubUnlockedLevels));
-		fileRead(pFile, &g_sConfig.ubCurrentLevel, sizeof(g_sConfig.ubCurrentLevel));
-		fileClose(pFile);
+	else {
+		// Backup is left by interrupted rewrite of whole file, in either format
+		tConfigSaveSlot pBackup[CONFIG_SAVE_SLOT_COUNT];
+		ULONG ulBackupRead = configReadFile(CONFIG_SAVE_BACKUP_PATH, pBackup);
+		UBYTE isLoaded = (
+			(ulBackupRead == sizeof(pBackup) && configLoadSlots(pBackup)) ||
+			(ulBackupRead == CONFIG_SAVE_LEGACY_SIZE && configLoadLegacy((const UBYTE*)pBackup))
+		);
+		s_isBackupLoaded = isLoaded;
+		if(!isLoaded && ulRead == CONFIG_SAVE_LEGACY_SIZE) {
+			isLoaded = configLoadLegacy((const UBYTE*)pSlots);
+		}
+		if(!isLoaded) {
+			logWrite("No valid save, starting with default progress\n");
+		}
 	}
 	systemUnuse();
 }
 
 void configSave(void) {
+	tConfigSaveSlot sSlot = {
+		.ulGeneration = s_ulSaveGeneration + 1,
+		.ubUnlockedLevels = g_sConfig.ubUnlockedLevels,
+		.ubCurrentLevel = g_sConfig.ubCurrentLevel,
+		.uwReserved = 0
+	};
+	sSlot.ulChecksum = configGetSlotChecksum(&sSlot);
+	UBYTE isWritten = 0;
+
 	systemUse();
-	diskFileMove("save.dat", "save.bak");
-	tFile *pFile = diskFileOpen("save.dat", "wb");
-	if(pFile) {
-		fileWrite(pFile, &g_sConfig.ubUnlockedLevels, sizeof(g_sConfig.ubUnlockedLevels));
-		fileWrite(pFile, &g_sConfig.ubCurrentLevel, sizeof(g_sConfig.ubCurrentLevel));
-		fileClose(pFile);
+	if(s_isSaveFileValid) {
+		// Overwrite older slot in place, the other one stays valid
+		isWritten = configWriteSlot(&sSlot, sSlot.ulGeneration % CONFIG_SAVE_SLOT_COUNT);
+	}
+	if(!isWritten) {
+		// No valid save yet or file can't be updated in place
+		isWritten = configWriteFile(&sSlot);
 	}
-	diskFileDelete("save.bak");
 	systemUnuse();
+
+	if(isWritten) {
+		s_ulSaveGeneration = sSlot.ulGeneration;
+		s_isSaveFileValid = 1;
+		s_isBackupLoaded = 0;
+	}
+	else {
+		logWrite("ERR: Couldn't write " CONFIG_SAVE_PATH "\n");
+	}
 }
 
 tConfig g_sConfig;
@@ -14,6 +14,7 @@
 // #include "color.h"
 // #include "music.h"
 #include "menu.h"
+#include "chip_arena.h"
 
 #define SLIDES_MAX 10
 #define LINES_PER_SLIDE_MAX 8
@@ -216,7 +217,17 @@ static void cutsceneGsCreate(void) {
 	UWORD pPalette[32];
 	paletteLoadFromPath("data/slipgates.plt", pPalette, 32);
 	s_pFade = fadeCreate(s_pView, pPalette, 32);
-	s_pTextBitmap = fontCreateTextBitMap(320 + 16, g_pFont->uwHeight);
+	ULONG ulArenaSize = chipArenaGetTextBitMapSize(320 + 16, g_pFont->uwHeight);
+	if(!chipArenaOpen(CHIP_ARENA_SCOPE_STATE, ulArenaSize)) {
+		// Resident game assets are the only chip mem which can be given back
+		assetsGameEvict();
+		if(!chipArenaOpen(CHIP_ARENA_SCOPE_STATE, ulArenaSize)) {
+			systemKill("No chip mem for cutscene");
+		}
+	}
+	s_pTextBitmap = chipArenaTextBitMapCreate(
+		CHIP_ARENA_SCOPE_STATE, 320 + 16, g_pFont->uwHeight
+	);
 
 	s_uwFontColorVal = pPalette[COLOR_TEXT];
 	s_pBlockAboveLine = copBlockCreate(s_pView->pCopList, 1, 0, 0);
@@ -351,7 +362,7 @@ static void cutsceneGsDestroy(void) {
 	systemUse();
 	viewDestroy(s_pView);
 	fadeDestroy(s_pFade);
-	fontDestroyTextBitMap(s_pTextBitmap);
+	chipArenaClose(CHIP_ARENA_SCOPE_STATE);
 
 	// Destroy slides
 	for(UBYTE i = 0; i < s_ubSlideCount; ++i) {
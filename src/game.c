@@ -15,6 +15,7 @@
 #include <ace/utils/font.h>
 #include <ace/utils/string.h>
 #include <ace/managers/key.h>
+#include <ace/managers/timer.h>
 #include "slipgates.h"
 #include "body_box.h"
 #include "map.h"
@@ -28,6 +29,10 @@
 #include "cutscene.h"
 #include "config.h"
 #include "vfx.h"
+#include "sprite_pool.h"
+#include "chip_arena.h"
+#include "timer_wheel.h"
+#include "job_scheduler.h"
 
 #define GAME_BPP 5
 
@@ -40,8 +45,36 @@
 
 #define SLIPGATE_FRAME_HEIGHT_VERTICAL 16
 #define SLIPGATE_FRAME_HEIGHT_HORIZONTAL 4
+#define GAME_PALETTE_BLOCK_NONE 0xFF
 #define GAME_COLOR_TEXT 25
+#define GAME_STORY_TEXT_LINES_MAX 8
 #define GAME_COLOR_EDITOR_TEXT 16
+// Channel 0 is crosshair, colors of channels 6-7 are not set in game palette
+#define GAME_SPRITE_CHANNEL_FIRST 1
+#define GAME_SPRITE_CHANNEL_COUNT 5
+// Channels aren't attached, so each pair shares 3 colors and frames are
+// converted to nearest of them. Attached pairs would give 15 colors, but only
+// 2 objects side by side instead of 5, making more of them fall back to bobs.
+#define GAME_SPRITE_COLOR_GROUPS ((GAME_SPRITE_CHANNEL_FIRST + GAME_SPRITE_CHANNEL_COUNT + 1) / 2)
+#define GAME_SPRITE_HEIGHT_MAX 16
+#define GAME_SPRITE_BUFFER_HEIGHT (SPRITE_POOL_OBJECTS_MAX * (GAME_SPRITE_HEIGHT_MAX + 1) + 1)
+#define GAME_SPRITE_OFFSET_X 128
+#define GAME_SPRITE_OFFSET_Y 44
+// Player may move by body's velocity clamp after occluder is set, arm sticks
+// out by 1px to the side and 2px above
+#define GAME_SPRITE_PLAYER_MARGIN 8
+#define GAME_SPRITE_PLAYER_ARM_OFFSET_Y 2
+// Display lines which must be left before end of viewport for idle jobs to run
+#define GAME_IDLE_LINES_MIN 96
+
+// Editor overlay is 2bpp, each overlay color maps to a game color
+#define EDITOR_OVERLAY_BPP 2
+#define EDITOR_OVERLAY_COLOR_FRAME 1
+#define EDITOR_OVERLAY_COLOR_BIT_LOW 2
+#define EDITOR_OVERLAY_COLOR_BIT_HIGH 3
+#define GAME_COLOR_EDITOR_FRAME 15
+#define GAME_COLOR_EDITOR_BIT_LOW 1
+#define GAME_COLOR_EDITOR_BIT_HIGH 8
 
 // BUILD SWITCHES
 #define GAME_EDITOR_ENABLED
@@ -54,6 +87,14 @@ typedef enum tExitState {
 	EXIT_MENU,
 } tExitState;
 
+typedef enum tGameSpriteFrame {
+	GAME_SPRITE_FRAME_BOX,
+	GAME_SPRITE_FRAME_BOUNCER,
+	GAME_SPRITE_FRAME_AIM_VERTICAL,
+	GAME_SPRITE_FRAME_AIM_HORIZONTAL,
+	GAME_SPRITE_FRAME_COUNT
+} tGameSpriteFrame;
+
 typedef enum tEditorTileTool {
 	EDITOR_TILE_PALETTE_TOOL_WALL,
 	EDITOR_TILE_PALETTE_TOOL_WALL_BLOCKED,
@@ -131,7 +172,20 @@ static tPlayer s_sPlayer;
 static tBodyBox s_pBoxBodies[MAP_BOXES_MAX];
 static tSprite *s_pSpriteCrosshair;
 static tBob s_sBobAim;
+static tGameSpriteFrame s_eAimSpriteFrame;
+static tSprite *s_pPoolSprites[GAME_SPRITE_CHANNEL_COUNT];
+static tBitMap *s_pPoolSpriteBuffers[2][GAME_SPRITE_CHANNEL_COUNT];
+static UBYTE s_ubPoolSpriteBufferIndex;
+static UWORD s_pPoolSpriteFrames[GAME_SPRITE_COLOR_GROUPS][GAME_SPRITE_FRAME_COUNT][GAME_SPRITE_HEIGHT_MAX][2];
+static UBYTE s_pPoolSpriteFrameHeights[GAME_SPRITE_FRAME_COUNT];
 static tTextBitMap *s_pTextBuffer;
+static tTextBitMap *s_pStoryTextLayer;
+static tTextBitMap *s_pLevelLabelLayer;
+static UBYTE s_isTextLayerValid;
+static tBitMap *s_pBmPristine; // Level as drawn right after load
+static UBYTE s_isPristineValid;
+// Per-column bits of tiles drawn over since pristine was captured or restored
+static ULONG s_pPristineStaleColumns[MAP_TILE_WIDTH];
 
 static UWORD s_uwGameFrame;
 static tExitState s_eExitState;
@@ -140,10 +194,16 @@ static UBYTE s_ubHubLevelTens;
 static UWORD s_uwPrevButtonPresses;
 static UWORD s_pPalettes[PLAYER_MAX_HEALTH + 1][1 << GAME_BPP];
 static UBYTE s_ubCurrentPaletteIndex;
+static tCopBlock *s_pPaletteBlocks[PLAYER_MAX_HEALTH + 1];
+static UBYTE s_ubEnabledPaletteBlock;
 
 static UBYTE s_isEditorEnabled;
 static UBYTE s_isEditorDrawGrid;
 static UBYTE s_isEditorDrawInteractions;
+static UBYTE s_isEditorOverlayVisible;
+static UBYTE s_isEditorOverlayDirty;
+static tBitMap *s_pEditorOverlay;
+static UBYTE s_pEditorOverlayMinterms[GAME_BPP];
 
 static UBYTE s_isDecorEditEnabled;
 static tEditorDecorTool s_eEditorCurrentDecorTool;
@@ -153,6 +213,9 @@ static tUbCoordYX s_sEditorToolSize;
 static tEditorRectangleMode s_eEditorRectangleMode;
 static UBYTE s_ubEditorRectangleKey;
 static tUbCoordYX s_sEditorRectPosStart;
+static UBYTE s_hasEditorChangedTiles;
+static tUbCoordYX s_sEditorChangedTopLeft;
+static tUbCoordYX s_sEditorChangedBottomRight;
 
 static tState s_sStateOptionPalette, s_sStateTextEdit;
 
@@ -178,45 +241,44 @@ static void editorEnterPalette(
 	tCbOptionPaletteDrawElement cbOptionDrawElement
 );
 
-static void drawStoryText(void) {
+static void editorOverlayRebuild(void);
+
+static void textLayerRender(void) {
+	// Story text - rasterized with color 1 on single bitplane
+	tBitMap *pStoryBitMap = s_pStoryTextLayer->pBitMap;
+	blitRect(
+		pStoryBitMap, 0, 0, bitmapGetByteWidth(pStoryBitMap) * 8,
+		pStoryBitMap->Rows, 0
+	);
 	UWORD uwY = 0;
+	UBYTE ubLineCount = 0;
 	char szLine[100];
 	char *pLineEnd = szLine;
 	char *pC = g_sCurrentLevel.szStoryText;
-	while(*pC) {
-		if(*pC == '\n') {
+	while(ubLineCount < GAME_STORY_TEXT_LINES_MAX) {
+		if(*pC == '\n' || (*pC == '\0' && pLineEnd != szLine)) {
 			*pLineEnd = '\0';
 			fontDrawStr(
-				g_pFont, s_pBufferMain->pBack, 320/2, uwY, szLine,
-				GAME_COLOR_TEXT, FONT_COOKIE | FONT_HCENTER, s_pTextBuffer
+				g_pFont, pStoryBitMap, 320/2, uwY, szLine,
+				1, FONT_COOKIE | FONT_HCENTER, s_pTextBuffer
 			);
 			uwY += g_pFont->uwHeight;
+			++ubLineCount;
 			pLineEnd = szLine;
 		}
-		else {
+		else if(*pC != '\0') {
 			*(pLineEnd++) = *pC;
 		}
-		++pC;
-	}
-	if(pLineEnd != szLine) {
-		*pLineEnd = 0;
-		fontDrawStr(
-			g_pFont, s_pBufferMain->pBack, 320/2, uwY, szLine,
-			GAME_COLOR_TEXT, FONT_COOKIE | FONT_HCENTER, s_pTextBuffer
-		);
-	}
-}
 
-// TODO: refactor and move to map.c?
-static void drawMap(void) {
-	for(UBYTE ubTileX = 0; ubTileX < MAP_TILE_WIDTH; ++ubTileX) {
-		for(UBYTE ubTileY = 0; ubTileY < MAP_TILE_HEIGHT; ++ubTileY) {
-			gameDrawTile(ubTileX, ubTileY);
+		if(*pC == '\0') {
+			break;
 		}
+		++pC;
 	}
+	s_pStoryTextLayer->uwActualWidth = 320;
+	s_pStoryTextLayer->uwActualHeight = uwY;
 
-	drawStoryText();
-
+	// Level label
 	char szLevel[11];
 	char *szLabel;
 	if(g_sConfig.ubCurrentLevel == MAP_INDEX_HUB) {
@@ -226,23 +288,76 @@ static void drawMap(void) {
 		sprintf(szLevel, "Level %hhu", g_sConfig.ubCurrentLevel);
 		szLabel = szLevel;
 	}
-	fontDrawStr(
-		g_pFont, s_pBufferMain->pBack, 320/2, 256, szLabel,
-		GAME_COLOR_TEXT, FONT_COOKIE | FONT_HCENTER | FONT_BOTTOM, s_pTextBuffer
-	);
+	fontFillTextBitMap(g_pFont, s_pLevelLabelLayer, szLabel);
+
+	s_isTextLayerValid = 1;
+}
+
+static void drawStoryText(void) {
+	if(!s_isTextLayerValid) {
+		textLayerRender();
+	}
+	if(s_pStoryTextLayer->uwActualHeight) {
+		fontDrawTextBitMap(
+			s_pBufferMain->pBack, s_pStoryTextLayer, 0, 0,
+			GAME_COLOR_TEXT, FONT_COOKIE
+		);
+	}
+}
 
+static void copyScreen(const tBitMap *pSrc, tBitMap *pDst) {
+	// Split in halves - whole interleaved screen exceeds max blit height
 	blitCopyAligned(
-		s_pBufferMain->pBack, 0, 0,
-		s_pBufferMain->pFront, 0, 0,
+		pSrc, 0, 0, pDst, 0, 0,
 		SCREEN_PAL_WIDTH, SCREEN_PAL_HEIGHT / 2
 	);
 	blitCopyAligned(
-		s_pBufferMain->pBack, 0, SCREEN_PAL_HEIGHT / 2,
-		s_pBufferMain->pFront, 0, SCREEN_PAL_HEIGHT / 2,
+		pSrc, 0, SCREEN_PAL_HEIGHT / 2, pDst, 0, SCREEN_PAL_HEIGHT / 2,
 		SCREEN_PAL_WIDTH, SCREEN_PAL_HEIGHT / 2
 	);
 }
 
+// TODO: refactor and move to map.c?
+static void drawMap(void) {
+	for(UBYTE ubTileX = 0; ubTileX < MAP_TILE_WIDTH; ++ubTileX) {
+		for(UBYTE ubTileY = 0; ubTileY < MAP_TILE_HEIGHT; ++ubTileY) {
+			gameDrawTile(ubTileX, ubTileY);
+		}
+	}
+
+	drawStoryText();
+	fontDrawTextBitMap(
+		s_pBufferMain->pBack, s_pLevelLabelLayer, 320/2, 256,
+		GAME_COLOR_TEXT, FONT_COOKIE | FONT_HCENTER | FONT_BOTTOM
+	);
+
+	copyScreen(s_pBufferMain->pBack, s_pBufferMain->pFront);
+}
+
+static void pristineClearStale(void) {
+	for(UBYTE ubTileX = 0; ubTileX < MAP_TILE_WIDTH; ++ubTileX) {
+		s_pPristineStaleColumns[ubTileX] = 0;
+	}
+}
+
+static void drawMapFromPristine(void) {
+	copyScreen(s_pBmPristine, s_pBufferMain->pBack);
+	copyScreen(s_pBmPristine, s_pBufferMain->pFront);
+	pristineClearStale();
+}
+
+static void pristineMarkStale(UWORD uwX, UWORD uwY, UWORD uwWidth, UWORD uwHeight) {
+	UBYTE ubRightX = MIN((uwX + uwWidth - 1) >> MAP_TILE_SHIFT, MAP_TILE_WIDTH - 1);
+	UBYTE ubBottomY = MIN((uwY + uwHeight - 1) >> MAP_TILE_SHIFT, MAP_TILE_HEIGHT - 1);
+	ULONG ulColumnMask = 0;
+	for(UBYTE ubTileY = uwY >> MAP_TILE_SHIFT; ubTileY <= ubBottomY; ++ubTileY) {
+		ulColumnMask |= 1UL << ubTileY;
+	}
+	for(UBYTE ubTileX = uwX >> MAP_TILE_SHIFT; ubTileX <= ubRightX; ++ubTileX) {
+		s_pPristineStaleColumns[ubTileX] |= ulColumnMask;
+	}
+}
+
 static void gameRequestInteractionTilesDraw(const tInteraction *pInteraction) {
 	for(UBYTE i = 0; i < pInteraction->ubTargetCount; ++i) {
 		mapRequestTileDraw(
@@ -273,11 +388,16 @@ static UBYTE boxCollisionHandler(
 static void loadLevel(UBYTE ubIndex, UBYTE isForce) {
 	viewLoad(0);
 	s_uwGameFrame = 0;
+	timerWheelReset();
+	vfxReset();
 	s_eExitState = EXIT_NONE;
-	if(ubIndex == g_sConfig.ubCurrentLevel && !isForce) {
+	UBYTE isRestart = (ubIndex == g_sConfig.ubCurrentLevel && !isForce);
+	s_isTextLayerValid = 0;
+	if(isRestart) {
 		mapRestart();
 	}
 	else {
+		s_isPristineValid = 0;
 		g_sConfig.ubCurrentLevel = ubIndex;
 
 		if(ubIndex != MAP_INDEX_HUB) {
@@ -289,6 +409,11 @@ static void loadLevel(UBYTE ubIndex, UBYTE isForce) {
 			mapTryLoad(MAP_INDEX_DEVELOP);
 		}
 	}
+	if(MAP_INDEX_FIRST <= ubIndex && ubIndex < MAP_INDEX_LAST) {
+		// Read next level in spare frame time so that transition doesn't wait
+		// for disk. Called after map's job registration in mapRestart().
+		mapPrefetchLevel(ubIndex + 1);
+	}
 	bobDiscardUndraw();
 	playerReset(&s_sPlayer, g_sCurrentLevel.sSpawnPos.fX, g_sCurrentLevel.sSpawnPos.fY);
 	for(UBYTE i = 0; i < MAP_BOXES_MAX; ++i) {
@@ -309,7 +434,23 @@ static void loadLevel(UBYTE ubIndex, UBYTE isForce) {
 	s_bHubActiveDoors = 0;
 	s_uwPrevButtonPresses = 0;
 
-	drawMap();
+	if(s_isEditorOverlayVisible) {
+		editorOverlayRebuild();
+	}
+
+	// Restarted level is identical to loaded one, so its pristine render can be
+	// reused. Everything changing afterwards goes through regular dirty tiles.
+	if(isRestart && s_isPristineValid && !s_isEditorOverlayVisible) {
+		drawMapFromPristine();
+	}
+	else {
+		drawMap();
+		if(!s_isEditorOverlayVisible) {
+			copyScreen(s_pBufferMain->pBack, s_pBmPristine);
+			s_isPristineValid = 1;
+			pristineClearStale();
+		}
+	}
 
 	s_ubCurrentPaletteIndex = PLAYER_MAX_HEALTH;
 
@@ -364,6 +505,132 @@ static void hubProcess(void) {
 	}
 }
 
+static void editorOverlayDrawMask(UBYTE ubTileX, UBYTE ubTileY, UWORD uwMask) {
+	UBYTE ubBitIndex = 0;
+	blitRect(
+		s_pEditorOverlay, ubTileX * MAP_TILE_SIZE + 1, ubTileY * MAP_TILE_SIZE + 1,
+		6, 6, EDITOR_OVERLAY_COLOR_FRAME
+	);
+	while(uwMask) {
+		if(uwMask & 1) {
+			UBYTE ubColor = (ubBitIndex >= 9) ? EDITOR_OVERLAY_COLOR_BIT_HIGH : EDITOR_OVERLAY_COLOR_BIT_LOW;
+			UBYTE ubIndicatorX = 1 + (ubBitIndex % 3) * 2;
+			UBYTE ubIndicatorY = 1 + ((ubBitIndex % 9) / 3) * 2;
+			blitRect(
+				s_pEditorOverlay,
+				ubTileX * MAP_TILE_SIZE + ubIndicatorX,
+				ubTileY * MAP_TILE_SIZE + ubIndicatorY,
+				1, 1, ubColor
+			);
+		}
+
+		++ubBitIndex;
+		uwMask >>= 1;
+	}
+}
+
+static void editorOverlayRebuild(void) {
+	blitRect(s_pEditorOverlay, 0, 0, SCREEN_PAL_WIDTH, SCREEN_PAL_HEIGHT, 0);
+
+	if(s_isEditorDrawGrid) {
+		for(UBYTE ubTileX = 0; ubTileX < MAP_TILE_WIDTH; ++ubTileX) {
+			blitLine(
+				s_pEditorOverlay, ubTileX * MAP_TILE_SIZE, 0,
+				ubTileX * MAP_TILE_SIZE, SCREEN_PAL_HEIGHT - 1,
+				EDITOR_OVERLAY_COLOR_FRAME, 0xAAAA, 0
+			);
+		}
+		for(UBYTE ubTileY = 0; ubTileY < MAP_TILE_HEIGHT; ++ubTileY) {
+			blitLine(
+				s_pEditorOverlay, 0, ubTileY * MAP_TILE_SIZE,
+				SCREEN_PAL_WIDTH - 1, ubTileY * MAP_TILE_SIZE,
+				EDITOR_OVERLAY_COLOR_FRAME, 0xAAAA, 0
+			);
+		}
+	}
+
+	if(s_isEditorDrawInteractions) {
+		// Backwards so that first interaction containing tile is drawn on top
+		for(BYTE i = MAP_INTERACTIONS_MAX - 1; i >= 0; --i) {
+			const tInteraction *pInteraction = mapGetInteractionByIndex(i);
+			for(UBYTE ubTarget = 0; ubTarget < pInteraction->ubTargetCount; ++ubTarget) {
+				tUbCoordYX sPos = pInteraction->pTargetTiles[ubTarget].sPos;
+				editorOverlayDrawMask(sPos.ubX, sPos.ubY, pInteraction->uwButtonMask);
+			}
+		}
+
+		for(UBYTE ubTileX = 0; ubTileX < MAP_TILE_WIDTH; ++ubTileX) {
+			for(UBYTE ubTileY = 0; ubTileY < MAP_TILE_HEIGHT; ++ubTileY) {
+				tTile eTile = mapGetTileAt(ubTileX, ubTileY);
+				if(mapTileIsButton(eTile)) {
+					UBYTE ubButtonIndex = (eTile & MAP_TILE_INDEX_MASK) - (TILE_BUTTON_A & MAP_TILE_INDEX_MASK);
+					editorOverlayDrawMask(ubTileX, ubTileY, BV(ubButtonIndex));
+				}
+				else if(eTile == TILE_RECEIVER) {
+					editorOverlayDrawMask(ubTileX, ubTileY, BV(MAP_BOUNCER_BUTTON_INDEX));
+				}
+			}
+		}
+	}
+
+	s_isEditorOverlayDirty = 0;
+}
+
+static void editorOverlayCalculateMinterms(void) {
+	// A: overlay plane 0, B: overlay plane 1, C/D: game plane
+	static const UBYTE ubA = 0xF0, ubB = 0xCC, ubC = 0xAA;
+	for(UBYTE ubPlane = 0; ubPlane < GAME_BPP; ++ubPlane) {
+		UBYTE ubMinterm = ~ubA & ~ubB & ubC; // no overlay - keep background
+		if(GAME_COLOR_EDITOR_FRAME & BV(ubPlane)) {
+			ubMinterm |= ubA & ~ubB;
+		}
+		if(GAME_COLOR_EDITOR_BIT_LOW & BV(ubPlane)) {
+			ubMinterm |= ~ubA & ubB;
+		}
+		if(GAME_COLOR_EDITOR_BIT_HIGH & BV(ubPlane)) {
+			ubMinterm |= ubA & ubB;
+		}
+		s_pEditorOverlayMinterms[ubPlane] = ubMinterm;
+	}
+}
+
+static void editorOverlayBlit(
+	UBYTE ubTileX, UBYTE ubTileY, UWORD uwBlitWords, UWORD uwHeight
+) {
+	ULONG ulSrcOffs = ubTileY * MAP_TILE_SIZE * BUFFER_BYTE_WIDTH + ((ubTileX * MAP_TILE_SIZE) >> 3);
+	ULONG ulDstOffs = ubTileY * MAP_TILE_SIZE * BUFFER_BYTE_WIDTH * GAME_BPP + ((ubTileX * MAP_TILE_SIZE) >> 3);
+	WORD wSrcModulo = BUFFER_BYTE_WIDTH - (uwBlitWords << 1);
+	WORD wDstModulo = BUFFER_BYTE_WIDTH * GAME_BPP - (uwBlitWords << 1);
+
+	// Whole words are blitted, neighbor tile gets same overlay pixels again
+	blitWait();
+	g_pCustom->bltcon1 = 0;
+	g_pCustom->bltafwm = 0xFFFF;
+	g_pCustom->bltalwm = 0xFFFF;
+	g_pCustom->bltamod = wSrcModulo;
+	g_pCustom->bltbmod = wSrcModulo;
+	g_pCustom->bltcmod = wDstModulo;
+	g_pCustom->bltdmod = wDstModulo;
+	for(UBYTE ubPlane = 0; ubPlane < GAME_BPP; ++ubPlane) {
+		UBYTE *pDst = (UBYTE*)((ULONG)s_pBufferMain->pBack->Planes[0] + ulDstOffs + ubPlane * BUFFER_BYTE_WIDTH);
+		blitWait();
+		g_pCustom->bltcon0 = USEA|USEB|USEC|USED | s_pEditorOverlayMinterms[ubPlane];
+		g_pCustom->bltapt = (UBYTE*)((ULONG)s_pEditorOverlay->Planes[0] + ulSrcOffs);
+		g_pCustom->bltbpt = (UBYTE*)((ULONG)s_pEditorOverlay->Planes[1] + ulSrcOffs);
+		g_pCustom->bltcpt = pDst;
+		g_pCustom->bltdpt = pDst;
+		g_pCustom->bltsize = (uwHeight << HSIZEBITS) | uwBlitWords;
+	}
+}
+
+static void editorOverlayCompositeAll(void) {
+	editorOverlayBlit(0, 0, BUFFER_BYTE_WIDTH / 2, SCREEN_PAL_HEIGHT);
+	copyScreen(s_pBufferMain->pBack, s_pBufferMain->pFront);
+	// Bob backgrounds were saved without overlay, undrawing them would erase it
+	bobDiscardUndraw();
+	bobSetCurrentBuffer(s_pBufferMain->pBack);
+}
+
 static void gameTileRefreshAll(void) {
 	for(UBYTE ubTileX = 0; ubTileX < MAP_TILE_WIDTH; ++ubTileX) {
 		for(UBYTE ubTileY = 0; ubTileY < MAP_TILE_HEIGHT; ++ubTileY) {
@@ -374,9 +641,48 @@ static void gameTileRefreshAll(void) {
 	bobSetCurrentBuffer(s_pBufferMain->pBack);
 }
 
+static void gameTileRefreshFromPristine(void) {
+	// Only tiles drawn over since load differ from pristine copy, so there's
+	// no need to blit all of them again.
+	drawMapFromPristine();
+	for(UBYTE ubTileX = 0; ubTileX < MAP_TILE_WIDTH; ++ubTileX) {
+		ULONG ulStale = s_pPristineStaleColumns[ubTileX];
+		for(UBYTE ubTileY = 0; ulStale; ++ubTileY, ulStale >>= 1) {
+			if(ulStale & 1) {
+				mapRequestTileDraw(ubTileX, ubTileY);
+			}
+		}
+	}
+	if(s_isEditorOverlayVisible) {
+		editorOverlayCompositeAll();
+	}
+	else {
+		bobDiscardUndraw();
+		bobSetCurrentBuffer(s_pBufferMain->pBack);
+	}
+}
+
 static void gameToggleEditorOption(UBYTE *pOption) {
 	*pOption = !*pOption;
-	gameTileRefreshAll();
+	s_isEditorOverlayVisible = s_isEditorEnabled && (
+		s_isEditorDrawGrid || s_isEditorDrawInteractions
+	);
+	if(s_isEditorOverlayVisible) {
+		editorOverlayRebuild();
+	}
+
+	if(!*pOption) {
+		// Something got hidden - tiles need to be redrawn without it
+		if(s_isPristineValid) {
+			gameTileRefreshFromPristine();
+		}
+		else {
+			gameTileRefreshAll();
+		}
+	}
+	else if(s_isEditorOverlayVisible) {
+		editorOverlayCompositeAll();
+	}
 }
 
 static void onTilePaletteSelected(UBYTE ubToolIndex) {
@@ -558,6 +864,151 @@ static void paletteInterpolate(
 	}
 }
 
+static void gameEnablePaletteBlock(UBYTE ubIndex) {
+	if(ubIndex == s_ubEnabledPaletteBlock) {
+		return;
+	}
+
+	if(s_ubEnabledPaletteBlock != GAME_PALETTE_BLOCK_NONE) {
+		copBlockDisable(s_pView->pCopList, s_pPaletteBlocks[s_ubEnabledPaletteBlock]);
+	}
+	if(ubIndex != GAME_PALETTE_BLOCK_NONE) {
+		copBlockEnable(s_pView->pCopList, s_pPaletteBlocks[ubIndex]);
+	}
+	s_ubEnabledPaletteBlock = ubIndex;
+}
+
+static UBYTE spriteGetNearestColor(UWORD uwColor, const UWORD *pSpriteColors) {
+	UBYTE ubBestIndex = 1;
+	UWORD uwBestDist = 0xFFFF;
+	for(UBYTE i = 1; i < 4; ++i) {
+		BYTE bDR = ((uwColor >> 8) & 0xF) - ((pSpriteColors[i] >> 8) & 0xF);
+		BYTE bDG = ((uwColor >> 4) & 0xF) - ((pSpriteColors[i] >> 4) & 0xF);
+		BYTE bDB = ((uwColor >> 0) & 0xF) - ((pSpriteColors[i] >> 0) & 0xF);
+		UWORD uwDist = bDR * bDR + bDG * bDG + bDB * bDB;
+		if(uwDist < uwBestDist) {
+			uwBestDist = uwDist;
+			ubBestIndex = i;
+		}
+	}
+	return ubBestIndex;
+}
+
+static void gameSpriteConvertFrame(
+	tGameSpriteFrame eFrame, const tBitMap *pFrames, const tBitMap *pMasks,
+	UWORD uwOffsetY, UBYTE ubHeight
+) {
+	s_pPoolSpriteFrameHeights[eFrame] = ubHeight;
+	const UWORD *pPalette = s_pPalettes[PLAYER_MAX_HEALTH];
+	for(UBYTE ubGroup = 0; ubGroup < GAME_SPRITE_COLOR_GROUPS; ++ubGroup) {
+		// Channel pairs share 3 colors, starting from color 17
+		const UWORD *pSpriteColors = &pPalette[16 + 4 * ubGroup];
+		for(UBYTE y = 0; y < ubHeight; ++y) {
+			ULONG ulRowOffset = (uwOffsetY + y) * pFrames->BytesPerRow;
+			UWORD uwMask = *(UWORD*)&pMasks->Planes[0][(uwOffsetY + y) * pMasks->BytesPerRow];
+			UWORD uwPlaneA = 0, uwPlaneB = 0;
+			for(UBYTE x = 0; x < 16; ++x) {
+				UWORD uwBit = BV(15 - x);
+				if(!(uwMask & uwBit)) {
+					continue;
+				}
+				UBYTE ubColor = 0;
+				for(UBYTE ubPlane = 0; ubPlane < GAME_BPP; ++ubPlane) {
+					if(*(UWORD*)&pFrames->Planes[ubPlane][ulRowOffset] & uwBit) {
+						ubColor |= BV(ubPlane);
+					}
+				}
+				UBYTE ubSpriteColor = spriteGetNearestColor(pPalette[ubColor], pSpriteColors);
+				if(ubSpriteColor & 1) {
+					uwPlaneA |= uwBit;
+				}
+				if(ubSpriteColor & 2) {
+					uwPlaneB |= uwBit;
+				}
+			}
+			s_pPoolSpriteFrames[ubGroup][eFrame][y][0] = uwPlaneA;
+			s_pPoolSpriteFrames[ubGroup][eFrame][y][1] = uwPlaneB;
+		}
+	}
+}
+
+static void gameSpritesCreate(void) {
+	gameSpriteConvertFrame(GAME_SPRITE_FRAME_BOX, g_pBoxFrames, g_pBoxMasks, 0, 8);
+	gameSpriteConvertFrame(GAME_SPRITE_FRAME_BOUNCER, g_pBouncerFrames, g_pBouncerMasks, 0, 8);
+	gameSpriteConvertFrame(
+		GAME_SPRITE_FRAME_AIM_VERTICAL, g_pAim, g_pAimMasks, 0,
+		GAME_SPRITE_HEIGHT_MAX
+	);
+	gameSpriteConvertFrame(
+		GAME_SPRITE_FRAME_AIM_HORIZONTAL, g_pAim, g_pAimMasks,
+		SLIPGATE_FRAME_HEIGHT_VERTICAL, GAME_SPRITE_HEIGHT_MAX
+	);
+
+	// Control words are written by gameSpritesUpdate(), so spriteProcess()
+	// must not be called on those channels.
+	for(UBYTE i = 0; i < GAME_SPRITE_CHANNEL_COUNT; ++i) {
+		for(UBYTE ubBuffer = 0; ubBuffer < 2; ++ubBuffer) {
+			s_pPoolSpriteBuffers[ubBuffer][i] = chipArenaBitmapCreate(
+				CHIP_ARENA_SCOPE_STATE, 16, GAME_SPRITE_BUFFER_HEIGHT, 2,
+				BMF_CLEAR | BMF_INTERLEAVED
+			);
+		}
+		s_pPoolSprites[i] = spriteAdd(
+			GAME_SPRITE_CHANNEL_FIRST + i, s_pPoolSpriteBuffers[0][i]
+		);
+		spriteProcessChannel(GAME_SPRITE_CHANNEL_FIRST + i);
+	}
+	s_ubPoolSpriteBufferIndex = 0;
+	spritePoolInit(GAME_SPRITE_CHANNEL_FIRST, GAME_SPRITE_CHANNEL_COUNT);
+}
+
+static void gameSpritesUpdate(void) {
+	UBYTE ubBufferIndex = !s_ubPoolSpriteBufferIndex;
+	UWORD *pChannelEnds[GAME_SPRITE_CHANNEL_COUNT];
+	for(UBYTE i = 0; i < GAME_SPRITE_CHANNEL_COUNT; ++i) {
+		pChannelEnds[i] = (UWORD*)s_pPoolSpriteBuffers[ubBufferIndex][i]->Planes[0];
+	}
+
+	// Objects are sorted by Y, so each channel gets them chained in order
+	UBYTE ubCount = spritePoolGetCount();
+	for(UBYTE i = 0; i < ubCount; ++i) {
+		const tSpritePoolEntry *pEntry = spritePoolGetSorted(i);
+		if(pEntry->ubChannel == SPRITE_POOL_CHANNEL_NONE) {
+			continue;
+		}
+		UWORD *pDst = pChannelEnds[pEntry->ubChannel - GAME_SPRITE_CHANNEL_FIRST];
+		UWORD uwVStart = pEntry->wY + GAME_SPRITE_OFFSET_Y;
+		UWORD uwVStop = uwVStart + pEntry->ubHeight;
+		UWORD uwHStart = pEntry->wX + GAME_SPRITE_OFFSET_X;
+		*(pDst++) = ((uwVStart & 0xFF) << 8) | ((uwHStart >> 1) & 0xFF);
+		*(pDst++) = (
+			((uwVStop & 0xFF) << 8) | (((uwVStart >> 8) & 1) << 2) |
+			(((uwVStop >> 8) & 1) << 1) | (uwHStart & 1)
+		);
+
+		UWORD (*pRows)[2] = s_pPoolSpriteFrames[pEntry->ubChannel / 2][pEntry->ubFrame];
+		for(UBYTE y = 0; y < pEntry->ubHeight; ++y) {
+			*(pDst++) = pRows[y][0];
+			*(pDst++) = pRows[y][1];
+		}
+		pChannelEnds[pEntry->ubChannel - GAME_SPRITE_CHANNEL_FIRST] = pDst;
+	}
+
+	for(UBYTE i = 0; i < GAME_SPRITE_CHANNEL_COUNT; ++i) {
+		pChannelEnds[i][0] = 0;
+		pChannelEnds[i][1] = 0;
+		spriteSetBitmap(s_pPoolSprites[i], s_pPoolSpriteBuffers[ubBufferIndex][i]);
+		spriteProcessChannel(GAME_SPRITE_CHANNEL_FIRST + i);
+	}
+	s_ubPoolSpriteBufferIndex = ubBufferIndex;
+}
+
+static void gameSpriteOrBobPush(UBYTE ubHandle, tBob *pBob) {
+	if(spritePoolGetChannel(ubHandle) == SPRITE_POOL_CHANNEL_NONE) {
+		bobPush(pBob);
+	}
+}
+
 void gameProcessExit(void) {
 	if(s_eExitState != EXIT_NONE) {
 		if(s_eExitState == EXIT_NEXT) {
@@ -628,50 +1079,83 @@ static UBYTE gameEditorTryPlaceDecor(UWORD uwCursorTileX, UWORD uwCursorTileY) {
 	return 1;
 }
 
+static void gameEditorMarkTileChanged(UBYTE ubTileX, UBYTE ubTileY) {
+	if(!s_hasEditorChangedTiles) {
+		s_sEditorChangedTopLeft = (tUbCoordYX){.ubX = ubTileX, .ubY = ubTileY};
+		s_sEditorChangedBottomRight = s_sEditorChangedTopLeft;
+		s_hasEditorChangedTiles = 1;
+		return;
+	}
+	s_sEditorChangedTopLeft.ubX = MIN(s_sEditorChangedTopLeft.ubX, ubTileX);
+	s_sEditorChangedTopLeft.ubY = MIN(s_sEditorChangedTopLeft.ubY, ubTileY);
+	s_sEditorChangedBottomRight.ubX = MAX(s_sEditorChangedBottomRight.ubX, ubTileX);
+	s_sEditorChangedBottomRight.ubY = MAX(s_sEditorChangedBottomRight.ubY, ubTileY);
+}
+
+static void gameEditorRecalculateChangedTiles(void) {
+	if(!s_hasEditorChangedTiles) {
+		return;
+	}
+	mapRecalculateVisTilesInRect(
+		s_sEditorChangedTopLeft.ubX, s_sEditorChangedTopLeft.ubY,
+		s_sEditorChangedBottomRight.ubX, s_sEditorChangedBottomRight.ubY
+	);
+	if(s_isEditorOverlayVisible) {
+		// Overlay depends on logic tiles, which may change without vis tile change
+		for(UBYTE ubX = s_sEditorChangedTopLeft.ubX; ubX <= s_sEditorChangedBottomRight.ubX; ++ubX) {
+			for(UBYTE ubY = s_sEditorChangedTopLeft.ubY; ubY <= s_sEditorChangedBottomRight.ubY; ++ubY) {
+				mapRequestTileDraw(ubX, ubY);
+			}
+		}
+	}
+	s_hasEditorChangedTiles = 0;
+}
+
 static void gameEditorPlaceTile(
 	tTile *pTileUnderCursor, UWORD uwCursorTileX, UWORD uwCursorTileY
 ) {
+	s_isEditorOverlayDirty = 1;
 	switch (s_eEditorCurrentTool)
 	{
 	case EDITOR_TILE_PALETTE_TOOL_WALL:
 		*pTileUnderCursor = TILE_WALL;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_WALL_BLOCKED:
 		*pTileUnderCursor = TILE_WALL_BLOCKED;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_GRATE:
 		*pTileUnderCursor = TILE_GRATE;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_DEATH_FIELD:
 		*pTileUnderCursor = TILE_DEATH_FIELD;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_EXIT:
 		*pTileUnderCursor = TILE_EXIT;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_DOOR:
 		*pTileUnderCursor = TILE_DOOR_CLOSED;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_RECEIVER:
 		*pTileUnderCursor = TILE_RECEIVER;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_WALL_TOGGLABLE:
 		*pTileUnderCursor = TILE_WALL_TOGGLABLE_OFF;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_PIPE:
 		*pTileUnderCursor = TILE_PIPE;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_EXIT_HUB:
 		*pTileUnderCursor = TILE_EXIT_HUB;
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 
 	case EDITOR_TILE_PALETTE_TOOL_BUTTON:
@@ -687,14 +1171,14 @@ static void gameEditorPlaceTile(
 				{
 					++*pTileUnderCursor;
 				}
-				mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+				gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 			}
 		}
 		else
 		{
 			keyUse(KEY_Z); // prevent double-processing of same tile
 			*pTileUnderCursor = TILE_BUTTON_A;
-			mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+			gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		}
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_BOUNCER:
@@ -712,20 +1196,20 @@ static void gameEditorPlaceTile(
 		bouncerInit(
 				g_sCurrentLevel.ubBouncerSpawnerTileX,
 				g_sCurrentLevel.ubBouncerSpawnerTileY);
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_SPIKE:
 		mapAddOrRemoveSpikeTile(uwCursorTileX, uwCursorTileY);
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY - 1);
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY - 1);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_TURRET_LEFT:
 		mapAddOrRemoveTurret(uwCursorTileX, uwCursorTileY);
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	case EDITOR_TILE_PALETTE_TOOL_TURRET_RIGHT:
 		mapAddOrRemoveTurret(uwCursorTileX, uwCursorTileY);
-		mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+		gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
 		break;
 	default:
 		break;
@@ -752,7 +1236,11 @@ static UBYTE gameEditorProcess(void) {
 		return 1;
 	}
 	if(keyUse(KEY_N)) {
+		ULONG ulStart = timerGetPrec();
 		mapRecalcAllVisTilesOnLevel(&g_sCurrentLevel);
+		char szDuration[15];
+		timerFormatPrec(szDuration, timerGetDelta(ulStart, timerGetPrec()));
+		logWrite("Vis tiles recalculated in %s\n", szDuration);
 		drawMap();
 		return 1;
 	}
@@ -784,18 +1272,18 @@ static UBYTE gameEditorProcess(void) {
 						gameEditorPlaceTile(&g_sCurrentLevel.pTiles[ubX][ubY], ubX, ubY);
 					}
 				}
+				gameEditorRecalculateChangedTiles();
 			}
 			else if(s_eEditorRectangleMode == EDITOR_RECTANGLE_MODE_CLEAR_TILE) {
+				s_isEditorOverlayDirty = 1;
 				for(UBYTE ubY = sPosTopLeft.ubY; ubY <= sPosBottomRight.ubY; ++ubY) {
 					for(UBYTE ubX = sPosTopLeft.ubX; ubX <= sPosBottomRight.ubX; ++ubX) {
 						g_sCurrentLevel.pTiles[ubX][ubY] = TILE_BG;
 					}
 				}
-				for(UBYTE ubY = sPosTopLeft.ubY; ubY <= sPosBottomRight.ubY; ++ubY) {
-					for(UBYTE ubX = sPosTopLeft.ubX; ubX <= sPosBottomRight.ubX; ++ubX) {
-						mapRecalculateVisTilesNearTileAt(ubX, ubY);
-					}
-				}
+				gameEditorMarkTileChanged(sPosTopLeft.ubX, sPosTopLeft.ubY);
+				gameEditorMarkTileChanged(sPosBottomRight.ubX, sPosBottomRight.ubY);
+				gameEditorRecalculateChangedTiles();
 			}
 			s_sEditorToolSize.ubX = 1;
 			s_sEditorToolSize.ubY = 1;
@@ -815,6 +1303,7 @@ static UBYTE gameEditorProcess(void) {
 			}
 			else {
 				gameEditorPlaceTile(pTileUnderCursor, uwCursorTileX, uwCursorTileY);
+				gameEditorRecalculateChangedTiles();
 			}
 		}
 	}
@@ -826,7 +1315,9 @@ static UBYTE gameEditorProcess(void) {
 		}
 		else {
 			*pTileUnderCursor = TILE_BG;
-			mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+			gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
+			gameEditorRecalculateChangedTiles();
+			s_isEditorOverlayDirty = 1;
 		}
 	}
 
@@ -903,11 +1394,19 @@ static UBYTE gameEditorProcess(void) {
 			}
 
 			// Could be no longer part of interaction
-			mapRecalculateVisTilesNearTileAt(uwCursorTileX, uwCursorTileY);
+			gameEditorMarkTileChanged(uwCursorTileX, uwCursorTileY);
+			gameEditorRecalculateChangedTiles();
+			mapRebuildInteractionIndex();
+			s_isEditorOverlayDirty = 1;
 			break;
 		}
 	}
 
+	// Changed overlay will be used by tile redraws requested by edits
+	if(s_isEditorOverlayDirty && s_isEditorOverlayVisible) {
+		editorOverlayRebuild();
+	}
+
 	// Debug stuff
 	if(keyUse(KEY_T)) {
 		bodyTeleport(&s_sPlayer.sBody, sPosCross.uwX, sPosCross.uwY);
@@ -922,31 +1421,13 @@ static UBYTE gameEditorProcess(void) {
 			--g_sCurrentLevel.ubBoxCount;
 		}
 	}
+	if(keyUse(KEY_J)) {
+		jobSchedulerLogStats();
+	}
 
 	return 0;
 }
 
-static void gameDrawTileInteractionMask(UBYTE ubTileX, UBYTE ubTileY, UWORD uwMask) {
-	UBYTE ubBitIndex = 0;
-	blitRect(s_pBufferMain->pBack, ubTileX * MAP_TILE_SIZE + 1, ubTileY * MAP_TILE_SIZE + 1, 6, 6, 15);
-	while(uwMask) {
-		if(uwMask & 1) {
-			UBYTE ubColor = (ubBitIndex >= 9) ? 8 : 1;
-			UBYTE ubIndicatorX = 1 + (ubBitIndex % 3) * 2;
-			UBYTE ubIndicatorY = 1 + ((ubBitIndex % 9) / 3) * 2;
-			blitRect(
-				s_pBufferMain->pBack,
-				ubTileX * MAP_TILE_SIZE + ubIndicatorX,
-				ubTileY * MAP_TILE_SIZE + ubIndicatorY,
-				1, 1, ubColor
-			);
-		}
-
-		++ubBitIndex;
-		uwMask >>= 1;
-	}
-}
-
 //-------------------------------------------------------------------- GAMESTATE
 
 static void gameGsCreate(void) {
@@ -981,8 +1462,49 @@ static void gameGsCreate(void) {
 
 	s_pFade = fadeCreate(s_pView, s_pPalettes[PLAYER_MAX_HEALTH], 1 << GAME_BPP);
 
-	assetsGameCreate();
-	s_pTextBuffer = fontCreateTextBitMap(320 + 16, g_pFont->uwHeight);
+	// Health palettes are loaded by copper during vblank, only one is enabled
+	for(UBYTE i = 0; i <= PLAYER_MAX_HEALTH; ++i) {
+		s_pPaletteBlocks[i] = copBlockCreate(s_pView->pCopList, 1 << GAME_BPP, 0, 0);
+		for(UBYTE ubColor = 0; ubColor < (1 << GAME_BPP); ++ubColor) {
+			copMove(
+				s_pView->pCopList, s_pPaletteBlocks[i],
+				&g_pCustom->color[ubColor], s_pPalettes[i][ubColor]
+			);
+		}
+		copBlockDisable(s_pView->pCopList, s_pPaletteBlocks[i]);
+	}
+	s_ubEnabledPaletteBlock = GAME_PALETTE_BLOCK_NONE;
+
+	// Sum of all chip allocations of game state done by chipArena*Create(),
+	// checked with chipArenaCheckUsed() once they're all made
+	if(!chipArenaOpen(CHIP_ARENA_SCOPE_STATE,
+		2 * chipArenaGetTextBitMapSize(320 + 16, g_pFont->uwHeight) +
+		chipArenaGetTextBitMapSize(320, g_pFont->uwHeight * GAME_STORY_TEXT_LINES_MAX) +
+		chipArenaGetBitmapSize(SCREEN_PAL_WIDTH, SCREEN_PAL_HEIGHT, GAME_BPP) +
+		chipArenaGetBitmapSize(SCREEN_PAL_WIDTH, SCREEN_PAL_HEIGHT, EDITOR_OVERLAY_BPP) +
+		2 * GAME_SPRITE_CHANNEL_COUNT * chipArenaGetBitmapSize(16, GAME_SPRITE_BUFFER_HEIGHT, 2)
+	)) {
+		systemKill("No chip mem for game");
+	}
+	if(!assetsGameCreate()) {
+		systemKill("Can't load game assets");
+	}
+	mapOpenLevelPack();
+	s_pTextBuffer = chipArenaTextBitMapCreate(
+		CHIP_ARENA_SCOPE_STATE, 320 + 16, g_pFont->uwHeight
+	);
+	s_pStoryTextLayer = chipArenaTextBitMapCreate(
+		CHIP_ARENA_SCOPE_STATE, 320, g_pFont->uwHeight * GAME_STORY_TEXT_LINES_MAX
+	);
+	s_pLevelLabelLayer = chipArenaTextBitMapCreate(
+		CHIP_ARENA_SCOPE_STATE, 320 + 16, g_pFont->uwHeight
+	);
+	s_isTextLayerValid = 0;
+	s_pBmPristine = chipArenaBitmapCreate(
+		CHIP_ARENA_SCOPE_STATE, SCREEN_PAL_WIDTH, SCREEN_PAL_HEIGHT, GAME_BPP,
+		BMF_INTERLEAVED
+	);
+	s_isPristineValid = 0;
 	playerManagerInit();
 
 	bobManagerCreate(s_pBufferMain->pFront, s_pBufferMain->pBack, s_pBufferMain->uBfrBounds.uwY);
@@ -1011,22 +1533,40 @@ static void gameGsCreate(void) {
 	s_pSpriteCrosshair = spriteAdd(0, g_pBmCursor);
 	systemSetDmaBit(DMAB_SPRITE, 1);
 	spriteProcessChannel(0);
+	gameSpritesCreate();
 	mouseSetBounds(MOUSE_PORT_1, 0, 0, SCREEN_PAL_WIDTH - 17, SCREEN_PAL_HEIGHT - 27);
 
 	s_isEditorEnabled = 0;
 	s_isEditorDrawGrid = 0;
 	s_isEditorDrawInteractions = 0;
+	s_isEditorOverlayVisible = 0;
+	s_isEditorOverlayDirty = 0;
+	s_pEditorOverlay = chipArenaBitmapCreate(
+		CHIP_ARENA_SCOPE_STATE, SCREEN_PAL_WIDTH, SCREEN_PAL_HEIGHT,
+		EDITOR_OVERLAY_BPP, BMF_CLEAR
+	);
+	editorOverlayCalculateMinterms();
 	s_sEditorPrevCursorTilePos.uwYX = 0;
 	s_sEditorToolSize.ubX = 1;
 	s_sEditorToolSize.ubY = 1;
 	s_isDecorEditEnabled = 0;
 	s_eEditorCurrentTool = EDITOR_TILE_PALETTE_TOOL_WALL;
+	chipArenaCheckUsed(CHIP_ARENA_SCOPE_STATE);
 
 	systemUnuse();
 	loadLevel(g_sConfig.ubCurrentLevel, 1);
 	ptplayerEnableMusic(1);
 }
 
+static UBYTE gameIsFrameIdle(void) {
+	// Frame starts when beam leaves viewport. Beam still below it or back
+	// at the top of display with enough lines to go means frame work is done
+	// early. Anything else is frame close to or past its deadline.
+	UWORD uwPosY = getRayPos().bfPosY;
+	UWORD uwEndY = s_pView->ubPosY + s_pVpMain->uwOffsY + s_pVpMain->uwHeight;
+	return uwPosY >= uwEndY || uwPosY + GAME_IDLE_LINES_MIN < uwEndY;
+}
+
 static void gameGsLoop(void) {
 	tFadeState eFadeState = fadeProcess(s_pFade);
 	if(eFadeState == FADE_STATE_EVENT_FIRED) {
@@ -1035,6 +1575,7 @@ static void gameGsLoop(void) {
 
 	debugSetColor(0xF89);
  	bobBegin(s_pBufferMain->pBack);
+	timerWheelProcess();
 
 	if(keyUse(KEY_ESCAPE)) {
 		gameTransitionToExit(EXIT_MENU);
@@ -1090,17 +1631,56 @@ static void gameGsLoop(void) {
 	}
 
 	vfxProcess();
-	if(g_pSlipgates[SLIPGATE_AIM].eNormal != DIRECTION_NONE && !s_sPlayer.pGrabbedBox) {
-		bobPush(&s_sBobAim);
+
+	// Small objects go to hardware sprites, bobs are used only as fallback.
+	// Ones near player are bobs too, so that they're still drawn beneath it.
+	spritePoolReset();
+	const tUwCoordYX *pPlayerPos = &s_sPlayer.sBody.sBob.sPos;
+	spritePoolAddOccluder(
+		pPlayerPos->uwX - GAME_SPRITE_PLAYER_MARGIN,
+		pPlayerPos->uwY - GAME_SPRITE_PLAYER_ARM_OFFSET_Y - GAME_SPRITE_PLAYER_MARGIN,
+		16 + 1 + 2 * GAME_SPRITE_PLAYER_MARGIN,
+		16 + GAME_SPRITE_PLAYER_ARM_OFFSET_Y + 2 * GAME_SPRITE_PLAYER_MARGIN
+	);
+	UBYTE isAimVisible = (
+		g_pSlipgates[SLIPGATE_AIM].eNormal != DIRECTION_NONE && !s_sPlayer.pGrabbedBox
+	);
+	UBYTE ubAimHandle = SPRITE_POOL_HANDLE_NONE;
+	if(isAimVisible) {
+		ubAimHandle = spritePoolPush(
+			s_sBobAim.sPos.uwX, s_sBobAim.sPos.uwY,
+			s_pPoolSpriteFrameHeights[s_eAimSpriteFrame], s_eAimSpriteFrame
+		);
 	}
+	UBYTE pBoxHandles[MAP_BOXES_MAX];
 	for(UBYTE i = 0; i < g_sCurrentLevel.ubBoxCount; ++i) {
 		bodySimulate(&s_pBoxBodies[i]);
-		bobPush(&s_pBoxBodies[i].sBob);
+		pBoxHandles[i] = spritePoolPush(
+			s_pBoxBodies[i].sBob.sPos.uwX, s_pBoxBodies[i].sBob.sPos.uwY,
+			s_pPoolSpriteFrameHeights[GAME_SPRITE_FRAME_BOX], GAME_SPRITE_FRAME_BOX
+		);
+	}
+	UBYTE isBouncerVisible = bouncerProcess();
+	UBYTE ubBouncerHandle = SPRITE_POOL_HANDLE_NONE;
+	if(isBouncerVisible) {
+		ubBouncerHandle = spritePoolPush(
+			bouncerGetBody()->sBob.sPos.uwX, bouncerGetBody()->sBob.sPos.uwY,
+			s_pPoolSpriteFrameHeights[GAME_SPRITE_FRAME_BOUNCER],
+			GAME_SPRITE_FRAME_BOUNCER
+		);
 	}
+	spritePoolAssign();
 
-	if(bouncerProcess()) {
-		bobPush(&bouncerGetBody()->sBob);
+	if(isAimVisible) {
+		gameSpriteOrBobPush(ubAimHandle, &s_sBobAim);
 	}
+	for(UBYTE i = 0; i < g_sCurrentLevel.ubBoxCount; ++i) {
+		gameSpriteOrBobPush(pBoxHandles[i], &s_pBoxBodies[i].sBob);
+	}
+	if(isBouncerVisible) {
+		gameSpriteOrBobPush(ubBouncerHandle, &bouncerGetBody()->sBob);
+	}
+	gameSpritesUpdate();
 
 	bodySimulate(&s_sPlayer.sBody);
 	bobPush(&s_sPlayer.sBody.sBob);
@@ -1124,22 +1704,25 @@ static void gameGsLoop(void) {
 	// 	s_szAccelerationX, s_szAccelerationY
 	// );
 
+	// Fade writes palette on its own, so health palette must not override it
+	if(eFadeState == FADE_STATE_IDLE) {
+		s_ubCurrentPaletteIndex = s_sPlayer.bHealth;
+		gameEnablePaletteBlock(s_ubCurrentPaletteIndex);
+	}
+	else {
+		gameEnablePaletteBlock(GAME_PALETTE_BLOCK_NONE);
+	}
+
 	++s_uwGameFrame;
 	viewProcessManagers(s_pView);
 	copProcessBlocks();
+	if(gameIsFrameIdle()) {
+		mapProcessIdle();
+	}
 	debugSetColor(0x9F8);
 	systemIdleBegin();
 	vPortWaitForEnd(s_pVpMain);
 	systemIdleEnd();
-
-	if(eFadeState == FADE_STATE_IDLE) {
-		if(s_ubCurrentPaletteIndex != s_sPlayer.bHealth) {
-			s_ubCurrentPaletteIndex = s_sPlayer.bHealth;
-			for(UBYTE i = 0; i < (1 << GAME_BPP); ++i) {
-				g_pCustom->color[i] = s_pPalettes[s_ubCurrentPaletteIndex][i];
-			}
-		}
-	}
 }
 
 static void gameGsDestroy(void) {
@@ -1152,8 +1735,10 @@ static void gameGsDestroy(void) {
 	viewDestroy(s_pView);
 	bobManagerDestroy();
 
-	fontDestroyTextBitMap(s_pTextBuffer);
-	assetsGameDestroy();
+	// Text layers, pristine level, editor overlay and sprite buffers
+	chipArenaClose(CHIP_ARENA_SCOPE_STATE);
+	mapCloseLevelPack();
+	assetsGameRelease();
 }
 
 static UBYTE s_ubOptionPaletteToolCount;
@@ -1304,11 +1889,14 @@ static void textEditGsLoop(void) {
 	}
 
 	if(isUpdate) {
+		s_isTextLayerValid = 0;
 		textEditUpdateText();
 	}
 }
 
 static void textEditGsDestroy(void) {
+	// Pristine copy has previous story text
+	s_isPristineValid = 0;
 	drawMap();
 }
 
@@ -1347,34 +1935,10 @@ void gameDrawTile(UBYTE ubTileX, UBYTE ubTileY) {
 	g_pCustom->bltcpt = (UBYTE*)((ULONG)s_pBufferMain->pBack->Planes[0] + ulDstOffs);
 	g_pCustom->bltdpt = (UBYTE*)((ULONG)s_pBufferMain->pBack->Planes[0] + ulDstOffs);
 	g_pCustom->bltsize = (uwHeight << HSIZEBITS) | uwBlitWords;
+	s_pPristineStaleColumns[ubTileX] |= 1UL << ubTileY;
 
-	if(s_isEditorEnabled) {
-		if(s_isEditorDrawInteractions) {
-			if(mapTileIsButton(eTile)) {
-				UBYTE ubButtonIndex = (eTile & MAP_TILE_INDEX_MASK) - (TILE_BUTTON_A & MAP_TILE_INDEX_MASK);
-				gameDrawTileInteractionMask(ubTileX, ubTileY, BV(ubButtonIndex));
-			}
-			else if(eTile == TILE_RECEIVER) {
-				gameDrawTileInteractionMask(ubTileX, ubTileY, BV(MAP_BOUNCER_BUTTON_INDEX));
-			}
-			else {
-				tInteraction *pInteraction = mapGetInteractionByTile(ubTileX, ubTileY);
-				if(pInteraction) {
-					gameDrawTileInteractionMask(ubTileX, ubTileY, pInteraction->uwButtonMask);
-				}
-			}
-		}
-
-		if(s_isEditorDrawGrid) {
-			blitLine(
-				s_pBufferMain->pBack, ubTileX * MAP_TILE_SIZE, ubTileY * MAP_TILE_SIZE,
-				(ubTileX + 1) * MAP_TILE_SIZE - 1, ubTileY * MAP_TILE_SIZE, 11, 0xAAAA, 0
-			);
-			blitLine(
-				s_pBufferMain->pBack, ubTileX * MAP_TILE_SIZE, ubTileY * MAP_TILE_SIZE,
-				ubTileX * MAP_TILE_SIZE, (ubTileY + 1) * MAP_TILE_SIZE - 1, 11, 0xAAAA, 0
-			);
-		}
+	if(s_isEditorOverlayVisible) {
+		editorOverlayBlit(ubTileX, ubTileY, 1, MAP_TILE_SIZE);
 	}
 }
 
@@ -1434,13 +1998,14 @@ void gameDrawSlipgate(UBYTE ubIndex) {
 
 	UWORD uwX = g_pSlipgates[ubIndex].sTilePositions[0].ubX * MAP_TILE_SIZE + s_pSlipgateOffsets[g_pSlipgates[ubIndex].eNormal].bX;
 	UWORD uwY = g_pSlipgates[ubIndex].sTilePositions[0].ubY * MAP_TILE_SIZE + s_pSlipgateOffsets[g_pSlipgates[ubIndex].eNormal].bY;
-	tBitMap *pFrames = ubIndex ? g_pSlipgateFramesB : g_pSlipgateFramesA;
+	tBitMap *pFrames = (g_pSlipgates[ubIndex].ubColor == SLIPGATE_B) ? g_pSlipgateFramesB : g_pSlipgateFramesA;
+	UWORD uwHeight = ubFrame ? SLIPGATE_FRAME_HEIGHT_HORIZONTAL : SLIPGATE_FRAME_HEIGHT_VERTICAL;
 	blitCopyMask(
 		pFrames, 0, ubFrame ? SLIPGATE_FRAME_HEIGHT_VERTICAL : 0,
-		s_pBufferMain->pBack, uwX, uwY, 16,
-		ubFrame ? SLIPGATE_FRAME_HEIGHT_HORIZONTAL : SLIPGATE_FRAME_HEIGHT_VERTICAL,
+		s_pBufferMain->pBack, uwX, uwY, 16, uwHeight,
 		g_pSlipgateMasks->Planes[0]
 	);
+	pristineMarkStale(uwX, uwY, 16, uwHeight);
 }
 
 void gameUpdateAim(void) {
@@ -1450,6 +2015,7 @@ void gameUpdateAim(void) {
 	UBYTE* pOffsFrame = bobCalcFrameAddress(g_pAim, ubFrame ? SLIPGATE_FRAME_HEIGHT_VERTICAL : 0);
 	UBYTE* pOffsMask = bobCalcFrameAddress(g_pAimMasks, ubFrame ? SLIPGATE_FRAME_HEIGHT_VERTICAL : 0);
 	bobSetFrame(&s_sBobAim, pOffsFrame, pOffsMask);
+	s_eAimSpriteFrame = GAME_SPRITE_FRAME_AIM_VERTICAL + ubFrame;
 }
 
 tPlayer *gameGetPlayer(void) {
@@ -0,0 +1,122 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "job_scheduler.h"
+#include <ace/managers/log.h>
+
+typedef struct tJob {
+	const char *szName;
+	tCbJob cbJob;
+	tJobStats sStats;
+	UWORD uwCost;
+	UWORD uwRequestFrame;
+	tJobPriority ePriority;
+	UBYTE isPending;
+} tJob;
+
+static tJob s_pJobs[JOB_SCHEDULER_JOBS_MAX];
+static UBYTE s_ubJobCount;
+static UWORD s_uwFrame;
+
+void jobSchedulerReset(void) {
+	s_ubJobCount = 0;
+	s_uwFrame = 0;
+}
+
+UBYTE jobSchedulerRegister(const char *szName, tCbJob cbJob, tJobPriority ePriority) {
+	if(s_ubJobCount >= JOB_SCHEDULER_JOBS_MAX) {
+		logWrite("ERR: Too many jobs, can't register %s\n", szName);
+		return JOB_SCHEDULER_JOB_INVALID;
+	}
+
+	tJob *pJob = &s_pJobs[s_ubJobCount];
+	pJob->szName = szName;
+	pJob->cbJob = cbJob;
+	pJob->ePriority = ePriority;
+	pJob->isPending = 0;
+	pJob->uwCost = 0;
+	pJob->sStats.ulRunCount = 0;
+	pJob->sStats.ulDeferCount = 0;
+	pJob->sStats.uwLatencyLast = 0;
+	pJob->sStats.uwLatencyMax = 0;
+	return s_ubJobCount++;
+}
+
+void jobSchedulerRequest(UBYTE ubJob, UWORD uwCost) {
+	tJob *pJob = &s_pJobs[ubJob];
+	if(!pJob->isPending) {
+		pJob->isPending = 1;
+		pJob->uwRequestFrame = s_uwFrame;
+	}
+	pJob->uwCost = uwCost;
+}
+
+static void jobSchedulerRun(tJob *pJob, UWORD uwLatency) {
+	// Job may request itself again while running
+	pJob->isPending = 0;
+	pJob->cbJob();
+
+	++pJob->sStats.ulRunCount;
+	pJob->sStats.uwLatencyLast = uwLatency;
+	if(uwLatency > pJob->sStats.uwLatencyMax) {
+		pJob->sStats.uwLatencyMax = uwLatency;
+	}
+}
+
+void jobSchedulerProcess(UWORD uwBudget) {
+	// Mandatory jobs will run anyway, so reserve budget for them first
+	UWORD uwSpent = 0;
+	for(UBYTE i = 0; i < s_ubJobCount; ++i) {
+		if(s_pJobs[i].isPending && s_pJobs[i].ePriority == JOB_PRIORITY_MANDATORY) {
+			uwSpent += s_pJobs[i].uwCost;
+		}
+	}
+
+	for(UBYTE i = 0; i < s_ubJobCount; ++i) {
+		tJob *pJob = &s_pJobs[i];
+		if(!pJob->isPending || pJob->ePriority == JOB_PRIORITY_IDLE) {
+			continue;
+		}
+
+		UWORD uwLatency = s_uwFrame - pJob->uwRequestFrame;
+		if(pJob->ePriority == JOB_PRIORITY_DEFERRABLE) {
+			UBYTE isRunning = (
+				uwSpent + pJob->uwCost <= uwBudget ||
+				uwLatency >= JOB_SCHEDULER_LATENCY_MAX
+			);
+			if(!isRunning) {
+				++pJob->sStats.ulDeferCount;
+				continue;
+			}
+			uwSpent += pJob->uwCost;
+		}
+		jobSchedulerRun(pJob, uwLatency);
+	}
+	++s_uwFrame;
+}
+
+void jobSchedulerProcessIdle(void) {
+	for(UBYTE i = 0; i < s_ubJobCount; ++i) {
+		tJob *pJob = &s_pJobs[i];
+		if(pJob->isPending && pJob->ePriority == JOB_PRIORITY_IDLE) {
+			jobSchedulerRun(pJob, s_uwFrame - pJob->uwRequestFrame);
+			return;
+		}
+	}
+}
+
+const tJobStats *jobSchedulerGetStats(UBYTE ubJob) {
+	return &s_pJobs[ubJob].sStats;
+}
+
+void jobSchedulerLogStats(void) {
+	for(UBYTE i = 0; i < s_ubJobCount; ++i) {
+		const tJob *pJob = &s_pJobs[i];
+		logWrite(
+			"Job %s: runs %lu, deferred %lu, latency last %hu max %hu\n",
+			pJob->szName, pJob->sStats.ulRunCount, pJob->sStats.ulDeferCount,
+			pJob->sStats.uwLatencyLast, pJob->sStats.uwLatencyMax
+		);
+	}
+}
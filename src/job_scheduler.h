@@ -0,0 +1,76 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_JOB_SCHEDULER_H
+#define SLIPGATES_JOB_SCHEDULER_H
+
+#include <ace/types.h>
+
+#define JOB_SCHEDULER_JOBS_MAX 8
+#define JOB_SCHEDULER_JOB_INVALID 0xFF
+
+// Deferrable job waiting for this many frames runs regardless of budget
+#define JOB_SCHEDULER_LATENCY_MAX 8
+
+typedef void (*tCbJob)(void);
+
+typedef enum tJobPriority {
+	// Runs in frame it was requested regardless of budget. Its cost is
+	// reserved before other jobs are run.
+	JOB_PRIORITY_MANDATORY,
+	// Runs when it fits in budget, or after JOB_SCHEDULER_LATENCY_MAX frames.
+	JOB_PRIORITY_DEFERRABLE,
+	// Runs only from jobSchedulerProcessIdle(), never forced by latency.
+	JOB_PRIORITY_IDLE,
+} tJobPriority;
+
+typedef struct tJobStats {
+	ULONG ulRunCount;
+	ULONG ulDeferCount;
+	UWORD uwLatencyLast;
+	UWORD uwLatencyMax;
+} tJobStats;
+
+/**
+ * @brief Removes all jobs and clears stats.
+ */
+void jobSchedulerReset(void);
+
+/**
+ * @brief Registers job. Jobs registered earlier have higher priority.
+ *
+ * @param cbJob Function doing the job's work.
+ * @return Job index, JOB_SCHEDULER_JOB_INVALID if there are too many jobs.
+ */
+UBYTE jobSchedulerRegister(const char *szName, tCbJob cbJob, tJobPriority ePriority);
+
+/**
+ * @brief Marks job as pending. Re-requesting pending job only updates
+ * its estimated cost - latency is measured from first request.
+ *
+ * @param uwCost Estimated cost in budget units - roughly tile draws.
+ * Ignored for idle jobs.
+ */
+void jobSchedulerRequest(UBYTE ubJob, UWORD uwCost);
+
+/**
+ * @brief Runs pending jobs in priority order until budget is used up.
+ * Remaining ones are carried over to next frame.
+ */
+void jobSchedulerProcess(UWORD uwBudget);
+
+/**
+ * @brief Runs first pending idle job. Meant to be called only when frame
+ * has spare time left, so at most one job is run per call.
+ */
+void jobSchedulerProcessIdle(void);
+
+const tJobStats *jobSchedulerGetStats(UBYTE ubJob);
+
+/**
+ * @brief Writes stats of all jobs to log.
+ */
+void jobSchedulerLogStats(void);
+
+#endif // SLIPGATES_JOB_SCHEDULER_H
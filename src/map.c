@@ -6,8 +6,14 @@
 #include <bartman/gcc8_c_support.h>
 #include <ace/utils/disk_file.h>
 #include <ace/managers/system.h>
+#include <ace/managers/memory.h>
 #include "game.h"
 #include "bouncer.h"
+#include "timer_wheel.h"
+#include "job_scheduler.h"
+#include "autotile.h"
+#include "slipgate_placement.h"
+#include "plane_rle.h"
 
 #define MAP_SPIKES_COOLDOWN 50
 #define MAP_DIRTY_TILES_MAX (MAP_TILE_WIDTH * MAP_TILE_HEIGHT)
@@ -15,6 +21,81 @@
 #define MAP_TURRET_ATTACK_FRAME_COOLDOWN 5
 #define MAP_TURRET_TILE_RANGE 20
 #define MAP_PENDING_SLIPGATE_OPEN_INVALID 0xFF
+#define MAP_JOB_BUDGET_DEFAULT 24
+#define MAP_JOB_COST_INTERACTION 4
+#define MAP_JOB_COST_SLIPGATE_DRAW 4
+#define MAP_JOB_COST_SPIKE 4
+#define MAP_JOB_COST_TURRET 1
+#define MAP_LEVEL_PREFETCH_CHUNK 512
+// Frames after level load before prefetch starts, so that it doesn't compete
+// with level's first moments. Also lets floppy motor go off after the load.
+#define MAP_LEVEL_PREFETCH_DELAY 150
+
+// Level file v2: fixed header, tile & vistile planes, then variable sections.
+// All values are big endian, every section starts on even offset.
+#define MAP_LEVEL_VERSION 2
+#define MAP_LEVEL_HEADER_SIZE 32
+#define MAP_LEVEL_PLANE_SIZE (MAP_TILE_WIDTH * MAP_TILE_HEIGHT * 2)
+#define MAP_LEVEL_INTERACTION_SIZE 2
+#define MAP_LEVEL_TARGET_SIZE 12
+#define MAP_LEVEL_BOX_SIZE 8
+#define MAP_LEVEL_SPIKE_SIZE 2
+#define MAP_LEVEL_TURRET_SIZE 2
+#define MAP_LEVEL_FLAG_PACKED_PLANES BV(0)
+#define MAP_LEVEL_PAYLOAD_MAX (2 * MAP_LEVEL_PLANE_SIZE + \
+	MAP_INTERACTIONS_MAX * ( \
+		MAP_LEVEL_INTERACTION_SIZE + INTERACTION_TARGET_MAX * MAP_LEVEL_TARGET_SIZE \
+	) + MAP_BOXES_MAX * MAP_LEVEL_BOX_SIZE + \
+	MAP_SPIKES_TILES_MAX * MAP_LEVEL_SPIKE_SIZE + \
+	MAP_TURRETS_MAX * MAP_LEVEL_TURRET_SIZE + MAP_STORY_TEXT_MAX \
+)
+
+// Level pack: header, index of entries, then level files one after another
+#define MAP_LEVEL_PACK_PATH "data/levels.pak"
+#define MAP_LEVEL_OVERRIDE_DIR "data/levels"
+#define MAP_LEVEL_PACK_HEADER_SIZE 8
+#define MAP_LEVEL_PACK_ENTRY_SIZE 8
+#define MAP_LEVEL_PACK_ENTRIES_MAX 64
+
+#if MAP_LEVEL_PAYLOAD_MAX > 0xFFFF
+#error "Level payload size needs to fit in UWORD"
+#endif
+
+typedef struct tLevelPackEntry {
+	ULONG ulOffset; // From start of pack file
+	UWORD uwSize;
+	UBYTE ubLevelIndex;
+} tLevelPackEntry;
+
+typedef struct tLevelHeader {
+	tFix16Coord sSpawnPos;
+	const UBYTE *pTargetCounts; // Points into raw header
+	UWORD uwPayloadSize; // Unpacked, past header
+	UWORD uwStoredSize; // As in file, past header
+	UWORD uwBufferSize; // Needed to unpack stored data
+	UBYTE ubBoxCount;
+	UBYTE ubSpikeTilesCount;
+	UBYTE ubTurretCount;
+	UBYTE ubStoryTextLength;
+	UBYTE isPacked;
+} tLevelHeader;
+
+typedef enum tLevelPrefetchState {
+	LEVEL_PREFETCH_STATE_IDLE,
+	LEVEL_PREFETCH_STATE_HEADER,
+	LEVEL_PREFETCH_STATE_DATA,
+	LEVEL_PREFETCH_STATE_DONE,
+} tLevelPrefetchState;
+
+typedef struct tLevelPrefetch {
+	UBYTE pHeader[MAP_LEVEL_HEADER_SIZE];
+	tLevelHeader sHeader;
+	UBYTE *pBuffer;
+	ULONG ulFilePos; // Next chunk's position in level pack
+	UWORD uwStoredRead;
+	UBYTE ubLevelIndex;
+	tLevelPrefetchState eState;
+} tLevelPrefetch;
 
 typedef struct tTurret {
 	tUbCoordYX sTilePos;
@@ -22,31 +103,27 @@ typedef struct tTurret {
 	tUwCoordYX sScanBottomRight;
 	UBYTE isActive;
 	UBYTE isInAttackFrame;
-	UBYTE ubLastAttackFrame;
+	UBYTE isReadyToAttack;
+	tTimer sAttackTimer;
+	UBYTE ubScanDependLeftX; // Tiles which could change scan range, inclusive
+	UBYTE ubScanDependRightX;
 } tTurret;
 
-typedef enum tNeighborFlag {
-	NEIGHBOR_FLAG_N  = BV(0),
-	NEIGHBOR_FLAG_NE = BV(1),
-	NEIGHBOR_FLAG_E  = BV(2),
-	NEIGHBOR_FLAG_SE = BV(3),
-	NEIGHBOR_FLAG_S  = BV(4),
-	NEIGHBOR_FLAG_SW = BV(5),
-	NEIGHBOR_FLAG_W  = BV(6),
-	NEIGHBOR_FLAG_NW = BV(7),
-} tNeighborFlag;
-
-typedef struct tGatewayKind {
-	tTile eTileFront;
-	tVisTile eVisTileFirst;
-} tGatewayKind;
-
 //----------------------------------------------------------------- PRIVATE VARS
 
 static tInteraction s_pInteractions[MAP_INTERACTIONS_MAX];
 static UWORD s_uwButtonPressMask;
-static UBYTE s_ubCurrentInteraction;
-static UWORD s_uwSpikeCooldown;
+static UWORD s_uwPrevButtonPressMask;
+static UWORD s_pButtonInteractions[MAP_BUTTON_BITS]; // Bit per dependent interaction
+static UWORD s_uwPendingInteractions;
+static tTimer s_sSpikeTimer;
+static UWORD s_uwJobBudget = MAP_JOB_BUDGET_DEFAULT;
+static UBYTE s_ubJobDirtyTiles;
+static UBYTE s_ubJobSlipgateDraw;
+static UBYTE s_ubJobInteractions;
+static UBYTE s_ubJobSpikes;
+static UBYTE s_ubJobTurrets;
+static UBYTE s_ubJobLevelPrefetch;
 static UBYTE s_isSpikeActive;
 static UBYTE s_pDirtyTiles[MAP_TILE_WIDTH][MAP_TILE_HEIGHT]; // x,y
 static tUbCoordYX s_pDirtyTileQueues[2][MAP_DIRTY_TILES_MAX];
@@ -54,46 +131,110 @@ static UWORD s_pDirtyTileCounts[2];
 static UBYTE s_ubCurrentDirtyList;
 static tTurret s_pTurrets[MAP_TURRETS_MAX];
 static UBYTE s_ubTurretCount;
+static UBYTE s_pTurretRowMasks[MAP_TILE_HEIGHT]; // Bit per turret in given row
 static UBYTE s_ubCurrentTurret;
 static tLevel s_sLoadedLevel;
 static UBYTE s_ubPendingSlipgateOpenIndex;
 static UBYTE s_ubPendingSlipgateDraws;
+static UBYTE s_pSlipgateGrid[MAP_TILE_WIDTH][MAP_TILE_HEIGHT]; // x,y, index of slipgate on wall tile
+static tFile *s_pLevelPack;
+static tLevelPackEntry s_pLevelPackEntries[MAP_LEVEL_PACK_ENTRIES_MAX];
+static UBYTE s_ubLevelPackEntryCount;
+static UBYTE s_isLevelOverrideDirPresent;
+static tLevelPrefetch s_sLevelPrefetch;
+static tTimer s_sLevelPrefetchTimer;
 
-static const tGatewayKind s_pGatewayKinds[] = {
-	{.eTileFront = TILE_DOOR_CLOSED, .eVisTileFirst = VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP},
-	{.eTileFront = TILE_DOOR_OPEN, .eVisTileFirst = VIS_TILE_DOOR_LEFT_OPEN_WALL_TOP},
-	{.eTileFront = TILE_GRATE, .eVisTileFirst = VIS_TILE_GRATE_LEFT_WALL_TOP},
-	{.eTileFront = TILE_DEATH_FIELD, .eVisTileFirst = VIS_TILE_DEATH_FIELD_LEFT_WALL_TOP},
-};
-#define MAP_GATEWAY_KIND_COUNT (sizeof(s_pGatewayKinds) / sizeof(s_pGatewayKinds[0]))
+static const UBYTE s_pLevelMagic[4] = {'S', 'L', 'V', 'L'};
+static const UBYTE s_pLevelPackMagic[4] = {'S', 'L', 'P', 'K'};
 
 //------------------------------------------------------------ PRIVATE FUNCTIONS
 
-static void mapLogicTryOpenSlipgates(void) {
-	if(!mapIsSlipgateTunnelOpen()) {
-		return;
+static void mapTurretCalculateScanRange(tTurret *pTurret) {
+	UBYTE ubLeftTileX = pTurret->sTilePos.ubX;
+	for(UBYTE i = 0; i < MAP_TURRET_TILE_RANGE; ++i) {
+		if(mapIsCollidingWithPortalProjectilesAt(ubLeftTileX - 1, pTurret->sTilePos.ubY)) {
+			break;
+		}
+		--ubLeftTileX;
+	}
+
+	UBYTE ubRightTileX = pTurret->sTilePos.ubX + 1;
+	for(UBYTE i = 0; i < MAP_TURRET_TILE_RANGE; ++i) {
+		if(mapIsCollidingWithPortalProjectilesAt(ubRightTileX, pTurret->sTilePos.ubY)) {
+			break;
+		}
+		++ubRightTileX;
 	}
 
-	tUbCoordYX *pSlipgateTiles = g_pSlipgates[SLIPGATE_A].sTilePositions;
-	g_sCurrentLevel.pTiles[pSlipgateTiles[0].ubX][pSlipgateTiles[0].ubY] = TILE_SLIPGATE_A;
-	g_sCurrentLevel.pTiles[pSlipgateTiles[1].ubX][pSlipgateTiles[1].ubY] = TILE_SLIPGATE_A;
+	// Scan ends at blocking tile or at range limit - either way everything
+	// between those tiles, including them, affects the range.
+	pTurret->ubScanDependLeftX = ubLeftTileX - 1;
+	pTurret->ubScanDependRightX = ubRightTileX;
 
-	pSlipgateTiles = g_pSlipgates[SLIPGATE_B].sTilePositions;
-	g_sCurrentLevel.pTiles[pSlipgateTiles[0].ubX][pSlipgateTiles[0].ubY] = TILE_SLIPGATE_B;
-	g_sCurrentLevel.pTiles[pSlipgateTiles[1].ubX][pSlipgateTiles[1].ubY] = TILE_SLIPGATE_B;
+	pTurret->sScanTopLeft.uwX = ubLeftTileX * MAP_TILE_SIZE;
+	pTurret->sScanTopLeft.uwY = pTurret->sTilePos.ubY * MAP_TILE_SIZE;
+	pTurret->sScanBottomRight.uwX = ubRightTileX * MAP_TILE_SIZE;
+	pTurret->sScanBottomRight.uwY = (pTurret->sTilePos.ubY + 1) * MAP_TILE_SIZE;
 }
 
-static void mapLogicCloseSlipgates(void) {
-	tSlipgate *pSlipgate = &g_pSlipgates[SLIPGATE_A];
-	if(pSlipgate->eNormal != DIRECTION_NONE) {
-		g_sCurrentLevel.pTiles[pSlipgate->sTilePositions[0].ubX][pSlipgate->sTilePositions[0].ubY] = pSlipgate->pPrevTiles[0];
-		g_sCurrentLevel.pTiles[pSlipgate->sTilePositions[1].ubX][pSlipgate->sTilePositions[1].ubY] = pSlipgate->pPrevTiles[1];
+static void mapRebuildTurretRowMasks(void) {
+	memset(s_pTurretRowMasks, 0, sizeof(s_pTurretRowMasks));
+	for(UBYTE i = 0; i < s_ubTurretCount; ++i) {
+		s_pTurretRowMasks[s_pTurrets[i].sTilePos.ubY] |= BV(i);
+	}
+}
+
+static void mapUpdateTurretsInRect(
+	UBYTE ubLeftX, UBYTE ubTopY, UBYTE ubRightX, UBYTE ubBottomY
+) {
+	UBYTE ubTurretMask = 0;
+	for(UBYTE ubY = ubTopY; ubY <= ubBottomY; ++ubY) {
+		ubTurretMask |= s_pTurretRowMasks[ubY];
 	}
+	for(UBYTE i = 0; ubTurretMask; ++i, ubTurretMask >>= 1) {
+		if(ubTurretMask & 1) {
+			tTurret *pTurret = &s_pTurrets[i];
+			if(
+				pTurret->ubScanDependLeftX <= ubRightX &&
+				ubLeftX <= pTurret->ubScanDependRightX
+			) {
+				mapTurretCalculateScanRange(pTurret);
+			}
+		}
+	}
+}
+
+static void mapSetTileAt(UBYTE ubTileX, UBYTE ubTileY, tTile eTile) {
+	g_sCurrentLevel.pTiles[ubTileX][ubTileY] = eTile;
+	mapUpdateTurretsInRect(ubTileX, ubTileY, ubTileX, ubTileY);
+}
+
+static void mapLogicOpenSlipgate(const tSlipgate *pSlipgate) {
+	tTile eTile = (pSlipgate->ubColor == SLIPGATE_A) ? TILE_SLIPGATE_A : TILE_SLIPGATE_B;
+	mapSetTileAt(pSlipgate->sTilePositions[0].ubX, pSlipgate->sTilePositions[0].ubY, eTile);
+	mapSetTileAt(pSlipgate->sTilePositions[1].ubX, pSlipgate->sTilePositions[1].ubY, eTile);
+}
 
-	pSlipgate = &g_pSlipgates[SLIPGATE_B];
+static void mapLogicTryOpenSlipgates(UBYTE ubIndex) {
+	if(!mapIsSlipgateTunnelOpen(ubIndex)) {
+		return;
+	}
+
+	mapLogicOpenSlipgate(&g_pSlipgates[ubIndex]);
+	mapLogicOpenSlipgate(&g_pSlipgates[g_pSlipgates[ubIndex].ubLinkedIndex]);
+}
+
+static void mapLogicCloseSlipgate(const tSlipgate *pSlipgate) {
 	if(pSlipgate->eNormal != DIRECTION_NONE) {
-		g_sCurrentLevel.pTiles[pSlipgate->sTilePositions[0].ubX][pSlipgate->sTilePositions[0].ubY] = pSlipgate->pPrevTiles[0];
-		g_sCurrentLevel.pTiles[pSlipgate->sTilePositions[1].ubX][pSlipgate->sTilePositions[1].ubY] = pSlipgate->pPrevTiles[1];
+		mapSetTileAt(pSlipgate->sTilePositions[0].ubX, pSlipgate->sTilePositions[0].ubY, pSlipgate->pPrevTiles[0]);
+		mapSetTileAt(pSlipgate->sTilePositions[1].ubX, pSlipgate->sTilePositions[1].ubY, pSlipgate->pPrevTiles[1]);
+	}
+}
+
+static void mapLogicCloseSlipgates(const tSlipgate *pSlipgate) {
+	mapLogicCloseSlipgate(pSlipgate);
+	if(pSlipgate->ubLinkedIndex != SLIPGATE_INDEX_NONE) {
+		mapLogicCloseSlipgate(&g_pSlipgates[pSlipgate->ubLinkedIndex]);
 	}
 }
 
@@ -106,9 +247,11 @@ static void mapOpenSlipgate(UBYTE ubIndex) {
 		// Save logic tiles
 		pSlipgate->pPrevTiles[0] = g_sCurrentLevel.pTiles[pSlipgate->sTilePositions[0].ubX][pSlipgate->sTilePositions[0].ubY];
 		pSlipgate->pPrevTiles[1] = g_sCurrentLevel.pTiles[pSlipgate->sTilePositions[1].ubX][pSlipgate->sTilePositions[1].ubY];
+		s_pSlipgateGrid[pSlipgate->sTilePositions[0].ubX][pSlipgate->sTilePositions[0].ubY] = ubIndex;
+		s_pSlipgateGrid[pSlipgate->sTilePositions[1].ubX][pSlipgate->sTilePositions[1].ubY] = ubIndex;
 
 		// Change logic tiles to slipgate
-		mapLogicTryOpenSlipgates();
+		mapLogicTryOpenSlipgates(ubIndex);
 
 		if(s_ubPendingSlipgateOpenIndex != MAP_PENDING_SLIPGATE_OPEN_INVALID) {
 			logWrite("ERR: Previous pending slipgate haven't been opened!\n");
@@ -121,7 +264,9 @@ static void mapOpenSlipgate(UBYTE ubIndex) {
 static void mapCloseSlipgate(tSlipgate *pSlipgate) {
 	if(pSlipgate->eNormal != DIRECTION_NONE) {
 		// Restore logic tiles
-		mapLogicCloseSlipgates();
+		mapLogicCloseSlipgates(pSlipgate);
+		s_pSlipgateGrid[pSlipgate->sTilePositions[0].ubX][pSlipgate->sTilePositions[0].ubY] = SLIPGATE_INDEX_NONE;
+		s_pSlipgateGrid[pSlipgate->sTilePositions[1].ubX][pSlipgate->sTilePositions[1].ubY] = SLIPGATE_INDEX_NONE;
 
 		// Redraw tiles
 		mapRequestTileDraw(pSlipgate->sTilePositions[0].ubX, pSlipgate->sTilePositions[0].ubY);
@@ -133,10 +278,9 @@ static void mapCloseSlipgate(tSlipgate *pSlipgate) {
 	}
 }
 
-static void mapProcessNextInteraction(void) {
-	tInteraction *pInteraction = &s_pInteractions[s_ubCurrentInteraction];
+static void mapProcessInteraction(UBYTE ubInteractionIndex) {
+	tInteraction *pInteraction = &s_pInteractions[ubInteractionIndex];
 
-	// Process effects of next interaction
 	if(
 		pInteraction->uwButtonMask &&
 		(pInteraction->uwButtonMask & s_uwButtonPressMask) == pInteraction->uwButtonMask
@@ -145,10 +289,9 @@ static void mapProcessNextInteraction(void) {
 			for(UBYTE i = 0; i < pInteraction->ubTargetCount; ++i) {
 				tTogglableTile *pTile = &pInteraction->pTargetTiles[i];
 				if(pTile->eKind == INTERACTION_KIND_SLIPGATABLE) {
-					mapTryCloseSlipgateAt(0, pTile->sPos);
-					mapTryCloseSlipgateAt(1, pTile->sPos);
+					mapTryCloseSlipgateAt(pTile->sPos);
 				}
-				g_sCurrentLevel.pTiles[pTile->sPos.ubX][pTile->sPos.ubY] = pTile->eTileActive;
+				mapSetTileAt(pTile->sPos.ubX, pTile->sPos.ubY, pTile->eTileActive);
 				g_sCurrentLevel.pVisTiles[pTile->sPos.ubX][pTile->sPos.ubY] = pTile->eVisTileActive;
 				mapRequestTileDraw(pTile->sPos.ubX, pTile->sPos.ubY);
 			}
@@ -160,89 +303,132 @@ static void mapProcessNextInteraction(void) {
 			for(UBYTE i = 0; i < pInteraction->ubTargetCount; ++i) {
 				tTogglableTile *pTile = &pInteraction->pTargetTiles[i];
 				if(pTile->eKind == INTERACTION_KIND_SLIPGATABLE) {
-					mapTryCloseSlipgateAt(0, pTile->sPos);
-					mapTryCloseSlipgateAt(1, pTile->sPos);
+					mapTryCloseSlipgateAt(pTile->sPos);
 				}
-				g_sCurrentLevel.pTiles[pTile->sPos.ubX][pTile->sPos.ubY] = pTile->eTileInactive;
+				mapSetTileAt(pTile->sPos.ubX, pTile->sPos.ubY, pTile->eTileInactive);
 				g_sCurrentLevel.pVisTiles[pTile->sPos.ubX][pTile->sPos.ubY] = pTile->eVisTileInactive;
 				mapRequestTileDraw(pTile->sPos.ubX, pTile->sPos.ubY);
 			}
 			pInteraction->wasActive = 0;
 		}
 	}
+}
+
+static void mapRequestChangedInteractions(void) {
+	// Only interactions depending on buttons which changed state need a check
+	UWORD uwChangedButtons = s_uwButtonPressMask ^ s_uwPrevButtonPressMask;
+	s_uwPrevButtonPressMask = s_uwButtonPressMask;
+	for(UBYTE ubButton = 0; uwChangedButtons; ++ubButton, uwChangedButtons >>= 1) {
+		if(uwChangedButtons & 1) {
+			s_uwPendingInteractions |= s_pButtonInteractions[ubButton];
+		}
+	}
 
-	if(++s_ubCurrentInteraction >= MAP_INTERACTIONS_MAX) {
-		s_ubCurrentInteraction = 0;
+	UBYTE ubPendingCount = 0;
+	for(UWORD uwPending = s_uwPendingInteractions; uwPending; uwPending >>= 1) {
+		ubPendingCount += (uwPending & 1);
+	}
+	if(ubPendingCount) {
+		jobSchedulerRequest(
+			s_ubJobInteractions, ubPendingCount * MAP_JOB_COST_INTERACTION
+		);
+	}
+}
+
+static void mapProcessInteractions(void) {
+	UWORD uwPending = s_uwPendingInteractions;
+	s_uwPendingInteractions = 0;
+	for(UBYTE i = 0; uwPending; ++i, uwPending >>= 1) {
+		if(uwPending & 1) {
+			mapProcessInteraction(i);
+		}
 	}
 }
 
+static void mapOnTurretReloaded(void *pData) {
+	tTurret *pTurret = pData;
+	pTurret->isReadyToAttack = 1;
+}
+
+static void mapOnTurretAttackFrameEnd(void *pData) {
+	tTurret *pTurret = pData;
+	g_sCurrentLevel.pVisTiles[pTurret->sTilePos.ubX][pTurret->sTilePos.ubY] = VIS_TILE_TURRET_ACTIVE;
+	mapRequestTileDraw(pTurret->sTilePos.ubX, pTurret->sTilePos.ubY);
+	pTurret->isInAttackFrame = 0;
+	timerWheelSchedule(
+		&pTurret->sAttackTimer,
+		MAP_TURRET_ATTACK_COOLDOWN - MAP_TURRET_ATTACK_FRAME_COOLDOWN,
+		mapOnTurretReloaded, pTurret
+	);
+}
+
 static void mapProcessNextTurret(void) {
 	if(++s_ubCurrentTurret >= MAP_TURRETS_MAX) {
 		s_ubCurrentTurret = 0;
 	}
 
 	tTurret *pTurret = &s_pTurrets[s_ubCurrentTurret];
-	if(pTurret->isActive) {
-		UBYTE ubCurrentGameFrame = gameGetFrameIndex();
-		UBYTE ubDeltaAttack = (
-			(ubCurrentGameFrame > pTurret->ubLastAttackFrame) ?
-			ubCurrentGameFrame - pTurret->ubLastAttackFrame :
-			256 + ubCurrentGameFrame - pTurret->ubLastAttackFrame
-		);
-		if(pTurret->isInAttackFrame && ubDeltaAttack >= MAP_TURRET_ATTACK_FRAME_COOLDOWN) {
-			g_sCurrentLevel.pVisTiles[pTurret->sTilePos.ubX][pTurret->sTilePos.ubY] = VIS_TILE_TURRET_ACTIVE;
+	if(pTurret->isActive && pTurret->isReadyToAttack) {
+		tPlayer *pPlayer = gameGetPlayer();
+		UWORD uwPlayerX = fix16_to_int(pPlayer->sBody.fPosX);
+		UWORD uwPlayerY = fix16_to_int(pPlayer->sBody.fPosY);
+		if(
+			pTurret->sScanTopLeft.uwX < uwPlayerX + pPlayer->sBody.ubWidth &&
+			pTurret->sScanBottomRight.uwX > uwPlayerX &&
+			pTurret->sScanTopLeft.uwY < uwPlayerY + pPlayer->sBody.ubHeight &&
+			pTurret->sScanBottomRight.uwY > uwPlayerY
+		) {
+			playerDamage(pPlayer, 1);
+			pTurret->isInAttackFrame = 1;
+			pTurret->isReadyToAttack = 0;
+			timerWheelSchedule(
+				&pTurret->sAttackTimer, MAP_TURRET_ATTACK_FRAME_COOLDOWN,
+				mapOnTurretAttackFrameEnd, pTurret
+			);
+			g_sCurrentLevel.pVisTiles[pTurret->sTilePos.ubX][pTurret->sTilePos.ubY] = VIS_TILE_TURRET_SHOOTING;
 			mapRequestTileDraw(pTurret->sTilePos.ubX, pTurret->sTilePos.ubY);
-			pTurret->isInAttackFrame = 0;
-		}
-		else if(ubDeltaAttack >= MAP_TURRET_ATTACK_COOLDOWN) {
-			tPlayer *pPlayer = gameGetPlayer();
-			UWORD uwPlayerX = fix16_to_int(pPlayer->sBody.fPosX);
-			UWORD uwPlayerY = fix16_to_int(pPlayer->sBody.fPosY);
-			if(
-				pTurret->sScanTopLeft.uwX < uwPlayerX + pPlayer->sBody.ubWidth &&
-				pTurret->sScanBottomRight.uwX > uwPlayerX &&
-				pTurret->sScanTopLeft.uwY < uwPlayerY + pPlayer->sBody.ubHeight &&
-				pTurret->sScanBottomRight.uwY > uwPlayerY
-			) {
-				playerDamage(pPlayer, 1);
-				pTurret->isInAttackFrame = 1;
-				pTurret->ubLastAttackFrame = ubCurrentGameFrame;
-				g_sCurrentLevel.pVisTiles[pTurret->sTilePos.ubX][pTurret->sTilePos.ubY] = VIS_TILE_TURRET_SHOOTING;
-				mapRequestTileDraw(pTurret->sTilePos.ubX, pTurret->sTilePos.ubY);
-			}
 		}
 	}
 }
 
-static UBYTE mapProcessSpikes(void) {
-	if(--s_uwSpikeCooldown == 0) {
-		s_isSpikeActive = !s_isSpikeActive;
-		if(s_isSpikeActive)  {
-			for(UBYTE i = 0; i < g_sCurrentLevel.ubSpikeTilesCount; ++i) {
-				tUbCoordYX sSpikeCoord = g_sCurrentLevel.pSpikeTiles[i];
-				g_sCurrentLevel.pTiles[sSpikeCoord.ubX][sSpikeCoord.ubY] = TILE_SPIKES_ON_FLOOR;
-				g_sCurrentLevel.pVisTiles[sSpikeCoord.ubX][sSpikeCoord.ubY] = VIS_TILE_SPIKES_ON_FLOOR_1;
-				mapRequestTileDraw(sSpikeCoord.ubX, sSpikeCoord.ubY);
-				g_sCurrentLevel.pTiles[sSpikeCoord.ubX][sSpikeCoord.ubY - 1] = TILE_SPIKES_ON_BG;
-				g_sCurrentLevel.pVisTiles[sSpikeCoord.ubX][sSpikeCoord.ubY - 1] = VIS_TILE_SPIKES_ON_BG_1;
-				mapRequestTileDraw(sSpikeCoord.ubX, sSpikeCoord.ubY - 1);
-			}
+static void mapOnSpikeTimer(UNUSED_ARG void *pData) {
+	jobSchedulerRequest(
+		s_ubJobSpikes, g_sCurrentLevel.ubSpikeTilesCount * MAP_JOB_COST_SPIKE
+	);
+	timerWheelSchedule(&s_sSpikeTimer, MAP_SPIKES_COOLDOWN, mapOnSpikeTimer, 0);
+}
+
+static void mapProcessSpikes(void) {
+	s_isSpikeActive = !s_isSpikeActive;
+	if(s_isSpikeActive)  {
+		for(UBYTE i = 0; i < g_sCurrentLevel.ubSpikeTilesCount; ++i) {
+			tUbCoordYX sSpikeCoord = g_sCurrentLevel.pSpikeTiles[i];
+			g_sCurrentLevel.pTiles[sSpikeCoord.ubX][sSpikeCoord.ubY] = TILE_SPIKES_ON_FLOOR;
+			g_sCurrentLevel.pVisTiles[sSpikeCoord.ubX][sSpikeCoord.ubY] = VIS_TILE_SPIKES_ON_FLOOR_1;
+			mapRequestTileDraw(sSpikeCoord.ubX, sSpikeCoord.ubY);
+			g_sCurrentLevel.pTiles[sSpikeCoord.ubX][sSpikeCoord.ubY - 1] = TILE_SPIKES_ON_BG;
+			g_sCurrentLevel.pVisTiles[sSpikeCoord.ubX][sSpikeCoord.ubY - 1] = VIS_TILE_SPIKES_ON_BG_1;
+			mapRequestTileDraw(sSpikeCoord.ubX, sSpikeCoord.ubY - 1);
 		}
-		else {
-			for(UBYTE i = 0; i < g_sCurrentLevel.ubSpikeTilesCount; ++i) {
-				tUbCoordYX sSpikeCoord = g_sCurrentLevel.pSpikeTiles[i];
-				g_sCurrentLevel.pTiles[sSpikeCoord.ubX][sSpikeCoord.ubY] = TILE_SPIKES_OFF_FLOOR;
-				g_sCurrentLevel.pVisTiles[sSpikeCoord.ubX][sSpikeCoord.ubY] = VIS_TILE_SPIKES_OFF_FLOOR_1;
-				mapRequestTileDraw(sSpikeCoord.ubX, sSpikeCoord.ubY);
-				g_sCurrentLevel.pTiles[sSpikeCoord.ubX][sSpikeCoord.ubY - 1] = TILE_SPIKES_OFF_BG;
-				g_sCurrentLevel.pVisTiles[sSpikeCoord.ubX][sSpikeCoord.ubY - 1] = VIS_TILE_SPIKES_OFF_BG_1;
-				mapRequestTileDraw(sSpikeCoord.ubX, sSpikeCoord.ubY - 1);
-			}
+	}
+	else {
+		for(UBYTE i = 0; i < g_sCurrentLevel.ubSpikeTilesCount; ++i) {
+			tUbCoordYX sSpikeCoord = g_sCurrentLevel.pSpikeTiles[i];
+			g_sCurrentLevel.pTiles[sSpikeCoord.ubX][sSpikeCoord.ubY] = TILE_SPIKES_OFF_FLOOR;
+			g_sCurrentLevel.pVisTiles[sSpikeCoord.ubX][sSpikeCoord.ubY] = VIS_TILE_SPIKES_OFF_FLOOR_1;
+			mapRequestTileDraw(sSpikeCoord.ubX, sSpikeCoord.ubY);
+			g_sCurrentLevel.pTiles[sSpikeCoord.ubX][sSpikeCoord.ubY - 1] = TILE_SPIKES_OFF_BG;
+			g_sCurrentLevel.pVisTiles[sSpikeCoord.ubX][sSpikeCoord.ubY - 1] = VIS_TILE_SPIKES_OFF_BG_1;
+			mapRequestTileDraw(sSpikeCoord.ubX, sSpikeCoord.ubY - 1);
 		}
-		s_uwSpikeCooldown = MAP_SPIKES_COOLDOWN;
-		return 1;
 	}
-	return 0;
+}
+
+static void mapDrawPendingSlipgate(void) {
+	gameDrawSlipgate(s_ubPendingSlipgateOpenIndex);
+	if(--s_ubPendingSlipgateDraws == 0) {
+		s_ubPendingSlipgateOpenIndex = MAP_PENDING_SLIPGATE_OPEN_INVALID;
+	}
 }
 
 static void mapDrawPendingTiles(void) {
@@ -255,31 +441,31 @@ static void mapDrawPendingTiles(void) {
 	s_pDirtyTileCounts[s_ubCurrentDirtyList] = 0;
 }
 
+static void mapProcessLevelPrefetch(void);
+
+static void mapRegisterJobs(void) {
+	// Registration order is priority order. Draws go last, so that tiles
+	// changed by other jobs are drawn on the same frame. Interactions, spikes
+	// and turrets affect gameplay timing, so they can't depend on render load.
+	jobSchedulerReset();
+	s_ubJobInteractions = jobSchedulerRegister("interactions", mapProcessInteractions, JOB_PRIORITY_MANDATORY);
+	s_ubJobSpikes = jobSchedulerRegister("spikes", mapProcessSpikes, JOB_PRIORITY_MANDATORY);
+	s_ubJobTurrets = jobSchedulerRegister("turrets", mapProcessNextTurret, JOB_PRIORITY_MANDATORY);
+	s_ubJobDirtyTiles = jobSchedulerRegister("dirty tiles", mapDrawPendingTiles, JOB_PRIORITY_MANDATORY);
+	s_ubJobSlipgateDraw = jobSchedulerRegister("slipgate draw", mapDrawPendingSlipgate, JOB_PRIORITY_MANDATORY);
+	// Disk reads can take arbitrarily long, so they're done only in spare time
+	s_ubJobLevelPrefetch = jobSchedulerRegister("level prefetch", mapProcessLevelPrefetch, JOB_PRIORITY_IDLE);
+}
+
 static void mapInitTurret(tTurret *pTurret) {
 		pTurret->isActive = 1;
 		pTurret->isInAttackFrame = 1;
-		pTurret->ubLastAttackFrame = 0;
-
-		UBYTE ubLeftTileX = pTurret->sTilePos.ubX;
-		for(UBYTE i = 0; i < MAP_TURRET_TILE_RANGE; ++i) {
-			if(mapIsCollidingWithPortalProjectilesAt(ubLeftTileX - 1, pTurret->sTilePos.ubY)) {
-				break;
-			}
-			--ubLeftTileX;
-		}
-
-		UBYTE ubRightTileX = pTurret->sTilePos.ubX + 1;
-		for(UBYTE i = 0; i < MAP_TURRET_TILE_RANGE; ++i) {
-			if(mapIsCollidingWithPortalProjectilesAt(ubRightTileX, pTurret->sTilePos.ubY)) {
-				break;
-			}
-			++ubRightTileX;
-		}
-
-		pTurret->sScanTopLeft.uwX = ubLeftTileX * MAP_TILE_SIZE;
-		pTurret->sScanTopLeft.uwY = pTurret->sTilePos.ubY * MAP_TILE_SIZE;
-		pTurret->sScanBottomRight.uwX = ubRightTileX * MAP_TILE_SIZE;
-		pTurret->sScanBottomRight.uwY = (pTurret->sTilePos.ubY + 1) * MAP_TILE_SIZE;
+		pTurret->isReadyToAttack = 0;
+		timerWheelSchedule(
+			&pTurret->sAttackTimer, MAP_TURRET_ATTACK_FRAME_COOLDOWN,
+			mapOnTurretAttackFrameEnd, pTurret
+		);
+		mapTurretCalculateScanRange(pTurret);
 
 		// if(pTurret->sScanBottomRight.uwX - pTurret->sScanTopLeft.uwX != 0) {
 		// 	tSimpleBufferManager *pBuffer = gameGetBuffer();
@@ -292,786 +478,470 @@ static void mapInitTurret(tTurret *pTurret) {
 		// }
 }
 
-static tNeighborFlag mapGetWallNeighborsOnLevel(
-	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY
-) {
-	tNeighborFlag eNeighbors = 0;
-	if(mapTileIsOnWall(pLevel->pTiles[ubTileX - 1][ubTileY])) {
-		eNeighbors |= NEIGHBOR_FLAG_W;
-	}
-	if(mapTileIsOnWall(pLevel->pTiles[ubTileX + 1][ubTileY])) {
-		eNeighbors |= NEIGHBOR_FLAG_E;
-	}
-	if(mapTileIsOnWall(pLevel->pTiles[ubTileX - 1][ubTileY - 1])) {
-		eNeighbors |= NEIGHBOR_FLAG_NW;
-	}
-	if(mapTileIsOnWall(pLevel->pTiles[ubTileX + 1][ubTileY - 1])) {
-		eNeighbors |= NEIGHBOR_FLAG_NE;
-	}
-	if(mapTileIsOnWall(pLevel->pTiles[ubTileX - 1][ubTileY + 1])) {
-		eNeighbors |= NEIGHBOR_FLAG_SW;
-	}
-	if(mapTileIsOnWall(pLevel->pTiles[ubTileX + 1][ubTileY + 1])) {
-		eNeighbors |= NEIGHBOR_FLAG_SE;
-	}
-	if(mapTileIsOnWall(pLevel->pTiles[ubTileX][ubTileY - 1])) {
-		eNeighbors |= NEIGHBOR_FLAG_N;
-	}
-	if(mapTileIsOnWall(pLevel->pTiles[ubTileX][ubTileY + 1])) {
-		eNeighbors |= NEIGHBOR_FLAG_S;
-	}
+static UWORD mapUnpackUword(const UBYTE **ppData) {
+	const UBYTE *pData = *ppData;
+	*ppData += sizeof(UWORD);
+	return (pData[0] << 8) | pData[1];
+}
+
+static ULONG mapUnpackUlong(const UBYTE **ppData) {
+	ULONG ulHi = mapUnpackUword(ppData);
+	return (ulHi << 16) | mapUnpackUword(ppData);
+}
+
+static void mapPackUword(UBYTE **ppData, UWORD uwValue) {
+	UBYTE *pData = *ppData;
+	pData[0] = uwValue >> 8;
+	pData[1] = uwValue;
+	*ppData += sizeof(UWORD);
+}
 
-	return eNeighbors;
+static void mapPackUlong(UBYTE **ppData, ULONG ulValue) {
+	mapPackUword(ppData, ulValue >> 16);
+	mapPackUword(ppData, ulValue);
 }
 
+static void mapLoadTileCode(UBYTE ubX, UBYTE ubY, UWORD uwTileCode) {
+	s_sLoadedLevel.pTiles[ubX][ubY] = uwTileCode;
+	if(uwTileCode == TILE_BOUNCER_SPAWNER) {
+		if(s_sLoadedLevel.ubBouncerSpawnerTileX != BOUNCER_TILE_INVALID) {
+			logWrite(
+				"ERR: More than one bouncer spawner on map, previous on %hhu, %hhu\n",
+				s_sLoadedLevel.ubBouncerSpawnerTileX, s_sLoadedLevel.ubBouncerSpawnerTileY
+			);
+		}
+		s_sLoadedLevel.ubBouncerSpawnerTileX = ubX;
+		s_sLoadedLevel.ubBouncerSpawnerTileY = ubY;
+	}
+}
 
-static tVisTile mapCalculateVisTileForGatewayWallTiles(
-	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
-	tTile eTile, tVisTile eVisTileFirst
+static UWORD mapGetLevelPayloadSize(
+	const UBYTE *pTargetCounts, UBYTE ubBoxCount, UBYTE ubSpikeTilesCount,
+	UBYTE ubTurretCount, UBYTE ubStoryTextLength
 ) {
-	tTile eTileLeft = pLevel->pTiles[ubTileX - 1][ubTileY];
-	tTile eTileRight = pLevel->pTiles[ubTileX + 1][ubTileY];
-	tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
-	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+	UWORD uwSize = 2 * MAP_LEVEL_PLANE_SIZE;
+	for(UBYTE i = 0; i < MAP_INTERACTIONS_MAX; ++i) {
+		uwSize += MAP_LEVEL_INTERACTION_SIZE + pTargetCounts[i] * MAP_LEVEL_TARGET_SIZE;
+	}
+	uwSize += ubBoxCount * MAP_LEVEL_BOX_SIZE;
+	uwSize += ubSpikeTilesCount * MAP_LEVEL_SPIKE_SIZE;
+	uwSize += ubTurretCount * MAP_LEVEL_TURRET_SIZE;
+	uwSize += ubStoryTextLength;
+	return uwSize;
+}
+
+static UBYTE mapLoadLevelV1(tFile *pFile) {
+	fileRead(pFile, &s_sLoadedLevel.sSpawnPos.fX, sizeof(s_sLoadedLevel.sSpawnPos.fX));
+	fileRead(pFile, &s_sLoadedLevel.sSpawnPos.fY, sizeof(s_sLoadedLevel.sSpawnPos.fY));
 
-	if(eTileAbove == eTile) {
-		return (eVisTileFirst + (
-			(ubTileX < MAP_TILE_WIDTH / 2) ?
-			VIS_TILE_DOOR_LEFT_CLOSED_WALL_BOTTOM :
-			VIS_TILE_DOOR_RIGHT_CLOSED_WALL_BOTTOM
-		) - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP);
+	for(UBYTE ubInteractionIndex = 0; ubInteractionIndex < MAP_INTERACTIONS_MAX; ++ubInteractionIndex) {
+		tInteraction *pInteraction = &s_pInteractions[ubInteractionIndex];
+		fileRead(pFile, &pInteraction->ubTargetCount, sizeof(pInteraction->ubTargetCount));
+		fileRead(pFile, &pInteraction->uwButtonMask, sizeof(pInteraction->uwButtonMask));
+		fileRead(pFile, &pInteraction->wasActive, sizeof(pInteraction->wasActive));
+		pInteraction->wasActive = 0;
+		for(UBYTE ubTargetIndex = 0; ubTargetIndex < pInteraction->ubTargetCount; ++ubTargetIndex) {
+			tTogglableTile *pTargetTile = &pInteraction->pTargetTiles[ubTargetIndex];
+			fileRead(pFile, &pTargetTile->eKind, sizeof(pTargetTile->eKind));
+			fileRead(pFile, &pTargetTile->eTileActive, sizeof(pTargetTile->eTileActive));
+			fileRead(pFile, &pTargetTile->eTileInactive, sizeof(pTargetTile->eTileInactive));
+			fileRead(pFile, &pTargetTile->eVisTileActive, sizeof(pTargetTile->eVisTileActive));
+			fileRead(pFile, &pTargetTile->eVisTileInactive, sizeof(pTargetTile->eVisTileInactive));
+			fileRead(pFile, &pTargetTile->sPos.uwYX, sizeof(pTargetTile->sPos.uwYX));
+		}
 	}
-	if(eTileBelow == eTile) {
-		return (eVisTileFirst + (
-			(ubTileX < MAP_TILE_WIDTH / 2) ?
-			VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP :
-			VIS_TILE_DOOR_RIGHT_CLOSED_WALL_TOP
-		) - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP);
+
+	fileRead(pFile, &s_sLoadedLevel.ubBoxCount, sizeof(s_sLoadedLevel.ubBoxCount));
+	for(UBYTE i = 0; i < s_sLoadedLevel.ubBoxCount; ++i) {
+		fileRead(pFile, &s_sLoadedLevel.pBoxSpawns[i].fX, sizeof(s_sLoadedLevel.pBoxSpawns[i].fX));
+		fileRead(pFile, &s_sLoadedLevel.pBoxSpawns[i].fY, sizeof(s_sLoadedLevel.pBoxSpawns[i].fY));
 	}
-	if(eTileLeft == eTile) {
-		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_WALL_RIGHT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+
+	fileRead(pFile, &s_sLoadedLevel.ubSpikeTilesCount, sizeof(s_sLoadedLevel.ubSpikeTilesCount));
+	for(UBYTE i = 0; i < s_sLoadedLevel.ubSpikeTilesCount; ++i) {
+		fileRead(pFile, &s_sLoadedLevel.pSpikeTiles[i].uwYX, sizeof(s_sLoadedLevel.pSpikeTiles[i].uwYX));
 	}
-	if(eTileRight == eTile) {
-		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_WALL_LEFT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+
+	fileRead(pFile, &s_sLoadedLevel.ubTurretCount, sizeof(s_sLoadedLevel.ubTurretCount));
+	for(UBYTE i = 0; i < s_sLoadedLevel.ubTurretCount; ++i) {
+		fileRead(pFile, &s_sLoadedLevel.pTurretSpawns[i].sTilePos.uwYX, sizeof(s_sLoadedLevel.pTurretSpawns[i].sTilePos.uwYX));
 	}
 
-	return VIS_TILE_BG_1;
-}
+	UBYTE ubStoryTextLength;
+	fileRead(pFile, &ubStoryTextLength, sizeof(ubStoryTextLength));
+	if(ubStoryTextLength) {
+		fileRead(pFile, s_sLoadedLevel.szStoryText, ubStoryTextLength);
+		s_sLoadedLevel.szStoryText[ubStoryTextLength] = '\0';
+	}
 
-static tVisTile mapCalculateVisTileForGatewayBgTiles(
-	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
-	tTile eTile, tVisTile eVisTileFirst
-) {
-	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+	UBYTE ubReservedCount1;
+	fileRead(pFile, &ubReservedCount1, sizeof(ubReservedCount1));
 
-	if(eTileBelow == eTile) {
-		if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] != eTile) {
-			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_LEFT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	UBYTE ubReservedCount2;
+	fileRead(pFile, &ubReservedCount2, sizeof(ubReservedCount2));
+
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			UWORD uwTileCode;
+			fileRead(pFile, &uwTileCode, sizeof(uwTileCode));
+			mapLoadTileCode(ubX, ubY, uwTileCode);
 		}
-		if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] != eTile) {
-			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_RIGHT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	}
+
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			UWORD uwVisTileCode;
+			fileRead(pFile, &uwVisTileCode, sizeof(uwVisTileCode));
+			s_sLoadedLevel.pVisTiles[ubX][ubY] = uwVisTileCode;
 		}
-		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
 	}
-	return VIS_TILE_BG_1;
+	return 1;
 }
 
-static tVisTile mapCalculateVisTileForGatewayFrontTiles(
-	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
-	tTile eTile, tVisTile eVisTileFirst
-) {
-	tTile eTileLeft = pLevel->pTiles[ubTileX - 1][ubTileY];
-	tTile eTileRight = pLevel->pTiles[ubTileX + 1][ubTileY];
-	tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
-	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
-
-	if(eTileLeft == eTile || eTileRight == eTile) {
-		// Horizontal gateway
-		if(eTileLeft != eTile) {
-			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_LEFT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
-		}
-		if(eTileRight != eTile) {
-			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_RIGHT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
-		}
-		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+static UBYTE mapReadLevelHeader(const UBYTE *pHeader, tLevelHeader *pLevelHeader) {
+	if(memcmp(pHeader, s_pLevelMagic, sizeof(s_pLevelMagic))) {
+		return 0;
 	}
-	else {
-		// Vertical gateway
-		if(ubTileX < MAP_TILE_WIDTH / 2) {
-			if(eTileAbove != eTile) {
-				return eVisTileFirst + VIS_TILE_DOOR_LEFT_CLOSED_TOP - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
-			}
-			if(eTileBelow != eTile) {
-				return eVisTileFirst + VIS_TILE_DOOR_LEFT_CLOSED_BOTTOM - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
-			}
-			return eVisTileFirst + VIS_TILE_DOOR_LEFT_CLOSED_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
-		}
-		else {
-			if(eTileAbove != eTile) {
-				return eVisTileFirst + VIS_TILE_DOOR_RIGHT_CLOSED_TOP - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
-			}
-			if(eTileBelow != eTile) {
-				return eVisTileFirst + VIS_TILE_DOOR_RIGHT_CLOSED_BOTTOM - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
-			}
-			return eVisTileFirst + VIS_TILE_DOOR_RIGHT_CLOSED_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	const UBYTE *pData = &pHeader[sizeof(s_pLevelMagic)];
+	UBYTE ubVersion = *(pData++);
+	if(ubVersion != MAP_LEVEL_VERSION) {
+		logWrite("ERR: Unsupported level version: %hhu\n", ubVersion);
+		return 0;
+	}
+	pLevelHeader->ubStoryTextLength = *(pData++);
+	pLevelHeader->uwPayloadSize = mapUnpackUword(&pData);
+	pLevelHeader->sSpawnPos.fX = mapUnpackUlong(&pData);
+	pLevelHeader->sSpawnPos.fY = mapUnpackUlong(&pData);
+	pLevelHeader->pTargetCounts = pData;
+	pData += MAP_INTERACTIONS_MAX;
+	pLevelHeader->ubBoxCount = *(pData++);
+	pLevelHeader->ubSpikeTilesCount = *(pData++);
+	pLevelHeader->ubTurretCount = *(pData++);
+	UBYTE ubFlags = *(pData++);
+	pLevelHeader->uwStoredSize = mapUnpackUword(&pData);
+	pLevelHeader->isPacked = (ubFlags & MAP_LEVEL_FLAG_PACKED_PLANES) != 0;
+	if(!pLevelHeader->isPacked) {
+		pLevelHeader->uwStoredSize = pLevelHeader->uwPayloadSize;
+	}
+
+	UBYTE isValid = (
+		pLevelHeader->ubBoxCount <= MAP_BOXES_MAX &&
+		pLevelHeader->ubSpikeTilesCount <= MAP_SPIKES_TILES_MAX &&
+		pLevelHeader->ubTurretCount <= MAP_TURRETS_MAX &&
+		pLevelHeader->ubStoryTextLength < MAP_STORY_TEXT_MAX
+	);
+	for(UBYTE i = 0; i < MAP_INTERACTIONS_MAX; ++i) {
+		if(pLevelHeader->pTargetCounts[i] > INTERACTION_TARGET_MAX) {
+			isValid = 0;
 		}
 	}
+	if(!isValid || pLevelHeader->uwPayloadSize != mapGetLevelPayloadSize(
+		pLevelHeader->pTargetCounts, pLevelHeader->ubBoxCount,
+		pLevelHeader->ubSpikeTilesCount, pLevelHeader->ubTurretCount,
+		pLevelHeader->ubStoryTextLength
+	) || pLevelHeader->uwStoredSize > pLevelHeader->uwPayloadSize) {
+		logWrite("ERR: Malformed level header\n");
+		return 0;
+	}
 
-	return VIS_TILE_BG_1;
+	// Stored data goes to the end of buffer so that packed planes may be
+	// unpacked in place
+	pLevelHeader->uwBufferSize = pLevelHeader->uwPayloadSize + (
+		pLevelHeader->isPacked ? PLANE_RLE_UNPACK_MARGIN : 0
+	);
+	return 1;
 }
 
-static tVisTile mapCalculateVisTileOnLevel(
-	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY
+static UBYTE *mapGetLevelStoredData(
+	const tLevelHeader *pLevelHeader, UBYTE *pBuffer
 ) {
-	if(
-		ubTileX == 0 || ubTileX == MAP_TILE_WIDTH - 1 ||
-		ubTileY == 0 || ubTileY == MAP_TILE_HEIGHT - 1
-	) {
-		return VIS_TILE_WALL_1;
-	}
-
-	tNeighborFlag eNeighbors = mapGetWallNeighborsOnLevel(pLevel, ubTileX, ubTileY);
-	tTile eTile = pLevel->pTiles[ubTileX][ubTileY];
-	tTile eTileLeft = pLevel->pTiles[ubTileX - 1][ubTileY];
-	tTile eTileRight = pLevel->pTiles[ubTileX + 1][ubTileY];
-	tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
-	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
-	switch(eTile) {
-		case TILE_DOOR_CLOSED:
-		case TILE_DOOR_OPEN:
-		case TILE_GRATE:
-		case TILE_DEATH_FIELD:
-			for(UBYTE i = 0; i < MAP_GATEWAY_KIND_COUNT; ++i) {
-				if(s_pGatewayKinds[i].eTileFront == eTile) {
-					return mapCalculateVisTileForGatewayFrontTiles(
-						pLevel, ubTileX, ubTileY, eTile, s_pGatewayKinds[i].eVisTileFirst
-					);
-				}
-			}
-			break;
-		case TILE_BOUNCER_SPAWNER:
-			if((eNeighbors & NEIGHBOR_FLAG_S) == 0) {
-				return VIS_TILE_BOUNCER_SPAWNER_WALL_DOWN;
-			}
-			if((eNeighbors & NEIGHBOR_FLAG_N) == 0) {
-				return VIS_TILE_BOUNCER_SPAWNER_WALL_UP;
-			}
-			if((eNeighbors & NEIGHBOR_FLAG_E) == 0) {
-				return VIS_TILE_BOUNCER_SPAWNER_WALL_RIGHT;
-			}
-			if((eNeighbors & NEIGHBOR_FLAG_W) == 0) {
-				return VIS_TILE_BOUNCER_SPAWNER_WALL_LEFT;
-			}
-			break;
-		case TILE_RECEIVER:
-			if((eNeighbors & NEIGHBOR_FLAG_S) == 0) {
-				return VIS_TILE_RECEIVER_WALL_DOWN;
-			}
-			if((eNeighbors & NEIGHBOR_FLAG_N) == 0) {
-				return VIS_TILE_RECEIVER_WALL_UP;
-			}
-			if((eNeighbors & NEIGHBOR_FLAG_E) == 0) {
-				return VIS_TILE_RECEIVER_WALL_RIGHT;
-			}
-			if((eNeighbors & NEIGHBOR_FLAG_W) == 0) {
-				return VIS_TILE_RECEIVER_WALL_LEFT;
-			}
-			break;
-		case TILE_PIPE:
-			if(
-				eTileAbove == TILE_PIPE && eTileBelow == TILE_PIPE &&
-				eTileLeft == TILE_PIPE && eTileRight == TILE_PIPE
-			) {
-				return VIS_TILE_PIPE_NESW;
-			}
-			if(eTileAbove == TILE_PIPE && eTileBelow == TILE_PIPE) {
-				return VIS_TILE_PIPE_NS;
-			}
-			if(eTileLeft == TILE_PIPE && eTileRight == TILE_PIPE) {
-				return VIS_TILE_PIPE_EW;
-			}
-			if(eTileAbove == TILE_PIPE) {
-				if(eTileLeft == TILE_WALL_BLOCKED) {
-					return VIS_TILE_BLOCKED_WALL_PIPE_S;
-				}
-				return VIS_TILE_WALL_PIPE_S;
-			}
-			if(eTileBelow == TILE_PIPE) {
-				if(eTileLeft == TILE_WALL_BLOCKED) {
-					return VIS_TILE_BLOCKED_WALL_PIPE_N;
-				}
-				return VIS_TILE_WALL_PIPE_N;
-			}
-			if(eTileLeft == TILE_PIPE) {
-				if(eTileBelow == TILE_WALL_BLOCKED) {
-					return VIS_TILE_BLOCKED_WALL_PIPE_E;
-				}
-				return VIS_TILE_WALL_PIPE_E;
-			}
-			if(eTileRight == TILE_PIPE) {
-				if(eTileBelow == TILE_WALL_BLOCKED) {
-					return VIS_TILE_BLOCKED_WALL_PIPE_W;
-				}
-				return VIS_TILE_WALL_PIPE_W;
-			}
-			break;
-		case TILE_BUTTON_A:
-		case TILE_BUTTON_B:
-		case TILE_BUTTON_C:
-		case TILE_BUTTON_D:
-		case TILE_BUTTON_E:
-		case TILE_BUTTON_F:
-		case TILE_BUTTON_G:
-		case TILE_BUTTON_H:
-			if(ubTileX < MAP_TILE_WIDTH / 2) {
-				if(pLevel->pTiles[ubTileX + 1][ubTileY] == eTile) {
-					return VIS_TILE_BUTTON_WALL_LEFT_1;
-				}
-				return VIS_TILE_BUTTON_WALL_LEFT_2;
-			}
-			else {
-				if(pLevel->pTiles[ubTileX + 1][ubTileY] == eTile) {
-					return VIS_TILE_BUTTON_WALL_RIGHT_1;
-				}
-				return VIS_TILE_BUTTON_WALL_RIGHT_2;
-			}
-			break;
-		case TILE_EXIT:
-		case TILE_EXIT_HUB: {
-			tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
-			tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
-			if(ubTileX < MAP_TILE_WIDTH / 2) {
-				if(eTileAbove != eTile) {
-					return VIS_TILE_EXIT_WALL_LEFT_TOP;
-				}
-				if(eTileBelow != eTile) {
-					return VIS_TILE_EXIT_WALL_LEFT_BOTTOM;
-				}
-				return VIS_TILE_EXIT_WALL_LEFT_MID;
-			}
-			else {
-				if(eTileAbove != eTile) {
-					return VIS_TILE_EXIT_WALL_RIGHT_TOP;
-				}
-				if(eTileBelow != eTile) {
-					return VIS_TILE_EXIT_WALL_RIGHT_BOTTOM;
-				}
-				return VIS_TILE_EXIT_WALL_RIGHT_MID;
-			}
-		} break;
-		case TILE_WALL:
-		case TILE_WALL_BLOCKED: {
-			for(UBYTE i = 0; i < MAP_GATEWAY_KIND_COUNT; ++i) {
-				tVisTile eVisTile = mapCalculateVisTileForGatewayWallTiles(
-					pLevel, ubTileX, ubTileY,
-					s_pGatewayKinds[i].eTileFront, s_pGatewayKinds[i].eVisTileFirst
-				);
-				if(eVisTile != VIS_TILE_BG_1) {
-					return eVisTile;
-				}
-			}
-
-			static const UBYTE pWallLookup[256] = {
-				0,
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_WALL_CONVEX_N,
-				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_WALL_CONVEX_NE,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONVEX_E,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONVEX_SE,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONVEX_S,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E] = VIS_TILE_WALL_CONVEX_SW,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_WALL_CONVEX_W,
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_WALL_CONVEX_NW,
-				[255] = VIS_TILE_WALL_1,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_N,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_N,
-
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_NE,
-
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_E,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_WALL_CONCAVE_E,
-
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_WALL_CONCAVE_SE,
+	return &pBuffer[pLevelHeader->uwBufferSize - pLevelHeader->uwStoredSize];
+}
 
-				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_WALL_CONCAVE_S,
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_S,
+static UBYTE mapParseLevel(const tLevelHeader *pLevelHeader, UBYTE *pBuffer) {
+	// Sections past planes are never packed
+	const UBYTE *pSections = &pBuffer[
+		pLevelHeader->uwBufferSize -
+		(pLevelHeader->uwPayloadSize - 2 * MAP_LEVEL_PLANE_SIZE)
+	];
+	const UBYTE *pData = mapGetLevelStoredData(pLevelHeader, pBuffer);
+	if(pLevelHeader->isPacked) {
+		const UBYTE *pPackedEnd = planeRleUnpack(
+			pData, pSections, pBuffer, 2 * MAP_LEVEL_PLANE_SIZE
+		);
+		if(pPackedEnd != pSections) {
+			logWrite("ERR: Malformed packed level planes\n");
+			return 0;
+		}
+		pData = pBuffer;
+	}
 
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N] = VIS_TILE_WALL_CONCAVE_SW,
+	s_sLoadedLevel.sSpawnPos = pLevelHeader->sSpawnPos;
+	s_sLoadedLevel.ubBoxCount = pLevelHeader->ubBoxCount;
+	s_sLoadedLevel.ubSpikeTilesCount = pLevelHeader->ubSpikeTilesCount;
+	s_sLoadedLevel.ubTurretCount = pLevelHeader->ubTurretCount;
 
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N] = VIS_TILE_WALL_CONCAVE_W,
-				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE] = VIS_TILE_WALL_CONCAVE_W,
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			mapLoadTileCode(ubX, ubY, mapUnpackUword(&pData));
+		}
+	}
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			s_sLoadedLevel.pVisTiles[ubX][ubY] = mapUnpackUword(&pData);
+		}
+	}
+	pData = pSections;
 
-				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E] = VIS_TILE_WALL_CONCAVE_NW,
-			};
-			if(pWallLookup[eNeighbors] != 0) {
-				if(eTile == TILE_WALL_BLOCKED) {
-					return pWallLookup[eNeighbors] + VIS_TILE_BLOCKED_WALL_CONVEX_N - VIS_TILE_WALL_CONVEX_N;
-				}
-				return pWallLookup[eNeighbors];
-			}
+	for(UBYTE ubInteractionIndex = 0; ubInteractionIndex < MAP_INTERACTIONS_MAX; ++ubInteractionIndex) {
+		tInteraction *pInteraction = &s_pInteractions[ubInteractionIndex];
+		pInteraction->ubTargetCount = pLevelHeader->pTargetCounts[ubInteractionIndex];
+		pInteraction->uwButtonMask = mapUnpackUword(&pData);
+		pInteraction->wasActive = 0;
+		for(UBYTE ubTargetIndex = 0; ubTargetIndex < pInteraction->ubTargetCount; ++ubTargetIndex) {
+			tTogglableTile *pTargetTile = &pInteraction->pTargetTiles[ubTargetIndex];
+			pTargetTile->sPos.uwYX = mapUnpackUword(&pData);
+			pTargetTile->eKind = mapUnpackUword(&pData);
+			pTargetTile->eTileActive = mapUnpackUword(&pData);
+			pTargetTile->eTileInactive = mapUnpackUword(&pData);
+			pTargetTile->eVisTileActive = mapUnpackUword(&pData);
+			pTargetTile->eVisTileInactive = mapUnpackUword(&pData);
+		}
+	}
 
-			logWrite("Unhandled tile at %hhu,%hhu", ubTileX, ubTileY);
-		} break;
-		case TILE_BG: {
-			if(eTileAbove == TILE_BOUNCER_SPAWNER) {
-				return VIS_TILE_BOUNCER_SPAWNER_BG_DOWN;
-			}
-			if(eTileBelow == TILE_BOUNCER_SPAWNER) {
-				return VIS_TILE_BOUNCER_SPAWNER_BG_UP;
-			}
-			if(eTileLeft == TILE_BOUNCER_SPAWNER) {
-				return VIS_TILE_BOUNCER_SPAWNER_BG_RIGHT;
-			}
-			if(eTileRight == TILE_BOUNCER_SPAWNER) {
-				return VIS_TILE_BOUNCER_SPAWNER_BG_LEFT;
-			}
-			if(eTileAbove == TILE_RECEIVER) {
-				return VIS_TILE_RECEIVER_BG_DOWN;
-			}
-			if(eTileBelow == TILE_RECEIVER) {
-				return VIS_TILE_RECEIVER_BG_UP;
-			}
-			if(eTileLeft == TILE_RECEIVER) {
-				return VIS_TILE_RECEIVER_BG_RIGHT;
-			}
-			if(eTileRight == TILE_RECEIVER) {
-				return VIS_TILE_RECEIVER_BG_LEFT;
-			}
-			if(eTileAbove == TILE_PIPE) {
-				if(pLevel->pTiles[ubTileX - 1][ubTileY - 1] == TILE_WALL_BLOCKED) {
-					return VIS_TILE_BLOCKED_BG_PIPE_S;
-				}
-				return VIS_TILE_BG_PIPE_S;
-			}
-			if(eTileBelow == TILE_PIPE) {
-				if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
-					return VIS_TILE_BLOCKED_BG_PIPE_N;
-				}
-				return VIS_TILE_BG_PIPE_N;
-			}
-			if(eTileLeft == TILE_PIPE) {
-				if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
-					return VIS_TILE_BLOCKED_BG_PIPE_E;
-				}
-				return VIS_TILE_BG_PIPE_E;
-			}
-			if(eTileRight == TILE_PIPE) {
-				if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
-					return VIS_TILE_BLOCKED_BG_PIPE_W;
-				}
-				return VIS_TILE_BG_PIPE_W;
-			}
-			if(mapTileIsExit(eTileLeft)) {
-				if(!mapTileIsExit(pLevel->pTiles[ubTileX - 1][ubTileY - 1])) {
-					return VIS_TILE_EXIT_BG_LEFT_TOP;
-				}
-				if(!mapTileIsExit(pLevel->pTiles[ubTileX - 1][ubTileY + 1])) {
-					return VIS_TILE_EXIT_BG_LEFT_BOTTOM;
-				}
-				return VIS_TILE_EXIT_BG_LEFT_MID;
-			}
-			if(mapTileIsExit(eTileRight)) {
-				if(!mapTileIsExit(pLevel->pTiles[ubTileX + 1][ubTileY - 1])) {
-					return VIS_TILE_EXIT_BG_RIGHT_TOP;
-				}
-				if(!mapTileIsExit(pLevel->pTiles[ubTileX + 1][ubTileY + 1])) {
-					return VIS_TILE_EXIT_BG_RIGHT_BOTTOM;
-				}
-				return VIS_TILE_EXIT_BG_RIGHT_MID;
-			}
+	for(UBYTE i = 0; i < s_sLoadedLevel.ubBoxCount; ++i) {
+		s_sLoadedLevel.pBoxSpawns[i].fX = mapUnpackUlong(&pData);
+		s_sLoadedLevel.pBoxSpawns[i].fY = mapUnpackUlong(&pData);
+	}
+	for(UBYTE i = 0; i < s_sLoadedLevel.ubSpikeTilesCount; ++i) {
+		s_sLoadedLevel.pSpikeTiles[i].uwYX = mapUnpackUword(&pData);
+	}
+	for(UBYTE i = 0; i < s_sLoadedLevel.ubTurretCount; ++i) {
+		s_sLoadedLevel.pTurretSpawns[i].sTilePos.uwYX = mapUnpackUword(&pData);
+	}
+	memcpy(s_sLoadedLevel.szStoryText, pData, pLevelHeader->ubStoryTextLength);
+	s_sLoadedLevel.szStoryText[pLevelHeader->ubStoryTextLength] = '\0';
+	return 1;
+}
 
-			for(UBYTE i = 0; i < MAP_GATEWAY_KIND_COUNT; ++i) {
-				tVisTile eVisTile = mapCalculateVisTileForGatewayBgTiles(
-					pLevel, ubTileX, ubTileY,
-					s_pGatewayKinds[i].eTileFront, s_pGatewayKinds[i].eVisTileFirst
-				);
-				if(eVisTile != VIS_TILE_BG_1) {
-					return eVisTile;
-				}
-			}
+static UBYTE mapLoadLevelV2(tFile *pFile, const UBYTE *pHeader) {
+	tLevelHeader sLevelHeader;
+	if(!mapReadLevelHeader(pHeader, &sLevelHeader)) {
+		return 0;
+	}
 
-			if(mapTileIsButton(eTileBelow)) {
-				if(ubTileX < MAP_TILE_WIDTH / 2) {
-					if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == eTileBelow) {
-						return VIS_TILE_BUTTON_BG_LEFT_1;
-					}
-					return VIS_TILE_BUTTON_BG_LEFT_2;
-				}
-				else {
-					if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == eTileBelow) {
-						return VIS_TILE_BUTTON_BG_RIGHT_1;
-					}
-					return VIS_TILE_BUTTON_BG_RIGHT_2;
-				}
-			}
+	// Everything past header in one go
+	UBYTE *pBuffer = memAllocFast(sLevelHeader.uwBufferSize);
+	UBYTE isLoaded = 0;
+	UBYTE *pStored = mapGetLevelStoredData(&sLevelHeader, pBuffer);
+	if(fileRead(pFile, pStored, sLevelHeader.uwStoredSize) != sLevelHeader.uwStoredSize) {
+		logWrite("ERR: Level file truncated\n");
+	}
+	else {
+		isLoaded = mapParseLevel(&sLevelHeader, pBuffer);
+	}
+	memFree(pBuffer, sLevelHeader.uwBufferSize);
+	return isLoaded;
+}
 
-			static const UBYTE pBgLookup[256] = {
-				0,
-
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONVEX_N,
-				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONVEX_N,
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_BG_CONVEX_N,
-				[NEIGHBOR_FLAG_S] = VIS_TILE_BG_CONVEX_N,
-
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONCAVE_NE,
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONCAVE_NE,
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONCAVE_NE,
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONCAVE_NE,
-
-				[NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_E,
-				[NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_E,
-				[NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_BG_CONVEX_E,
-				[NEIGHBOR_FLAG_W] = VIS_TILE_BG_CONVEX_E,
-
-				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONCAVE_SE,
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONCAVE_SE,
-				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_BG_CONCAVE_SE,
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_BG_CONCAVE_SE,
-
-				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_S,
-				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_S,
-				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONVEX_S,
-				[NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONVEX_S,
-
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONCAVE_SW,
-				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONCAVE_SW,
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_BG_CONCAVE_SW,
-				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_BG_CONCAVE_SW,
-
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONVEX_W,
-				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONVEX_W,
-				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_E] = VIS_TILE_BG_CONVEX_W,
-				[NEIGHBOR_FLAG_E] = VIS_TILE_BG_CONVEX_W,
-
-				[NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONCAVE_NW,
-				[NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONCAVE_NW,
-				[NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONCAVE_NW,
-				[NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONCAVE_NW,
-
-				[NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONVEX_NE,
-				[NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_SE,
-				[NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONVEX_SW,
-				[NEIGHBOR_FLAG_SE] = VIS_TILE_BG_CONVEX_NW,
-			};
-
-			if(pBgLookup[eNeighbors] != 0) {
-				if(
-					eTileAbove == TILE_WALL_BLOCKED || eTileBelow == TILE_WALL_BLOCKED ||
-					eTileLeft == TILE_WALL_BLOCKED || eTileRight == TILE_WALL_BLOCKED || (
-						(
-							eNeighbors & (
-								NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_E |
-								NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_W
-							)
-						) == 0 && (
-							pLevel->pTiles[ubTileX - 1][ubTileY - 1] == TILE_WALL_BLOCKED ||
-							pLevel->pTiles[ubTileX - 1][ubTileY + 1] == TILE_WALL_BLOCKED ||
-							pLevel->pTiles[ubTileX + 1][ubTileY - 1] == TILE_WALL_BLOCKED ||
-							pLevel->pTiles[ubTileX + 1][ubTileY + 1] == TILE_WALL_BLOCKED
-						)
-					)
-				) {
-					return pBgLookup[eNeighbors] + VIS_TILE_BLOCKED_BG_CONVEX_N - VIS_TILE_BG_CONVEX_N;
-				}
-				return pBgLookup[eNeighbors];
-			}
-		} break;
-		case TILE_TURRET_ACTIVE:
-			return VIS_TILE_TURRET_ACTIVE;
-		case TILE_TURRET_INACTIVE:
-			return VIS_TILE_TURRET_INACTIVE;
-		case TILE_SPIKES_OFF_BG:
-			return VIS_TILE_SPIKES_OFF_BG_1;
-		case TILE_SPIKES_OFF_FLOOR:
-			return VIS_TILE_SPIKES_OFF_FLOOR_1;
-		case TILE_SPIKES_ON_BG:
-			return VIS_TILE_SPIKES_ON_BG_1;
-		case TILE_SPIKES_ON_FLOOR:
-			return VIS_TILE_SPIKES_ON_FLOOR_1;
-		default:
-			return VIS_TILE_BG_1;
-			break;
+static UBYTE mapLoadLevelFromFile(tFile *pFile, ULONG ulLevelPos) {
+	UBYTE pHeader[MAP_LEVEL_HEADER_SIZE];
+	if(
+		fileRead(pFile, pHeader, sizeof(pHeader)) == sizeof(pHeader) &&
+		!memcmp(pHeader, s_pLevelMagic, sizeof(s_pLevelMagic))
+	) {
+		return mapLoadLevelV2(pFile, pHeader);
 	}
 
-	return VIS_TILE_BG_1;
+	// v1 has no header - starts right away with spawn pos
+	fileSeek(pFile, ulLevelPos, FILE_SEEK_SET);
+	return mapLoadLevelV1(pFile);
 }
 
-static UBYTE mapTrySpawnSlipgateLeftBelow(
-	tSlipgate *pSlipgate, UBYTE ubTileX, UBYTE ubTileY
-) {
-	if( // x,y is top tile of left-normal slipgate
-		!mapIsEmptyAt(ubTileX, ubTileY - 1) &&
-		mapIsEmptyAt(ubTileX - 1, ubTileY) &&
-		mapIsSlipgatableAt(ubTileX, ubTileY + 1) &&
-		mapIsEmptyAt(ubTileX - 1, ubTileY + 1) &&
-		!mapIsEmptyAt(ubTileX, ubTileY + 2)
-	) {
-		// ?! y-1
-		// .+ y
-		// .+ y+1
-		// ?! y+2
-		if(pSlipgate->isAiming) {
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-		}
-		else {
-			mapCloseSlipgate(pSlipgate);
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-			pSlipgate->sTilePositions[1].ubX = ubTileX;
-			pSlipgate->sTilePositions[1].ubY = ubTileY + 1;
-			pSlipgate->sTilePositions[2].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[2].ubY = ubTileY;
-			pSlipgate->sTilePositions[3].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[3].ubY = ubTileY + 1;
+static const tLevelPackEntry *mapGetLevelPackEntry(UBYTE ubIndex) {
+	for(UBYTE i = 0; i < s_ubLevelPackEntryCount; ++i) {
+		if(s_pLevelPackEntries[i].ubLevelIndex == ubIndex) {
+			return &s_pLevelPackEntries[i];
 		}
-		pSlipgate->eNormal = DIRECTION_LEFT;
-		return 1;
 	}
 	return 0;
 }
 
-static UBYTE mapTrySpawnSlipgateLeftAbove(
-	tSlipgate *pSlipgate, UBYTE ubTileX, UBYTE ubTileY
-) {
-	if( // x,y is bottom tile of left-normal slipgate
-		!mapIsEmptyAt(ubTileX, ubTileY - 2) &&
-		mapIsEmptyAt(ubTileX - 1, ubTileY - 1) &&
-		mapIsSlipgatableAt(ubTileX, ubTileY - 1) &&
-		mapIsEmptyAt(ubTileX - 1, ubTileY) &&
-		!mapIsEmptyAt(ubTileX - 1, ubTileY + 1)
+static void mapProcessLevelPrefetch(void) {
+	tLevelPrefetch *pPrefetch = &s_sLevelPrefetch;
+	if(
+		pPrefetch->eState != LEVEL_PREFETCH_STATE_HEADER &&
+		pPrefetch->eState != LEVEL_PREFETCH_STATE_DATA
 	) {
-		// ?! y-2
-		// .+ y-1
-		// .+ y
-		// ?! y+1
-		if(pSlipgate->isAiming) {
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY - 1;
+		// Cancelled while pending
+		return;
+	}
+
+	systemUse();
+	// Synchronous loads may have moved pack's position since last chunk
+	fileSeek(s_pLevelPack, pPrefetch->ulFilePos, FILE_SEEK_SET);
+	if(pPrefetch->eState == LEVEL_PREFETCH_STATE_HEADER) {
+		UBYTE isValid = (
+			fileRead(s_pLevelPack, pPrefetch->pHeader, MAP_LEVEL_HEADER_SIZE) == MAP_LEVEL_HEADER_SIZE &&
+			mapReadLevelHeader(pPrefetch->pHeader, &pPrefetch->sHeader)
+		);
+		if(isValid) {
+			pPrefetch->pBuffer = memAllocFast(pPrefetch->sHeader.uwBufferSize);
+			pPrefetch->uwStoredRead = 0;
+			pPrefetch->ulFilePos += MAP_LEVEL_HEADER_SIZE;
+			pPrefetch->eState = LEVEL_PREFETCH_STATE_DATA;
 		}
 		else {
-			mapCloseSlipgate(pSlipgate);
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY - 1;
-			pSlipgate->sTilePositions[1].ubX = ubTileX;
-			pSlipgate->sTilePositions[1].ubY = ubTileY;
-			pSlipgate->sTilePositions[2].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[2].ubY = ubTileY - 1;
-			pSlipgate->sTilePositions[3].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[3].ubY = ubTileY;
+			// v1 or malformed, leave it to synchronous load
+			pPrefetch->eState = LEVEL_PREFETCH_STATE_IDLE;
 		}
-		pSlipgate->eNormal = DIRECTION_LEFT;
-		return 1;
 	}
-	return 0;
-}
-
-static UBYTE mapTrySpawnSlipgateRightBelow(
-	tSlipgate *pSlipgate, UBYTE ubTileX, UBYTE ubTileY
-) {
-	if( // x,y is top tile of right-normal slipgate
-		!mapIsEmptyAt(ubTileX, ubTileY - 1) &&
-		mapIsEmptyAt(ubTileX + 1, ubTileY) &&
-		mapIsSlipgatableAt(ubTileX, ubTileY + 1) &&
-		mapIsEmptyAt(ubTileX + 1, ubTileY + 1) &&
-		!mapIsEmptyAt(ubTileX, ubTileY + 2)
-	) {
-		// !? y-1
-		// +. y
-		// +. y+1
-		// !? y+2
-		if(pSlipgate->isAiming) {
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
+	else {
+		UWORD uwChunkSize = MIN(
+			MAP_LEVEL_PREFETCH_CHUNK,
+			pPrefetch->sHeader.uwStoredSize - pPrefetch->uwStoredRead
+		);
+		UBYTE *pDst = &mapGetLevelStoredData(
+			&pPrefetch->sHeader, pPrefetch->pBuffer
+		)[pPrefetch->uwStoredRead];
+		if(fileRead(s_pLevelPack, pDst, uwChunkSize) != uwChunkSize) {
+			logWrite("ERR: Level %hhu prefetch failed\n", pPrefetch->ubLevelIndex);
+			mapCancelLevelPrefetch();
 		}
 		else {
-			mapCloseSlipgate(pSlipgate);
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-			pSlipgate->sTilePositions[1].ubX = ubTileX;
-			pSlipgate->sTilePositions[1].ubY = ubTileY + 1;
-			pSlipgate->sTilePositions[2].ubX = ubTileX + 1;
-			pSlipgate->sTilePositions[2].ubY = ubTileY;
-			pSlipgate->sTilePositions[3].ubX = ubTileX + 1;
-			pSlipgate->sTilePositions[3].ubY = ubTileY + 1;
+			pPrefetch->uwStoredRead += uwChunkSize;
+			pPrefetch->ulFilePos += uwChunkSize;
+			if(pPrefetch->uwStoredRead == pPrefetch->sHeader.uwStoredSize) {
+				pPrefetch->eState = LEVEL_PREFETCH_STATE_DONE;
+			}
 		}
-		pSlipgate->eNormal = DIRECTION_RIGHT;
-		return 1;
 	}
-	return 0;
-}
+	systemUnuse();
 
-static UBYTE mapTrySpawnSlipgateRightAbove(
-	tSlipgate *pSlipgate, UBYTE ubTileX, UBYTE ubTileY
-) {
-	if( // x,y is bottom tile of right-normal slipgate
-		!mapIsEmptyAt(ubTileX, ubTileY - 2) &&
-		mapIsEmptyAt(ubTileX + 1, ubTileY - 1) &&
-		mapIsSlipgatableAt(ubTileX, ubTileY - 1) &&
-		mapIsEmptyAt(ubTileX + 1, ubTileY) &&
-		!mapIsEmptyAt(ubTileX, ubTileY + 1)
+	if(
+		pPrefetch->eState == LEVEL_PREFETCH_STATE_HEADER ||
+		pPrefetch->eState == LEVEL_PREFETCH_STATE_DATA
 	) {
-		// !? y-2
-		// +. y-1
-		// +. y
-		// !? y+1
-		if(pSlipgate->isAiming) {
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY - 1;
-		}
-		else {
-			mapCloseSlipgate(pSlipgate);
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY - 1;
-			pSlipgate->sTilePositions[1].ubX = ubTileX;
-			pSlipgate->sTilePositions[1].ubY = ubTileY;
-			pSlipgate->sTilePositions[2].ubX = ubTileX + 1;
-			pSlipgate->sTilePositions[2].ubY = ubTileY - 1;
-			pSlipgate->sTilePositions[3].ubX = ubTileX + 1;
-			pSlipgate->sTilePositions[3].ubY = ubTileY;
-		}
-		pSlipgate->eNormal = DIRECTION_RIGHT;
-		return 1;
+		jobSchedulerRequest(s_ubJobLevelPrefetch, 0);
 	}
-	return 0;
 }
 
-static UBYTE mapTrySpawnSlipgateUpRight(
-	tSlipgate *pSlipgate, UBYTE ubTileX, UBYTE ubTileY
-) {
-	if( // x,y is left tile of up-normal slipgate
-		!mapIsEmptyAt(ubTileX - 1, ubTileY) &&
-		mapIsEmptyAt(ubTileX, ubTileY - 1) &&
-		mapIsSlipgatableAt(ubTileX + 1, ubTileY) &&
-		mapIsEmptyAt(ubTileX + 1, ubTileY - 1) &&
-		!mapIsEmptyAt(ubTileX + 2, ubTileY)
+static void mapOnLevelPrefetchDelay(UNUSED_ARG void *pData) {
+	jobSchedulerRequest(s_ubJobLevelPrefetch, 0);
+}
+
+static UBYTE mapTryLoadPrefetched(UBYTE ubIndex) {
+	UBYTE isLoaded = 0;
+	if(
+		s_sLevelPrefetch.eState != LEVEL_PREFETCH_STATE_IDLE &&
+		s_sLevelPrefetch.ubLevelIndex == ubIndex
 	) {
-		//  x
-		// ?..? y-1
-		// !++! y
-		if(pSlipgate->isAiming) {
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
+		if(s_sLevelPrefetch.eState == LEVEL_PREFETCH_STATE_DONE) {
+			isLoaded = mapParseLevel(&s_sLevelPrefetch.sHeader, s_sLevelPrefetch.pBuffer);
 		}
 		else {
-			mapCloseSlipgate(pSlipgate);
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-			pSlipgate->sTilePositions[1].ubX = ubTileX + 1;
-			pSlipgate->sTilePositions[1].ubY = ubTileY;
-			pSlipgate->sTilePositions[2].ubX = ubTileX;
-			pSlipgate->sTilePositions[2].ubY = ubTileY - 1;
-			pSlipgate->sTilePositions[3].ubX = ubTileX + 1;
-			pSlipgate->sTilePositions[3].ubY = ubTileY - 1;
+			logWrite("Level %hhu prefetch not finished, loading synchronously\n", ubIndex);
 		}
-		pSlipgate->eNormal = DIRECTION_UP;
-		return 1;
 	}
-	return 0;
+
+	// Buffer is either consumed or stale now
+	mapCancelLevelPrefetch();
+	return isLoaded;
 }
 
-static UBYTE mapTrySpawnSlipgateUpLeft(
-	tSlipgate *pSlipgate, UBYTE ubTileX, UBYTE ubTileY
-) {
-	if( // x,y is right tile of up-normal slipgate
-		!mapIsEmptyAt(ubTileX - 2, ubTileY) &&
-		mapIsEmptyAt(ubTileX - 1, ubTileY - 1) &&
-		mapIsSlipgatableAt(ubTileX - 1, ubTileY) &&
-		mapIsEmptyAt(ubTileX, ubTileY - 1) &&
-		!mapIsEmptyAt(ubTileX + 1, ubTileY)
+//------------------------------------------------------------- PUBLIC FUNCTIONS
+
+void mapOpenLevelPack(void) {
+	s_ubLevelPackEntryCount = 0;
+	// Checked once, so that release builds don't look up loose file on each load
+	s_isLevelOverrideDirPresent = diskFileExists(MAP_LEVEL_OVERRIDE_DIR);
+
+	s_pLevelPack = diskFileOpen(MAP_LEVEL_PACK_PATH, "rb");
+	if(!s_pLevelPack) {
+		logWrite("ERR: Can't open level pack " MAP_LEVEL_PACK_PATH "\n");
+		return;
+	}
+
+	UBYTE pHeader[MAP_LEVEL_PACK_HEADER_SIZE];
+	const UBYTE *pData = &pHeader[sizeof(s_pLevelPackMagic)];
+	UWORD uwEntryCount = 0;
+	if(
+		fileRead(s_pLevelPack, pHeader, sizeof(pHeader)) == sizeof(pHeader) &&
+		!memcmp(pHeader, s_pLevelPackMagic, sizeof(s_pLevelPackMagic))
 	) {
-		//   x
-		// ?..? y-1
-		// !++! y
-		if(pSlipgate->isAiming) {
-			pSlipgate->sTilePositions[0].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-		}
-		else {
-			mapCloseSlipgate(pSlipgate);
-			pSlipgate->sTilePositions[0].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-			pSlipgate->sTilePositions[1].ubX = ubTileX;
-			pSlipgate->sTilePositions[1].ubY = ubTileY;
-			pSlipgate->sTilePositions[2].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[2].ubY = ubTileY - 1;
-			pSlipgate->sTilePositions[3].ubX = ubTileX;
-			pSlipgate->sTilePositions[3].ubY = ubTileY - 1;
-		}
-		pSlipgate->eNormal = DIRECTION_UP;
-		return 1;
+		uwEntryCount = mapUnpackUword(&pData);
 	}
-	return 0;
+	if(!uwEntryCount || uwEntryCount > MAP_LEVEL_PACK_ENTRIES_MAX) {
+		logWrite("ERR: Malformed level pack, entry count: %hu\n", uwEntryCount);
+		mapCloseLevelPack();
+		return;
+	}
+
+	UBYTE pIndex[MAP_LEVEL_PACK_ENTRIES_MAX * MAP_LEVEL_PACK_ENTRY_SIZE];
+	UWORD uwIndexSize = uwEntryCount * MAP_LEVEL_PACK_ENTRY_SIZE;
+	if(fileRead(s_pLevelPack, pIndex, uwIndexSize) != uwIndexSize) {
+		logWrite("ERR: Level pack index truncated\n");
+		mapCloseLevelPack();
+		return;
+	}
+	pData = pIndex;
+	for(UBYTE i = 0; i < uwEntryCount; ++i) {
+		tLevelPackEntry *pEntry = &s_pLevelPackEntries[i];
+		pEntry->ubLevelIndex = *pData;
+		pData += 2;
+		pEntry->uwSize = mapUnpackUword(&pData);
+		pEntry->ulOffset = mapUnpackUlong(&pData);
+	}
+	s_ubLevelPackEntryCount = uwEntryCount;
 }
 
-static UBYTE mapTrySpawnSlipgateDownRight(
-	tSlipgate *pSlipgate, UBYTE ubTileX, UBYTE ubTileY
-) {
-	if( // x,y is left tile of down-normal slipgate
-		!mapIsEmptyAt(ubTileX - 1, ubTileY) &&
-		mapIsEmptyAt(ubTileX, ubTileY + 1) &&
-		mapIsSlipgatableAt(ubTileX + 1, ubTileY) &&
-		mapIsEmptyAt(ubTileX + 1, ubTileY + 1) &&
-		!mapIsEmptyAt(ubTileX + 2, ubTileY)
-	) {
-		//  x
-		// !++! y
-		// ?..? y+1
-		if(pSlipgate->isAiming) {
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-		}
-		else {
-			mapCloseSlipgate(pSlipgate);
-			pSlipgate->sTilePositions[0].ubX = ubTileX;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-			pSlipgate->sTilePositions[1].ubX = ubTileX + 1;
-			pSlipgate->sTilePositions[1].ubY = ubTileY;
-			pSlipgate->sTilePositions[2].ubX = ubTileX;
-			pSlipgate->sTilePositions[2].ubY = ubTileY + 1;
-			pSlipgate->sTilePositions[3].ubX = ubTileX + 1;
-			pSlipgate->sTilePositions[3].ubY = ubTileY + 1;
-		}
-		pSlipgate->eNormal = DIRECTION_DOWN;
-		return 1;
+void mapCloseLevelPack(void) {
+	mapCancelLevelPrefetch();
+	if(s_pLevelPack) {
+		fileClose(s_pLevelPack);
+		s_pLevelPack = 0;
 	}
-	return 0;
+	s_ubLevelPackEntryCount = 0;
 }
 
-static UBYTE mapTrySpawnSlipgateDownLeft(
-	tSlipgate *pSlipgate, UBYTE ubTileX, UBYTE ubTileY
-) {
-	if( // x,y is right tile of down-normal slipgate
-		!mapIsEmptyAt(ubTileX - 2, ubTileY) &&
-		mapIsEmptyAt(ubTileX - 1, ubTileY + 1) &&
-		mapIsSlipgatableAt(ubTileX - 1, ubTileY) &&
-		mapIsEmptyAt(ubTileX, ubTileY + 1) &&
-		!mapIsEmptyAt(ubTileX + 1, ubTileY)
+
+void mapPrefetchLevel(UBYTE ubIndex) {
+	if(
+		s_sLevelPrefetch.eState != LEVEL_PREFETCH_STATE_IDLE &&
+		s_sLevelPrefetch.ubLevelIndex == ubIndex
 	) {
-		//   x
-		// !++! y
-		// ?..? y+1
-		if(pSlipgate->isAiming) {
-			pSlipgate->sTilePositions[0].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-		}
-		else {
-			mapCloseSlipgate(pSlipgate);
-			pSlipgate->sTilePositions[0].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[0].ubY = ubTileY;
-			pSlipgate->sTilePositions[1].ubX = ubTileX;
-			pSlipgate->sTilePositions[1].ubY = ubTileY;
-			pSlipgate->sTilePositions[2].ubX = ubTileX - 1;
-			pSlipgate->sTilePositions[2].ubY = ubTileY + 1;
-			pSlipgate->sTilePositions[3].ubX = ubTileX;
-			pSlipgate->sTilePositions[3].ubY = ubTileY + 1;
+		// Keep progress, but job request may have been dropped by scheduler reset
+		if(s_sLevelPrefetch.eState != LEVEL_PREFETCH_STATE_DONE) {
+			timerWheelSchedule(
+				&s_sLevelPrefetchTimer, MAP_LEVEL_PREFETCH_DELAY,
+				mapOnLevelPrefetchDelay, 0
+			);
 		}
-		pSlipgate->eNormal = DIRECTION_DOWN;
-		return 1;
+		return;
 	}
-	return 0;
+
+	mapCancelLevelPrefetch();
+	const tLevelPackEntry *pEntry = mapGetLevelPackEntry(ubIndex);
+	if(!pEntry || s_isLevelOverrideDirPresent) {
+		// Loose file may take priority, leave it to synchronous load
+		return;
+	}
+	s_sLevelPrefetch.ubLevelIndex = ubIndex;
+	s_sLevelPrefetch.ulFilePos = pEntry->ulOffset;
+	s_sLevelPrefetch.eState = LEVEL_PREFETCH_STATE_HEADER;
+	timerWheelSchedule(
+		&s_sLevelPrefetchTimer, MAP_LEVEL_PREFETCH_DELAY, mapOnLevelPrefetchDelay, 0
+	);
 }
 
-//------------------------------------------------------------- PUBLIC FUNCTIONS
+void mapCancelLevelPrefetch(void) {
+	timerWheelCancel(&s_sLevelPrefetchTimer);
+	if(s_sLevelPrefetch.pBuffer) {
+		memFree(s_sLevelPrefetch.pBuffer, s_sLevelPrefetch.sHeader.uwBufferSize);
+		s_sLevelPrefetch.pBuffer = 0;
+	}
+	s_sLevelPrefetch.eState = LEVEL_PREFETCH_STATE_IDLE;
+}
 
 UBYTE mapTryLoad(UBYTE ubIndex) {
 	memset(s_pInteractions, 0, sizeof(s_pInteractions));
@@ -1105,92 +975,31 @@ UBYTE mapTryLoad(UBYTE ubIndex) {
 		strcpy(s_sLoadedLevel.szStoryText, "TODO: ADD TEXT\nLINE 2");
 		mapRecalcAllVisTilesOnLevel(&s_sLoadedLevel);
 	}
-	else {
-		char szName[30];
-		sprintf(szName, "data/levels/L%03hhu.dat", ubIndex);
+	else if(!mapTryLoadPrefetched(ubIndex)) {
 		systemUse();
-		tFile *pFile = diskFileOpen(szName, "rb");
-		if(!pFile) {
-			systemUnuse();
-			return 0;
+		UBYTE isLoaded = 0;
+		tFile *pFile = 0;
+		if(s_isLevelOverrideDirPresent) {
+			// Loose files saved by editor take priority over pack
+			char szName[30];
+			sprintf(szName, MAP_LEVEL_OVERRIDE_DIR "/L%03hhu.dat", ubIndex);
+			pFile = diskFileOpen(szName, "rb");
 		}
-		fileRead(pFile, &s_sLoadedLevel.sSpawnPos.fX, sizeof(s_sLoadedLevel.sSpawnPos.fX));
-		fileRead(pFile, &s_sLoadedLevel.sSpawnPos.fY, sizeof(s_sLoadedLevel.sSpawnPos.fY));
-
-		for(UBYTE ubInteractionIndex = 0; ubInteractionIndex < MAP_INTERACTIONS_MAX; ++ubInteractionIndex) {
-			tInteraction *pInteraction = &s_pInteractions[ubInteractionIndex];
-			fileRead(pFile, &pInteraction->ubTargetCount, sizeof(pInteraction->ubTargetCount));
-			fileRead(pFile, &pInteraction->uwButtonMask, sizeof(pInteraction->uwButtonMask));
-			fileRead(pFile, &pInteraction->wasActive, sizeof(pInteraction->wasActive));
-			pInteraction->wasActive = 0;
-			for(UBYTE ubTargetIndex = 0; ubTargetIndex < pInteraction->ubTargetCount; ++ubTargetIndex) {
-				tTogglableTile *pTargetTile = &pInteraction->pTargetTiles[ubTargetIndex];
-				fileRead(pFile, &pTargetTile->eKind, sizeof(pTargetTile->eKind));
-				fileRead(pFile, &pTargetTile->eTileActive, sizeof(pTargetTile->eTileActive));
-				fileRead(pFile, &pTargetTile->eTileInactive, sizeof(pTargetTile->eTileInactive));
-				fileRead(pFile, &pTargetTile->eVisTileActive, sizeof(pTargetTile->eVisTileActive));
-				fileRead(pFile, &pTargetTile->eVisTileInactive, sizeof(pTargetTile->eVisTileInactive));
-				fileRead(pFile, &pTargetTile->sPos.uwYX, sizeof(pTargetTile->sPos.uwYX));
-			}
+		if(pFile) {
+			isLoaded = mapLoadLevelFromFile(pFile, 0);
+			fileClose(pFile);
 		}
-
-		fileRead(pFile, &s_sLoadedLevel.ubBoxCount, sizeof(s_sLoadedLevel.ubBoxCount));
-		for(UBYTE i = 0; i < s_sLoadedLevel.ubBoxCount; ++i) {
-			fileRead(pFile, &s_sLoadedLevel.pBoxSpawns[i].fX, sizeof(s_sLoadedLevel.pBoxSpawns[i].fX));
-			fileRead(pFile, &s_sLoadedLevel.pBoxSpawns[i].fY, sizeof(s_sLoadedLevel.pBoxSpawns[i].fY));
-		}
-
-		fileRead(pFile, &s_sLoadedLevel.ubSpikeTilesCount, sizeof(s_sLoadedLevel.ubSpikeTilesCount));
-		for(UBYTE i = 0; i < s_sLoadedLevel.ubSpikeTilesCount; ++i) {
-			fileRead(pFile, &s_sLoadedLevel.pSpikeTiles[i].uwYX, sizeof(s_sLoadedLevel.pSpikeTiles[i].uwYX));
-		}
-
-		fileRead(pFile, &s_sLoadedLevel.ubTurretCount, sizeof(s_sLoadedLevel.ubTurretCount));
-		for(UBYTE i = 0; i < s_sLoadedLevel.ubTurretCount; ++i) {
-			fileRead(pFile, &s_sLoadedLevel.pTurretSpawns[i].sTilePos.uwYX, sizeof(s_sLoadedLevel.pTurretSpawns[i].sTilePos.uwYX));
-		}
-
-		UBYTE ubStoryTextLength;
-		fileRead(pFile, &ubStoryTextLength, sizeof(ubStoryTextLength));
-		if(ubStoryTextLength) {
-			fileRead(pFile, s_sLoadedLevel.szStoryText, ubStoryTextLength);
-			s_sLoadedLevel.szStoryText[ubStoryTextLength] = '\0';
-		}
-
-		UBYTE ubReservedCount1;
-		fileRead(pFile, &ubReservedCount1, sizeof(ubReservedCount1));
-
-		UBYTE ubReservedCount2;
-		fileRead(pFile, &ubReservedCount2, sizeof(ubReservedCount2));
-
-		for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
-			for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
-				UWORD uwTileCode;
-				fileRead(pFile, &uwTileCode, sizeof(uwTileCode));
-				s_sLoadedLevel.pTiles[ubX][ubY] = uwTileCode;
-				if(uwTileCode == TILE_BOUNCER_SPAWNER) {
-					if(s_sLoadedLevel.ubBouncerSpawnerTileX != BOUNCER_TILE_INVALID) {
-						logWrite(
-							"ERR: More than one bouncer spawner on map, previous on %hhu, %hhu\n",
-							s_sLoadedLevel.ubBouncerSpawnerTileX, s_sLoadedLevel.ubBouncerSpawnerTileY
-						);
-					}
-					s_sLoadedLevel.ubBouncerSpawnerTileX = ubX;
-					s_sLoadedLevel.ubBouncerSpawnerTileY = ubY;
-				}
-			}
-		}
-
-		for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
-			for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
-				UWORD uwVisTileCode;
-				fileRead(pFile, &uwVisTileCode, sizeof(uwVisTileCode));
-				s_sLoadedLevel.pVisTiles[ubX][ubY] = uwVisTileCode;
+		else {
+			const tLevelPackEntry *pEntry = mapGetLevelPackEntry(ubIndex);
+			if(pEntry) {
+				fileSeek(s_pLevelPack, pEntry->ulOffset, FILE_SEEK_SET);
+				isLoaded = mapLoadLevelFromFile(s_pLevelPack, pEntry->ulOffset);
 			}
 		}
-
-		fileClose(pFile);
 		systemUnuse();
+		if(!isLoaded) {
+			return 0;
+		}
 	}
 
 	mapRestart();
@@ -1204,6 +1013,9 @@ void mapRestart(void) {
 		s_pInteractions[ubInteractionIndex].wasActive = 0;
 	}
 
+	for(UBYTE i = 0; i < MAP_TURRETS_MAX; ++i) {
+		timerWheelCancel(&s_pTurrets[i].sAttackTimer);
+	}
 	s_ubTurretCount = s_sLoadedLevel.ubTurretCount;
 	for(UBYTE i = 0; i < s_ubTurretCount; ++i)  {
 		// Populate turret vars from spawns
@@ -1212,16 +1024,21 @@ void mapRestart(void) {
 		// Now that tiles are loaded, determine turret range etc
 		mapInitTurret(&s_pTurrets[i]);
 	}
+	mapRebuildTurretRowMasks();
 
-	g_pSlipgates[SLIPGATE_A].isAiming = 0;
-	g_pSlipgates[SLIPGATE_A].eNormal = DIRECTION_NONE;
-	g_pSlipgates[SLIPGATE_B].isAiming = 0;
-	g_pSlipgates[SLIPGATE_B].eNormal = DIRECTION_NONE;
-	g_pSlipgates[SLIPGATE_AIM].isAiming = 1;
-	g_pSlipgates[SLIPGATE_AIM].eNormal = DIRECTION_NONE;
+	for(UBYTE i = 0; i < SLIPGATE_COUNT; ++i) {
+		g_pSlipgates[i].isAiming = (i == SLIPGATE_AIM);
+		g_pSlipgates[i].eNormal = DIRECTION_NONE;
+		g_pSlipgates[i].ubLinkedIndex = SLIPGATE_INDEX_NONE;
+		g_pSlipgates[i].ubColor = SLIPGATE_A;
+	}
+	mapLinkSlipgates(SLIPGATE_A, SLIPGATE_B);
+	memset(s_pSlipgateGrid, SLIPGATE_INDEX_NONE, sizeof(s_pSlipgateGrid));
 
-	s_ubCurrentInteraction = 0;
-	s_uwSpikeCooldown = 1;
+	mapRebuildInteractionIndex();
+	s_uwPrevButtonPressMask = 0;
+	mapRegisterJobs();
+	timerWheelSchedule(&s_sSpikeTimer, 1, mapOnSpikeTimer, 0);
 	s_isSpikeActive = 0;
 	s_pDirtyTileCounts[0] = 0;
 	s_pDirtyTileCounts[1] = 0;
@@ -1233,95 +1050,121 @@ void mapRestart(void) {
 }
 
 void mapSave(UBYTE ubIndex) {
-	mapCloseSlipgate(&g_pSlipgates[SLIPGATE_A]);
-	mapCloseSlipgate(&g_pSlipgates[SLIPGATE_B]);
+	for(UBYTE i = 0; i < SLIPGATE_COUNT; ++i) {
+		if(!g_pSlipgates[i].isAiming) {
+			mapCloseSlipgate(&g_pSlipgates[i]);
+		}
+	}
 
-	char szName[30];
-	sprintf(szName, "data/levels/L%03hhu.dat", ubIndex);
-	systemUse();
-	tFile *pFile = diskFileOpen(szName, "wb");
-	fileWrite(pFile, &g_sCurrentLevel.sSpawnPos.fX, sizeof(g_sCurrentLevel.sSpawnPos.fX));
-	fileWrite(pFile, &g_sCurrentLevel.sSpawnPos.fY, sizeof(g_sCurrentLevel.sSpawnPos.fY));
+	UBYTE ubStoryTextLength = strlen(g_sCurrentLevel.szStoryText);
+	UBYTE pTargetCounts[MAP_INTERACTIONS_MAX];
+	for(UBYTE i = 0; i < MAP_INTERACTIONS_MAX; ++i) {
+		pTargetCounts[i] = mapGetInteractionByIndex(i)->ubTargetCount;
+	}
+	UWORD uwPayloadSize = mapGetLevelPayloadSize(
+		pTargetCounts, g_sCurrentLevel.ubBoxCount,
+		g_sCurrentLevel.ubSpikeTilesCount, s_ubTurretCount, ubStoryTextLength
+	);
+
+	UBYTE pHeader[MAP_LEVEL_HEADER_SIZE] = {0};
+	UBYTE *pData = pHeader;
+	memcpy(pData, s_pLevelMagic, sizeof(s_pLevelMagic));
+	pData += sizeof(s_pLevelMagic);
+	*(pData++) = MAP_LEVEL_VERSION;
+	*(pData++) = ubStoryTextLength;
+	mapPackUword(&pData, uwPayloadSize);
+	mapPackUlong(&pData, g_sCurrentLevel.sSpawnPos.fX);
+	mapPackUlong(&pData, g_sCurrentLevel.sSpawnPos.fY);
+	memcpy(pData, pTargetCounts, MAP_INTERACTIONS_MAX);
+	pData += MAP_INTERACTIONS_MAX;
+	*(pData++) = g_sCurrentLevel.ubBoxCount;
+	*(pData++) = g_sCurrentLevel.ubSpikeTilesCount;
+	*(pData++) = s_ubTurretCount;
+
+	UBYTE *pPayload = memAllocFast(uwPayloadSize);
+	pData = pPayload;
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			mapPackUword(&pData, mapGetTileAt(ubX, ubY));
+		}
+	}
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			mapPackUword(&pData, mapGetVisTileAt(ubX, ubY));
+		}
+	}
 
 	for(UBYTE ubInteractionIndex = 0; ubInteractionIndex < MAP_INTERACTIONS_MAX; ++ubInteractionIndex) {
 		tInteraction *pInteraction = mapGetInteractionByIndex(ubInteractionIndex);
-		fileWrite(pFile, &pInteraction->ubTargetCount, sizeof(pInteraction->ubTargetCount));
-		fileWrite(pFile, &pInteraction->uwButtonMask, sizeof(pInteraction->uwButtonMask));
-		fileWrite(pFile, &pInteraction->wasActive, sizeof(pInteraction->wasActive));
+		mapPackUword(&pData, pInteraction->uwButtonMask);
 		for(UBYTE ubTargetIndex = 0; ubTargetIndex < pInteraction->ubTargetCount; ++ubTargetIndex) {
 			tTogglableTile *pTargetTile = &pInteraction->pTargetTiles[ubTargetIndex];
-			fileWrite(pFile, &pTargetTile->eKind, sizeof(pTargetTile->eKind));
-			fileWrite(pFile, &pTargetTile->eTileActive, sizeof(pTargetTile->eTileActive));
-			fileWrite(pFile, &pTargetTile->eTileInactive, sizeof(pTargetTile->eTileInactive));
-			fileWrite(pFile, &pTargetTile->eVisTileActive, sizeof(pTargetTile->eVisTileActive));
-			fileWrite(pFile, &pTargetTile->eVisTileInactive, sizeof(pTargetTile->eVisTileInactive));
-			fileWrite(pFile, &pTargetTile->sPos.uwYX, sizeof(pTargetTile->sPos.uwYX));
+			mapPackUword(&pData, pTargetTile->sPos.uwYX);
+			mapPackUword(&pData, pTargetTile->eKind);
+			mapPackUword(&pData, pTargetTile->eTileActive);
+			mapPackUword(&pData, pTargetTile->eTileInactive);
+			mapPackUword(&pData, pTargetTile->eVisTileActive);
+			mapPackUword(&pData, pTargetTile->eVisTileInactive);
 		}
 	}
 
-	fileWrite(pFile, &g_sCurrentLevel.ubBoxCount, sizeof(g_sCurrentLevel.ubBoxCount));
 	for(UBYTE i = 0; i < g_sCurrentLevel.ubBoxCount; ++i) {
-		fileWrite(pFile, &g_sCurrentLevel.pBoxSpawns[i].fX, sizeof(g_sCurrentLevel.pBoxSpawns[i].fX));
-		fileWrite(pFile, &g_sCurrentLevel.pBoxSpawns[i].fY, sizeof(g_sCurrentLevel.pBoxSpawns[i].fY));
+		mapPackUlong(&pData, g_sCurrentLevel.pBoxSpawns[i].fX);
+		mapPackUlong(&pData, g_sCurrentLevel.pBoxSpawns[i].fY);
 	}
-
-	fileWrite(pFile, &g_sCurrentLevel.ubSpikeTilesCount, sizeof(g_sCurrentLevel.ubSpikeTilesCount));
 	for(UBYTE i = 0; i < g_sCurrentLevel.ubSpikeTilesCount; ++i) {
-		fileWrite(pFile, &g_sCurrentLevel.pSpikeTiles[i].uwYX, sizeof(g_sCurrentLevel.pSpikeTiles[i].uwYX));
+		mapPackUword(&pData, g_sCurrentLevel.pSpikeTiles[i].uwYX);
 	}
-
-	fileWrite(pFile, &s_ubTurretCount, sizeof(s_ubTurretCount));
 	for(UBYTE i = 0; i < s_ubTurretCount; ++i) {
-		fileWrite(pFile, &s_pTurrets[i].sTilePos.uwYX, sizeof(s_pTurrets[i].sTilePos.uwYX));
+		mapPackUword(&pData, s_pTurrets[i].sTilePos.uwYX);
 	}
+	memcpy(pData, g_sCurrentLevel.szStoryText, ubStoryTextLength);
 
-	UBYTE ubStoryTextLength = strlen(g_sCurrentLevel.szStoryText);
-	fileWrite(pFile, &ubStoryTextLength, sizeof(ubStoryTextLength));
-	if(ubStoryTextLength) {
-		fileWrite(pFile, g_sCurrentLevel.szStoryText, ubStoryTextLength);
-	}
-
-	UBYTE ubReservedCount1 = 0;
-	fileWrite(pFile, &ubReservedCount1, sizeof(ubReservedCount1));
-
-	UBYTE ubReservedCount2 = 0;
-	fileWrite(pFile, &ubReservedCount2, sizeof(ubReservedCount2));
-
-	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
-		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
-			UWORD uwTileCode = mapGetTileAt(ubX, ubY);
-			fileWrite(pFile, &uwTileCode, sizeof(uwTileCode));
-		}
+	char szName[30];
+	sprintf(szName, MAP_LEVEL_OVERRIDE_DIR "/L%03hhu.dat", ubIndex);
+	systemUse();
+	tFile *pFile = diskFileOpen(szName, "wb");
+	if(pFile) {
+		fileWrite(pFile, pHeader, sizeof(pHeader));
+		fileWrite(pFile, pPayload, uwPayloadSize);
+		fileClose(pFile);
+		s_isLevelOverrideDirPresent = 1;
+		// Prefetched data could be older than loose file now
+		mapCancelLevelPrefetch();
 	}
-	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
-		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
-			UWORD uwVisTileCode = mapGetVisTileAt(ubX, ubY);
-			fileWrite(pFile, &uwVisTileCode, sizeof(uwVisTileCode));
-		}
+	else {
+		logWrite("ERR: Can't save %s, is " MAP_LEVEL_OVERRIDE_DIR " present?\n", szName);
 	}
-	fileClose(pFile);
 	systemUnuse();
+	memFree(pPayload, uwPayloadSize);
 }
 
 void mapProcess(void) {
-	if(!mapProcessSpikes()) {
-		mapProcessNextInteraction();
-		mapProcessNextTurret();
-	}
-
-	mapDrawPendingTiles();
-
+	// Dirty tiles and slipgate draws alternate between buffers,
+	// so they can't be deferred and are requested every frame.
+	jobSchedulerRequest(
+		s_ubJobDirtyTiles, s_pDirtyTileCounts[!s_ubCurrentDirtyList]
+	);
 	if(s_ubPendingSlipgateOpenIndex != MAP_PENDING_SLIPGATE_OPEN_INVALID) {
-		gameDrawSlipgate(s_ubPendingSlipgateOpenIndex);
-		if(--s_ubPendingSlipgateDraws == 0) {
-			s_ubPendingSlipgateOpenIndex = MAP_PENDING_SLIPGATE_OPEN_INVALID;
-		}
+		jobSchedulerRequest(s_ubJobSlipgateDraw, MAP_JOB_COST_SLIPGATE_DRAW);
 	}
+	mapRequestChangedInteractions();
+	jobSchedulerRequest(s_ubJobTurrets, MAP_JOB_COST_TURRET);
+
+	jobSchedulerProcess(s_uwJobBudget);
 
 	// Reset button mask for refresh by body collisions
 	s_uwButtonPressMask = 0;
 }
 
+void mapProcessIdle(void) {
+	jobSchedulerProcessIdle();
+}
+
+void mapSetJobBudget(UWORD uwBudget) {
+	s_uwJobBudget = uwBudget;
+}
+
 void mapPressButtonAt(UBYTE ubX, UBYTE ubY) {
 	tTile eTile = g_sCurrentLevel.pTiles[ubX][ubY];
 	if(!mapTileIsButton(eTile)) {
@@ -1336,9 +1179,10 @@ void mapDisableTurretAt(UBYTE ubX, UBYTE ubY) {
 		if(s_pTurrets[i].sTilePos.uwYX == sPos.uwYX) {
 			// Disable relevant turret logic
 			s_pTurrets[i].isActive = 0;
+			timerWheelCancel(&s_pTurrets[i].sAttackTimer);
 
 			// Update turret tile
-			g_sCurrentLevel.pTiles[ubX][ubY] = TILE_TURRET_INACTIVE;
+			mapSetTileAt(ubX, ubY, TILE_TURRET_INACTIVE);
 			g_sCurrentLevel.pVisTiles[ubX][ubY] = VIS_TILE_TURRET_INACTIVE;
 			mapRequestTileDraw(ubX, ubY);
 			break;
@@ -1346,6 +1190,21 @@ void mapDisableTurretAt(UBYTE ubX, UBYTE ubY) {
 	}
 }
 
+void mapRebuildInteractionIndex(void) {
+	memset(s_pButtonInteractions, 0, sizeof(s_pButtonInteractions));
+	for(UBYTE i = 0; i < MAP_INTERACTIONS_MAX; ++i) {
+		UWORD uwButtonMask = s_pInteractions[i].uwButtonMask;
+		for(UBYTE ubButton = 0; uwButtonMask; ++ubButton, uwButtonMask >>= 1) {
+			if(uwButtonMask & 1) {
+				s_pButtonInteractions[ubButton] |= BV(i);
+			}
+		}
+	}
+
+	// Masks could have changed, so re-check everything on next frame
+	s_uwPendingInteractions = BV(MAP_INTERACTIONS_MAX) - 1;
+}
+
 void mapPressButtonIndex(UBYTE ubButtonIndex) {
 	s_uwButtonPressMask |= BV(ubButtonIndex);
 }
@@ -1395,10 +1254,18 @@ void mapAddOrRemoveTurret(UBYTE ubX, UBYTE ubY) {
 			g_sCurrentLevel.pTiles[ubX][ubY] = TILE_BG;
 			mapRecalculateVisTilesNearTileAt(ubX, ubY);
 			s_pTurrets[i].isActive = 0;
+			timerWheelCancel(&s_pTurrets[i].sAttackTimer);
+
+			// Timers are linked by address, so moved turrets need to be relinked
 			while(++i < s_ubTurretCount) {
 				s_pTurrets[i - 1] = s_pTurrets[i];
+				timerWheelMove(
+					&s_pTurrets[i].sAttackTimer, &s_pTurrets[i - 1].sAttackTimer,
+					&s_pTurrets[i - 1]
+				);
 			}
 			--s_ubTurretCount;
+			mapRebuildTurretRowMasks();
 			return;
 		}
 	}
@@ -1412,6 +1279,7 @@ void mapAddOrRemoveTurret(UBYTE ubX, UBYTE ubY) {
 
 		++s_ubTurretCount;
 		mapInitTurret(pTurret);
+		mapRebuildTurretRowMasks();
 	}
 }
 
@@ -1427,20 +1295,31 @@ void mapRequestTileDraw(UBYTE ubTileX, UBYTE ubTileY) {
 }
 
 void mapRecalcAllVisTilesOnLevel(tLevel *pLevel) {
-	for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
-		for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
-			pLevel->pVisTiles[ubX][ubY] = mapCalculateVisTileOnLevel(pLevel, ubX, ubY);
-		}
-	}
+	autotileRecalcAllVisTiles(pLevel);
 }
 
 void mapRecalculateVisTilesNearTileAt(UBYTE ubTileX, UBYTE ubTileY) {
-	for(UBYTE ubX = ubTileX - 1; ubX <= ubTileX + 1; ++ubX) {
-		for(UBYTE ubY = ubTileY - 1; ubY <= ubTileY + 1; ++ubY) {
-			// Checking if eOld == eNew won't work for changing buttons (same vis, different logic tiles)
-			tVisTile eNew = mapCalculateVisTileOnLevel(&g_sCurrentLevel, ubX, ubY);
-			g_sCurrentLevel.pVisTiles[ubX][ubY] = eNew;
-			mapRequestTileDraw(ubX, ubY);
+	mapRecalculateVisTilesInRect(ubTileX, ubTileY, ubTileX, ubTileY);
+}
+
+void mapRecalculateVisTilesInRect(
+	UBYTE ubLeftX, UBYTE ubTopY, UBYTE ubRightX, UBYTE ubBottomY
+) {
+	// Editor changes logic tiles directly before calling this
+	mapUpdateTurretsInRect(ubLeftX, ubTopY, ubRightX, ubBottomY);
+
+	// Changed tiles affect vis tiles of their neighbours
+	UBYTE ubStartX = (ubLeftX > 0) ? ubLeftX - 1 : 0;
+	UBYTE ubStartY = (ubTopY > 0) ? ubTopY - 1 : 0;
+	UBYTE ubEndX = MIN(ubRightX + 1, MAP_TILE_WIDTH - 1);
+	UBYTE ubEndY = MIN(ubBottomY + 1, MAP_TILE_HEIGHT - 1);
+	for(UBYTE ubX = ubStartX; ubX <= ubEndX; ++ubX) {
+		for(UBYTE ubY = ubStartY; ubY <= ubEndY; ++ubY) {
+			tVisTile eNew = autotileGetVisTile(&g_sCurrentLevel, ubX, ubY);
+			if(g_sCurrentLevel.pVisTiles[ubX][ubY] != eNew) {
+				g_sCurrentLevel.pVisTiles[ubX][ubY] = eNew;
+				mapRequestTileDraw(ubX, ubY);
+			}
 		}
 	}
 }
@@ -1453,10 +1332,12 @@ UBYTE mapIsVistileDecorableBgAt(UBYTE ubTileX, UBYTE ubTileY) {
 	return 0;
 }
 
-UBYTE mapIsSlipgateTunnelOpen(void) {
+UBYTE mapIsSlipgateTunnelOpen(UBYTE ubIndex) {
+	UBYTE ubLinkedIndex = g_pSlipgates[ubIndex].ubLinkedIndex;
 	return (
-		g_pSlipgates[SLIPGATE_A].eNormal != DIRECTION_NONE &&
-		g_pSlipgates[SLIPGATE_B].eNormal != DIRECTION_NONE
+		g_pSlipgates[ubIndex].eNormal != DIRECTION_NONE &&
+		ubLinkedIndex != SLIPGATE_INDEX_NONE &&
+		g_pSlipgates[ubLinkedIndex].eNormal != DIRECTION_NONE
 	);
 }
 
@@ -1668,61 +1549,57 @@ UBYTE mapTrySpawnSlipgate(
 		return 0;
 	}
 
-	tSlipgate *pSlipgate = &g_pSlipgates[ubIndex];
-	UBYTE isOpened = 0;
-
-	// TODO: this should only check for empty tile on left/right/up/down direction
-	// and then do the same comparisons for x-1,x,x+1 for up/down and y for left-right
 	// TODO: reverse spawn orders depending on exact hit position in the tile
-	switch(eNormal) {
-		case DIRECTION_LEFT:
-			isOpened = (
-				mapTrySpawnSlipgateLeftAbove(pSlipgate, ubTileX, ubTileY) ||
-				mapTrySpawnSlipgateLeftBelow(pSlipgate, ubTileX, ubTileY)
-			);
-			break;
-		case DIRECTION_RIGHT:
-			isOpened = (
-				mapTrySpawnSlipgateRightAbove(pSlipgate, ubTileX, ubTileY) ||
-				mapTrySpawnSlipgateRightBelow(pSlipgate, ubTileX, ubTileY)
-			);
-			break;
-		case DIRECTION_UP:
-			isOpened = (
-				mapTrySpawnSlipgateUpRight(pSlipgate, ubTileX, ubTileY) ||
-				mapTrySpawnSlipgateUpLeft(pSlipgate, ubTileX, ubTileY)
-			);
-			break;
-		case DIRECTION_DOWN:
-			isOpened = (
-				mapTrySpawnSlipgateDownRight(pSlipgate, ubTileX, ubTileY) ||
-				mapTrySpawnSlipgateDownLeft(pSlipgate, ubTileX, ubTileY)
-			);
-			break;
-		default:
-			break;
+	const tSlipgatePlacement *pPlacement = slipgatePlacementFind(
+		&g_sCurrentLevel, ubTileX, ubTileY, eNormal
+	);
+	if(!pPlacement) {
+		return 0;
 	}
 
-	if(!isOpened) {
-		return 0;
+	tSlipgate *pSlipgate = &g_pSlipgates[ubIndex];
+	if(pSlipgate->isAiming) {
+		pSlipgate->sTilePositions[0].ubX = ubTileX + pPlacement->pTileOffsets[0].bX;
+		pSlipgate->sTilePositions[0].ubY = ubTileY + pPlacement->pTileOffsets[0].bY;
 	}
+	else {
+		mapCloseSlipgate(pSlipgate);
+		for(UBYTE i = 0; i < 4; ++i) {
+			pSlipgate->sTilePositions[i].ubX = ubTileX + pPlacement->pTileOffsets[i].bX;
+			pSlipgate->sTilePositions[i].ubY = ubTileY + pPlacement->pTileOffsets[i].bY;
+		}
+	}
+	pSlipgate->eNormal = eNormal;
 
 	if(!pSlipgate->isAiming) {
-		mapTryCloseSlipgateAt(!ubIndex, pSlipgate->sTilePositions[0]);
-		mapTryCloseSlipgateAt(!ubIndex, pSlipgate->sTilePositions[1]);
+		// Replace any other slipgate on the same wall tiles
+		mapTryCloseSlipgateAt(pSlipgate->sTilePositions[0]);
+		mapTryCloseSlipgateAt(pSlipgate->sTilePositions[1]);
 	}
 	mapOpenSlipgate(ubIndex);
 
 	return 1;
 }
 
-void mapTryCloseSlipgateAt(UBYTE ubIndex, tUbCoordYX sPos) {
-	if(slipgateIsOccupyingTile(&g_pSlipgates[ubIndex], sPos)) {
+void mapTryCloseSlipgateAt(tUbCoordYX sPos) {
+	UBYTE ubIndex = s_pSlipgateGrid[sPos.ubX][sPos.ubY];
+	if(ubIndex != SLIPGATE_INDEX_NONE) {
 		mapCloseSlipgate(&g_pSlipgates[ubIndex]);
 	}
 }
 
+UBYTE mapGetSlipgateIndexAt(UBYTE ubTileX, UBYTE ubTileY) {
+	return s_pSlipgateGrid[ubTileX][ubTileY];
+}
+
+void mapLinkSlipgates(UBYTE ubIndexFirst, UBYTE ubIndexSecond) {
+	g_pSlipgates[ubIndexFirst].ubLinkedIndex = ubIndexSecond;
+	g_pSlipgates[ubIndexFirst].ubColor = SLIPGATE_A;
+	g_pSlipgates[ubIndexSecond].ubLinkedIndex = ubIndexFirst;
+	g_pSlipgates[ubIndexSecond].ubColor = SLIPGATE_B;
+}
+
 //------------------------------------------------------------------ GLOBAL VARS
 
-tSlipgate g_pSlipgates[3];
+tSlipgate g_pSlipgates[SLIPGATE_COUNT];
 tLevel g_sCurrentLevel;
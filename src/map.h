@@ -16,6 +16,7 @@
 #define MAP_TILE_HEIGHT 32
 #define MAP_USER_INTERACTIONS_MAX 10
 #define MAP_INTERACTIONS_MAX 10
+#define MAP_BUTTON_BITS 16
 #define MAP_BOXES_MAX 5
 #define MAP_TURRETS_MAX 5
 #define MAP_SPIKES_TILES_MAX 10
@@ -50,21 +51,67 @@ typedef struct tLevel {
 	char szStoryText[MAP_STORY_TEXT_MAX];
 } tLevel;
 
-extern tSlipgate g_pSlipgates[3];
+extern tSlipgate g_pSlipgates[SLIPGATE_COUNT];
 extern tLevel g_sCurrentLevel;
 
+/**
+ * @brief Opens level pack and reads its index. Pack stays open until
+ * mapCloseLevelPack() so that level loads only need to seek.
+ */
+void mapOpenLevelPack(void);
+
+void mapCloseLevelPack(void);
+
+/**
+ * @brief Starts reading given level from level pack in chunks, once level
+ * has been played for a while. One chunk is read per mapProcessIdle() call.
+ * Keeps progress if that level is already prefetched.
+ */
+void mapPrefetchLevel(UBYTE ubIndex);
+
+/**
+ * @brief Stops level prefetch and frees its buffer.
+ */
+void mapCancelLevelPrefetch(void);
+
+/**
+ * @brief Loads level from loose file in override dir if there is one,
+ * otherwise from level pack. Uses prefetched data if it's complete.
+ */
 UBYTE mapTryLoad(UBYTE ubIndex);
 
+/**
+ * @brief Saves current level as loose file in override dir.
+ */
 void mapSave(UBYTE ubIndex);
 
 void mapRestart(void);
 
 void mapProcess(void);
 
+/**
+ * @brief Runs low priority map work, e.g. level prefetch. Must be called only
+ * when there's spare time left in the frame.
+ */
+void mapProcessIdle(void);
+
+/**
+ * @brief Sets per-frame budget for deferrable map jobs, in roughly tile draws.
+ * Jobs over the budget are carried over to next frames.
+ */
+void mapSetJobBudget(UWORD uwBudget);
+
 void mapPressButtonAt(UBYTE ubX, UBYTE ubY);
 
 void mapPressButtonIndex(UBYTE ubButtonIndex);
 
+/**
+ * @brief Rebuilds button to interaction lookup used for evaluating only
+ * interactions affected by button state change. Must be called after
+ * editing interactions.
+ */
+void mapRebuildInteractionIndex(void);
+
 UWORD mapGetButtonPresses(void);
 
 void mapDisableTurretAt(UBYTE ubX, UBYTE ubY);
@@ -75,9 +122,22 @@ void mapRecalcAllVisTilesOnLevel(tLevel *pLevel);
 
 void mapRecalculateVisTilesNearTileAt(UBYTE ubTileX, UBYTE ubTileY);
 
+/**
+ * @brief Recalculates vis tiles after logic tiles in given rect have changed,
+ * along with ones bordering it. Only tiles with changed vis tile are redrawn.
+ *
+ * Rect corners are inclusive.
+ */
+void mapRecalculateVisTilesInRect(
+	UBYTE ubLeftX, UBYTE ubTopY, UBYTE ubRightX, UBYTE ubBottomY
+);
+
 UBYTE mapIsVistileDecorableBgAt(UBYTE ubTileX, UBYTE ubTileY);
 
-UBYTE mapIsSlipgateTunnelOpen(void);
+/**
+ * @brief Checks if given slipgate and the one linked to it are both placed.
+ */
+UBYTE mapIsSlipgateTunnelOpen(UBYTE ubIndex);
 
 //----------------------------------------------------------------------- EDITOR
 
@@ -138,6 +198,22 @@ UBYTE mapTrySpawnSlipgate(
 	UBYTE ubIndex, UBYTE ubTileX, UBYTE ubTileY, tDirection eNormal
 );
 
-void mapTryCloseSlipgateAt(UBYTE ubIndex, tUbCoordYX sPos);
+/**
+ * @brief Closes slipgate occupying given wall tile, if there is any.
+ */
+void mapTryCloseSlipgateAt(tUbCoordYX sPos);
+
+/**
+ * @brief Returns index of placed slipgate occupying given wall tile.
+ *
+ * @return Slipgate index, SLIPGATE_INDEX_NONE if there is no slipgate.
+ */
+UBYTE mapGetSlipgateIndexAt(UBYTE ubTileX, UBYTE ubTileY);
+
+/**
+ * @brief Links two slipgates into tunnel. First one is drawn as A, second as B.
+ * A and B are linked on level load, extra pairs need to be linked by caller.
+ */
+void mapLinkSlipgates(UBYTE ubIndexFirst, UBYTE ubIndexSecond);
 
 #endif // SLIPGATES_MAP_H
@@ -18,6 +18,7 @@
 #include "cutscene.h"
 #include "config.h"
 #include "twister.h"
+#include "chip_arena.h"
 
 // #define MENU_PREP_BG
 
@@ -317,7 +318,17 @@ static void menuGsCreate(void) {
 	s_pMenuLayerBack->Planes[0] = s_pMenuBfr->pBack->Planes[1];
 	s_pMenuLayerBack->Planes[1] = s_pMenuBfr->pBack->Planes[3];
 
-	s_pTextBuffer = fontCreateTextBitMap(336, g_pFont->uwHeight);
+	ULONG ulArenaSize = chipArenaGetTextBitMapSize(336, g_pFont->uwHeight);
+	if(!chipArenaOpen(CHIP_ARENA_SCOPE_STATE, ulArenaSize)) {
+		// Resident game assets are the only chip mem which can be given back
+		assetsGameEvict();
+		if(!chipArenaOpen(CHIP_ARENA_SCOPE_STATE, ulArenaSize)) {
+			systemKill("No chip mem for menu");
+		}
+	}
+	s_pTextBuffer = chipArenaTextBitMapCreate(
+		CHIP_ARENA_SCOPE_STATE, 336, g_pFont->uwHeight
+	);
 
 	spriteManagerCreate(s_pMenuView, 0);
 	s_pSpriteCrosshair = spriteAdd(0, g_pBmCursor);
@@ -373,7 +384,7 @@ static void menuGsDestroy(void) {
 	stateManagerDestroy(s_pMenuStateManager);
 	fadeDestroy(s_pFade);
 	spriteManagerDestroy();
-	fontDestroyTextBitMap(s_pTextBuffer);
+	chipArenaClose(CHIP_ARENA_SCOPE_STATE);
 	viewDestroy(s_pMenuView);
 }
 
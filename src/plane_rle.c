@@ -0,0 +1,61 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "plane_rle.h"
+
+const UBYTE *planeRleUnpack(
+	const UBYTE *pSrc, const UBYTE *pSrcEnd, UBYTE *pDst, UWORD uwSize
+) {
+	// Works in place as long as pDst doesn't overtake pSrc, packer ensures that
+	UBYTE *pDstStart = pDst;
+	UBYTE *pDstEnd = &pDst[uwSize];
+	while(pDst < pDstEnd) {
+		if(pSrc >= pSrcEnd) {
+			return 0;
+		}
+		UBYTE ubControl = *(pSrc++);
+		UWORD uwCount = ((ubControl & PLANE_RLE_COUNT_MASK) + 1) * sizeof(UWORD);
+		if(uwCount > pDstEnd - pDst) {
+			return 0;
+		}
+
+		const UBYTE *pCopySrc;
+		switch(ubControl & PLANE_RLE_OP_MASK) {
+			case PLANE_RLE_LITERAL:
+				if(uwCount > pSrcEnd - pSrc) {
+					return 0;
+				}
+				pCopySrc = pSrc;
+				pSrc += uwCount;
+				break;
+			case PLANE_RLE_FILL:
+				if(pSrcEnd - pSrc < (LONG)sizeof(UWORD)) {
+					return 0;
+				}
+				*(pDst++) = *(pSrc++);
+				*(pDst++) = *(pSrc++);
+				uwCount -= sizeof(UWORD);
+				pCopySrc = pDst - sizeof(UWORD);
+				break;
+			case PLANE_RLE_COPY_UP:
+				if(pDst - pDstStart < MAP_TILE_WIDTH * (LONG)sizeof(UWORD)) {
+					return 0;
+				}
+				pCopySrc = pDst - MAP_TILE_WIDTH * sizeof(UWORD);
+				break;
+			default: // PLANE_RLE_REPEAT
+				if(pDst == pDstStart) {
+					return 0;
+				}
+				pCopySrc = pDst - sizeof(UWORD);
+				break;
+		}
+
+		// Byte by byte since repeats overlap with their own output
+		while(uwCount--) {
+			*(pDst++) = *(pCopySrc++);
+		}
+	}
+	return pSrc;
+}
@@ -0,0 +1,35 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_PLANE_RLE_H
+#define SLIPGATES_PLANE_RLE_H
+
+#include "map.h"
+
+// Packed data is unpacked in place from the end of buffer, which needs to be
+// this much bigger than unpacked data. Packer rejects compression needing more.
+#define PLANE_RLE_UNPACK_MARGIN 32
+// Control byte with op in upper bits, word count - 1 in lower ones
+#define PLANE_RLE_OP_MASK 0xC0
+#define PLANE_RLE_COUNT_MASK 0x3F
+#define PLANE_RLE_LITERAL 0x00 // Words follow
+#define PLANE_RLE_FILL 0x40 // Single word follows, repeated count times
+#define PLANE_RLE_COPY_UP 0x80 // Copy words from row above, rows are MAP_TILE_WIDTH long
+#define PLANE_RLE_REPEAT 0xC0 // Repeat previous word
+
+/**
+ * @brief Unpacks level tile planes.
+ *
+ * @param pSrc Packed data.
+ * @param pSrcEnd End of packed data, unpacking fails if it's reached early.
+ * @param pDst Destination for unpacked planes. May be the start of buffer
+ * holding packed data at its end, with PLANE_RLE_UNPACK_MARGIN to spare.
+ * @param uwSize Size of unpacked planes.
+ * @return Pointer past last packed byte used, zero if data is malformed.
+ */
+const UBYTE *planeRleUnpack(
+	const UBYTE *pSrc, const UBYTE *pSrcEnd, UBYTE *pDst, UWORD uwSize
+);
+
+#endif // SLIPGATES_PLANE_RLE_H
@@ -29,7 +29,7 @@
 #define PLAYER_COYOTE_FRAMES_MAX 5
 
 static fix16_t s_fPlayerJumpVeloY = F16(-3);
-static UBYTE s_ubFrameCooldown;
+static tTimer s_sAnimTimer;
 static UBYTE s_ubAnimFrame;
 static tAnimFrameDef s_pBodyFrameAddresses[2][PLAYER_FRAME_COUNT];
 static tAnimFrameDef s_pArmFrameAddresses[GAME_MATH_ANGLE_COUNT / 4];
@@ -88,6 +88,44 @@ static UBYTE playerTryShootSlipgate(tPlayer *pPlayer, UBYTE ubIndex) {
 	return 1;
 }
 
+static void playerUpdateBodyFrame(tPlayer *pPlayer) {
+	UBYTE *pFrameData;
+	if(pPlayer->isInDamageFrame) {
+		pFrameData = g_pPlayerWhiteFrame->Planes[0];
+	}
+	else {
+		pFrameData = s_pBodyFrameAddresses[pPlayer->ubAnimDirection][0].pFrame;
+		// pFrameData = s_pBodyFrameAddresses[pPlayer->ubAnimDirection][s_ubAnimFrame].pFrame;
+	}
+	bobSetFrame(
+		&pPlayer->sBody.sBob,
+		pFrameData,
+		s_pBodyFrameAddresses[pPlayer->ubAnimDirection][0].pMask
+		// s_pBodyFrameAddresses[pPlayer->ubAnimDirection][s_ubAnimFrame].pMask
+	);
+}
+
+static void playerOnRegen(void *pData) {
+	tPlayer *pPlayer = pData;
+	pPlayer->bHealth = MIN(pPlayer->bHealth + 1, PLAYER_MAX_HEALTH);
+	timerWheelSchedule(&pPlayer->sRegenTimer, PLAYER_REGEN_COOLDOWN, playerOnRegen, pPlayer);
+}
+
+static void playerOnDamageFrameEnd(void *pData) {
+	tPlayer *pPlayer = pData;
+	pPlayer->isInDamageFrame = 0;
+	playerUpdateBodyFrame(pPlayer);
+}
+
+static void playerOnAnimFrame(void *pData) {
+	tPlayer *pPlayer = pData;
+	if(++s_ubAnimFrame == PLAYER_FRAME_COUNT) {
+		s_ubAnimFrame = 0;
+	}
+	playerUpdateBodyFrame(pPlayer);
+	timerWheelSchedule(&s_sAnimTimer, PLAYER_FRAME_COOLDOWN, playerOnAnimFrame, pPlayer);
+}
+
 //------------------------------------------------------------------- PUBLIC FNS
 
 void playerManagerInit(void) {
@@ -113,12 +151,13 @@ void playerReset(tPlayer *pPlayer, fix16_t fPosX, fix16_t fPosY) {
 	pPlayer->sBody.pHandlerData = pPlayer;
 	pPlayer->pGrabbedBox = 0;
 	pPlayer->bHealth = PLAYER_MAX_HEALTH;
-	pPlayer->ubDamageFrameCooldown = 0;
-	pPlayer->ubRegenCooldown = PLAYER_REGEN_COOLDOWN;
+	pPlayer->isInDamageFrame = 0;
 	pPlayer->ubAnimDirection = 0;
 	pPlayer->ubCoyoteFrames = 0;
 	s_ubAnimFrame = 0;
-	s_ubFrameCooldown = PLAYER_FRAME_COOLDOWN;
+	timerWheelCancel(&pPlayer->sDamageFrameTimer);
+	timerWheelSchedule(&pPlayer->sRegenTimer, PLAYER_REGEN_COOLDOWN, playerOnRegen, pPlayer);
+	timerWheelSchedule(&s_sAnimTimer, PLAYER_FRAME_COOLDOWN, playerOnAnimFrame, pPlayer);
 }
 
 void playerProcess(tPlayer *pPlayer) {
@@ -126,11 +165,6 @@ void playerProcess(tPlayer *pPlayer) {
 		return;
 	}
 
-	if(--pPlayer->ubRegenCooldown == 0) {
-		pPlayer->ubRegenCooldown = PLAYER_REGEN_COOLDOWN;
-		pPlayer->bHealth = MIN(pPlayer->bHealth + 1, PLAYER_MAX_HEALTH);
-	}
-
 	tUwCoordYX sPosCross = gameGetCrossPosition();
 	UWORD uwPlayerCenterX = fix16_to_int(pPlayer->sBody.fPosX) + pPlayer->sBody.ubWidth / 2;
 	UWORD uwPlayerCenterY = fix16_to_int(pPlayer->sBody.fPosY) + pPlayer->sBody.ubHeight / 2;
@@ -271,37 +305,6 @@ void playerProcess(tPlayer *pPlayer) {
 		}
 	}
 
-	UBYTE isUpdateFrame = 0;
-	if(pPlayer->ubDamageFrameCooldown) {
-		--pPlayer->ubDamageFrameCooldown;
-		isUpdateFrame = 1;
-	}
-
-	if(--s_ubFrameCooldown == 0) {
-		s_ubFrameCooldown = PLAYER_FRAME_COOLDOWN;
-		if(++s_ubAnimFrame == PLAYER_FRAME_COUNT) {
-			s_ubAnimFrame = 0;
-		}
-		isUpdateFrame = 1;
-	}
-
-	if(isUpdateFrame) {
-		UBYTE *pFrameData;
-		if(pPlayer->ubDamageFrameCooldown) {
-			pFrameData = g_pPlayerWhiteFrame->Planes[0];
-		}
-		else {
-			pFrameData = s_pBodyFrameAddresses[pPlayer->ubAnimDirection][0].pFrame;
-			// pFrameData = s_pBodyFrameAddresses[pPlayer->ubAnimDirection][s_ubAnimFrame].pFrame;
-		}
-		bobSetFrame(
-			&pPlayer->sBody.sBob,
-			pFrameData,
-			s_pBodyFrameAddresses[pPlayer->ubAnimDirection][0].pMask
-			// s_pBodyFrameAddresses[pPlayer->ubAnimDirection][s_ubAnimFrame].pMask
-		);
-	}
-
 	UBYTE ubArmFrame = ubAimAngle / 4;
 	bobSetFrame(
 		&pPlayer->sBobArm,
@@ -320,14 +323,23 @@ void playerProcessArm(tPlayer *pPlayer) {
 
 void playerDamage(tPlayer *pPlayer, UBYTE ubAmount) {
 	pPlayer->bHealth = MAX(0, pPlayer->bHealth - ubAmount);
-	pPlayer->ubDamageFrameCooldown = PLAYER_DAMAGE_COOLDOWN;
-	pPlayer->ubRegenCooldown = PLAYER_REGEN_COOLDOWN;
+	pPlayer->isInDamageFrame = 1;
 
 	UBYTE *pFrameData = g_pPlayerWhiteFrame->Planes[0];
 	pPlayer->sBody.sBob.pFrameData = pFrameData;
 
 	if(pPlayer->bHealth == 0) {
-		// ded
+		// ded - stays white and doesn't regenerate
 		pPlayer->sBody.fVelocityX = 0;
+		timerWheelCancel(&pPlayer->sDamageFrameTimer);
+		timerWheelCancel(&pPlayer->sRegenTimer);
+		timerWheelCancel(&s_sAnimTimer);
+	}
+	else {
+		timerWheelSchedule(
+			&pPlayer->sDamageFrameTimer, PLAYER_DAMAGE_COOLDOWN,
+			playerOnDamageFrameEnd, pPlayer
+		);
+		timerWheelSchedule(&pPlayer->sRegenTimer, PLAYER_REGEN_COOLDOWN, playerOnRegen, pPlayer);
 	}
 }
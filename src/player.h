@@ -6,6 +6,7 @@
 #define SLIPGATES_PLAYER_H
 
 #include "body_box.h"
+#include "timer_wheel.h"
 
 #define PLAYER_MAX_HEALTH 10
 
@@ -15,8 +16,9 @@ typedef struct tPlayer {
 	tBodyBox *pGrabbedBox;
 	BYTE bHealth;
 	UBYTE isSlipgated;
-	UBYTE ubDamageFrameCooldown;
-	UBYTE ubRegenCooldown;
+	UBYTE isInDamageFrame;
+	tTimer sDamageFrameTimer;
+	tTimer sRegenTimer;
 	UBYTE ubAnimDirection;
 	UBYTE ubCoyoteFrames;
 } tPlayer;
@@ -12,12 +12,17 @@
 #define SLIPGATE_A 0
 #define SLIPGATE_B 1
 #define SLIPGATE_AIM 2
+#define SLIPGATE_EXTRA_FIRST 3 // Additional linked pairs, placed by level logic
+#define SLIPGATE_COUNT 7
+#define SLIPGATE_INDEX_NONE 0xFF
 
 typedef struct tSlipgate {
 	tUbCoordYX sTilePositions[4]; // 0 is always top-left wall tile, 1 is other wall tile, 2-3 are bg tiles
 	UBYTE isAiming;
 	tDirection eNormal; // set to DIRECTION_NONE when is off
 	tTile pPrevTiles[2];
+	UBYTE ubLinkedIndex; // Other end of tunnel, SLIPGATE_INDEX_NONE if none
+	UBYTE ubColor; // SLIPGATE_A or SLIPGATE_B - selects gfx and logic tile
 } tSlipgate;
 
 UBYTE slipgateIsOccupyingTile(const tSlipgate *pSlipgate, tUbCoordYX sPos);
@@ -0,0 +1,136 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "slipgate_placement.h"
+
+// Tried in order, first one fitting given normal is used.
+// '+' - slipgatable, '.' - empty, '!' - solid, '?' - any, 'x' - hit tile.
+static const tSlipgatePlacement s_pSlipgatePlacements[] = {
+	{ // Left, hit on bottom tile
+		// ?! y-2
+		// .+ y-1
+		// .x y
+		// !? y+1
+		.eNormal = DIRECTION_LEFT,
+		.ulEmpty = SLIPGATE_PLACEMENT_WINDOW_BIT(-1, -1) | SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 0),
+		.ulSolid = SLIPGATE_PLACEMENT_WINDOW_BIT(0, -2) | SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 1),
+		.ulSlipgatable = SLIPGATE_PLACEMENT_WINDOW_BIT(0, -1),
+		.pTileOffsets = {{.bX = 0, .bY = -1}, {.bX = 0, .bY = 0}, {.bX = -1, .bY = -1}, {.bX = -1, .bY = 0}},
+	},
+	{ // Left, hit on top tile
+		// ?! y-1
+		// .x y
+		// .+ y+1
+		// ?! y+2
+		.eNormal = DIRECTION_LEFT,
+		.ulEmpty = SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 0) | SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 1),
+		.ulSolid = SLIPGATE_PLACEMENT_WINDOW_BIT(0, -1) | SLIPGATE_PLACEMENT_WINDOW_BIT(0, 2),
+		.ulSlipgatable = SLIPGATE_PLACEMENT_WINDOW_BIT(0, 1),
+		.pTileOffsets = {{.bX = 0, .bY = 0}, {.bX = 0, .bY = 1}, {.bX = -1, .bY = 0}, {.bX = -1, .bY = 1}},
+	},
+	{ // Right, hit on bottom tile
+		// !? y-2
+		// +. y-1
+		// x. y
+		// !? y+1
+		.eNormal = DIRECTION_RIGHT,
+		.ulEmpty = SLIPGATE_PLACEMENT_WINDOW_BIT(1, -1) | SLIPGATE_PLACEMENT_WINDOW_BIT(1, 0),
+		.ulSolid = SLIPGATE_PLACEMENT_WINDOW_BIT(0, -2) | SLIPGATE_PLACEMENT_WINDOW_BIT(0, 1),
+		.ulSlipgatable = SLIPGATE_PLACEMENT_WINDOW_BIT(0, -1),
+		.pTileOffsets = {{.bX = 0, .bY = -1}, {.bX = 0, .bY = 0}, {.bX = 1, .bY = -1}, {.bX = 1, .bY = 0}},
+	},
+	{ // Right, hit on top tile
+		// !? y-1
+		// x. y
+		// +. y+1
+		// !? y+2
+		.eNormal = DIRECTION_RIGHT,
+		.ulEmpty = SLIPGATE_PLACEMENT_WINDOW_BIT(1, 0) | SLIPGATE_PLACEMENT_WINDOW_BIT(1, 1),
+		.ulSolid = SLIPGATE_PLACEMENT_WINDOW_BIT(0, -1) | SLIPGATE_PLACEMENT_WINDOW_BIT(0, 2),
+		.ulSlipgatable = SLIPGATE_PLACEMENT_WINDOW_BIT(0, 1),
+		.pTileOffsets = {{.bX = 0, .bY = 0}, {.bX = 0, .bY = 1}, {.bX = 1, .bY = 0}, {.bX = 1, .bY = 1}},
+	},
+	{ // Up, hit on left tile
+		// ?..? y-1
+		// !x+! y
+		.eNormal = DIRECTION_UP,
+		.ulEmpty = SLIPGATE_PLACEMENT_WINDOW_BIT(0, -1) | SLIPGATE_PLACEMENT_WINDOW_BIT(1, -1),
+		.ulSolid = SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 0) | SLIPGATE_PLACEMENT_WINDOW_BIT(2, 0),
+		.ulSlipgatable = SLIPGATE_PLACEMENT_WINDOW_BIT(1, 0),
+		.pTileOffsets = {{.bX = 0, .bY = 0}, {.bX = 1, .bY = 0}, {.bX = 0, .bY = -1}, {.bX = 1, .bY = -1}},
+	},
+	{ // Up, hit on right tile
+		// ?..? y-1
+		// !+x! y
+		.eNormal = DIRECTION_UP,
+		.ulEmpty = SLIPGATE_PLACEMENT_WINDOW_BIT(-1, -1) | SLIPGATE_PLACEMENT_WINDOW_BIT(0, -1),
+		.ulSolid = SLIPGATE_PLACEMENT_WINDOW_BIT(-2, 0) | SLIPGATE_PLACEMENT_WINDOW_BIT(1, 0),
+		.ulSlipgatable = SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 0),
+		.pTileOffsets = {{.bX = -1, .bY = 0}, {.bX = 0, .bY = 0}, {.bX = -1, .bY = -1}, {.bX = 0, .bY = -1}},
+	},
+	{ // Down, hit on left tile
+		// !x+! y
+		// ?..? y+1
+		.eNormal = DIRECTION_DOWN,
+		.ulEmpty = SLIPGATE_PLACEMENT_WINDOW_BIT(0, 1) | SLIPGATE_PLACEMENT_WINDOW_BIT(1, 1),
+		.ulSolid = SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 0) | SLIPGATE_PLACEMENT_WINDOW_BIT(2, 0),
+		.ulSlipgatable = SLIPGATE_PLACEMENT_WINDOW_BIT(1, 0),
+		.pTileOffsets = {{.bX = 0, .bY = 0}, {.bX = 1, .bY = 0}, {.bX = 0, .bY = 1}, {.bX = 1, .bY = 1}},
+	},
+	{ // Down, hit on right tile
+		// !+x! y
+		// ?..? y+1
+		.eNormal = DIRECTION_DOWN,
+		.ulEmpty = SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 1) | SLIPGATE_PLACEMENT_WINDOW_BIT(0, 1),
+		.ulSolid = SLIPGATE_PLACEMENT_WINDOW_BIT(-2, 0) | SLIPGATE_PLACEMENT_WINDOW_BIT(1, 0),
+		.ulSlipgatable = SLIPGATE_PLACEMENT_WINDOW_BIT(-1, 0),
+		.pTileOffsets = {{.bX = -1, .bY = 0}, {.bX = 0, .bY = 0}, {.bX = -1, .bY = 1}, {.bX = 0, .bY = 1}},
+	},
+};
+#define SLIPGATE_PLACEMENT_COUNT (sizeof(s_pSlipgatePlacements) / sizeof(s_pSlipgatePlacements[0]))
+
+static void slipgatePlacementGetWindowAt(
+	const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
+	ULONG *pEmpty, ULONG *pSlipgatable
+) {
+	// Tiles outside the map count as solid and non-slipgatable
+	ULONG ulEmpty = 0, ulSlipgatable = 0;
+	for(BYTE bY = -SLIPGATE_PLACEMENT_WINDOW_RADIUS; bY <= SLIPGATE_PLACEMENT_WINDOW_RADIUS; ++bY) {
+		for(BYTE bX = -SLIPGATE_PLACEMENT_WINDOW_RADIUS; bX <= SLIPGATE_PLACEMENT_WINDOW_RADIUS; ++bX) {
+			WORD wX = ubTileX + bX;
+			WORD wY = ubTileY + bY;
+			if(wX < 0 || wX >= MAP_TILE_WIDTH || wY < 0 || wY >= MAP_TILE_HEIGHT) {
+				continue;
+			}
+			tTile eTile = pLevel->pTiles[wX][wY];
+			if(eTile == TILE_BG) {
+				ulEmpty |= SLIPGATE_PLACEMENT_WINDOW_BIT(bX, bY);
+			}
+			if(eTile & TILE_LAYER_SLIPGATABLE) {
+				ulSlipgatable |= SLIPGATE_PLACEMENT_WINDOW_BIT(bX, bY);
+			}
+		}
+	}
+	*pEmpty = ulEmpty;
+	*pSlipgatable = ulSlipgatable;
+}
+
+const tSlipgatePlacement *slipgatePlacementFind(
+	const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY, tDirection eNormal
+) {
+	ULONG ulEmpty, ulSlipgatable;
+	slipgatePlacementGetWindowAt(pLevel, ubTileX, ubTileY, &ulEmpty, &ulSlipgatable);
+	for(UBYTE i = 0; i < SLIPGATE_PLACEMENT_COUNT; ++i) {
+		const tSlipgatePlacement *pPlacement = &s_pSlipgatePlacements[i];
+		if(
+			pPlacement->eNormal == eNormal &&
+			(ulEmpty & pPlacement->ulEmpty) == pPlacement->ulEmpty &&
+			(ulEmpty & pPlacement->ulSolid) == 0 &&
+			(ulSlipgatable & pPlacement->ulSlipgatable) == pPlacement->ulSlipgatable
+		) {
+			return pPlacement;
+		}
+	}
+	return 0;
+}
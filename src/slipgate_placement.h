@@ -0,0 +1,41 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_SLIPGATE_PLACEMENT_H
+#define SLIPGATES_SLIPGATE_PLACEMENT_H
+
+#include "map.h"
+
+#define SLIPGATE_PLACEMENT_WINDOW_RADIUS 2
+#define SLIPGATE_PLACEMENT_WINDOW_SIZE (2 * SLIPGATE_PLACEMENT_WINDOW_RADIUS + 1)
+#define SLIPGATE_PLACEMENT_WINDOW_BIT(bX, bY) BV( \
+	((bY) + SLIPGATE_PLACEMENT_WINDOW_RADIUS) * SLIPGATE_PLACEMENT_WINDOW_SIZE + \
+	(bX) + SLIPGATE_PLACEMENT_WINDOW_RADIUS \
+)
+
+typedef struct tSlipgatePlacement {
+	tDirection eNormal;
+	// Tile window masks around hit tile, see SLIPGATE_PLACEMENT_WINDOW_BIT()
+	ULONG ulEmpty;
+	ULONG ulSolid;
+	ULONG ulSlipgatable;
+	tBCoordYX pTileOffsets[4]; // Same order as tSlipgate.sTilePositions
+} tSlipgatePlacement;
+
+/**
+ * @brief Finds how slipgate would be placed after hitting given tile.
+ * Tiles outside the map count as solid and non-slipgatable.
+ *
+ * @param pLevel Level with tiles to be checked.
+ * @param ubTileX X of hit tile.
+ * @param ubTileY Y of hit tile.
+ * @param eNormal Normal of hit tile's side.
+ * @return Placement with offsets of slipgate tiles relative to hit tile,
+ * zero if slipgate doesn't fit there.
+ */
+const tSlipgatePlacement *slipgatePlacementFind(
+	const tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY, tDirection eNormal
+);
+
+#endif // SLIPGATES_SLIPGATE_PLACEMENT_H
@@ -15,6 +15,7 @@
 #include "game.h"
 #include "assets.h"
 #include "config.h"
+#include "chip_arena.h"
 
 tStateManager *g_pGameStateManager;
 
@@ -43,6 +44,14 @@ void genericProcess(void) {
 void genericDestroy(void) {
 	assetsGlobalDestroy();
 	stateManagerDestroy(g_pGameStateManager);
+	// Game state may have left its assets resident
+	assetsGameDestroy();
+	const tAssetsResidencyStats *pStats = assetsGetResidencyStats();
+	logWrite(
+		"Game assets residency: %hu hits, %hu misses, %hu evictions\n",
+		pStats->uwHits, pStats->uwMisses, pStats->uwEvictions
+	);
+	chipArenaLogStats();
 	keyDestroy();
 	mouseDestroy();
 	audioMixerDestroy();
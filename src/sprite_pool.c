@@ -0,0 +1,131 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "sprite_pool.h"
+
+typedef struct tSpritePoolRect {
+	WORD wX;
+	WORD wY;
+	UWORD uwWidth;
+	UWORD uwHeight;
+} tSpritePoolRect;
+
+static tSpritePoolEntry s_pEntries[SPRITE_POOL_OBJECTS_MAX];
+static UBYTE s_pSortedHandles[SPRITE_POOL_OBJECTS_MAX];
+static UBYTE s_ubEntryCount;
+static tSpritePoolRect s_pOccluders[SPRITE_POOL_OCCLUDERS_MAX];
+static UBYTE s_ubOccluderCount;
+static UBYTE s_ubChannelFirst;
+static UBYTE s_ubChannelCount;
+
+void spritePoolInit(UBYTE ubChannelFirst, UBYTE ubChannelCount) {
+	s_ubChannelFirst = ubChannelFirst;
+	if(ubChannelFirst + ubChannelCount > SPRITE_POOL_CHANNELS_MAX) {
+		ubChannelCount = SPRITE_POOL_CHANNELS_MAX - ubChannelFirst;
+	}
+	s_ubChannelCount = ubChannelCount;
+	s_ubEntryCount = 0;
+	s_ubOccluderCount = 0;
+}
+
+void spritePoolReset(void) {
+	s_ubEntryCount = 0;
+	s_ubOccluderCount = 0;
+}
+
+static UBYTE spritePoolIsOccluded(const tSpritePoolEntry *pEntry) {
+	for(UBYTE i = 0; i < s_ubOccluderCount; ++i) {
+		const tSpritePoolRect *pRect = &s_pOccluders[i];
+		if(
+			pEntry->wX < pRect->wX + pRect->uwWidth &&
+			pRect->wX < pEntry->wX + SPRITE_POOL_SPRITE_WIDTH &&
+			pEntry->wY < pRect->wY + pRect->uwHeight &&
+			pRect->wY < pEntry->wY + pEntry->ubHeight
+		) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void spritePoolAddOccluder(WORD wX, WORD wY, UWORD uwWidth, UWORD uwHeight) {
+	if(s_ubOccluderCount >= SPRITE_POOL_OCCLUDERS_MAX) {
+		return;
+	}
+
+	tSpritePoolRect *pRect = &s_pOccluders[s_ubOccluderCount++];
+	pRect->wX = wX;
+	pRect->wY = wY;
+	pRect->uwWidth = uwWidth;
+	pRect->uwHeight = uwHeight;
+}
+
+UBYTE spritePoolPush(WORD wX, WORD wY, UBYTE ubHeight, UBYTE ubFrame) {
+	if(s_ubEntryCount >= SPRITE_POOL_OBJECTS_MAX) {
+		return SPRITE_POOL_HANDLE_NONE;
+	}
+
+	UBYTE ubHandle = s_ubEntryCount++;
+	tSpritePoolEntry *pEntry = &s_pEntries[ubHandle];
+	pEntry->wX = wX;
+	pEntry->wY = wY;
+	pEntry->ubHeight = ubHeight;
+	pEntry->ubFrame = ubFrame;
+	pEntry->ubChannel = SPRITE_POOL_CHANNEL_NONE;
+	return ubHandle;
+}
+
+UBYTE spritePoolAssign(void) {
+	// Insertion sort by Y - there are only a few objects
+	for(UBYTE i = 0; i < s_ubEntryCount; ++i) {
+		UBYTE j = i;
+		while(j && s_pEntries[s_pSortedHandles[j - 1]].wY > s_pEntries[i].wY) {
+			s_pSortedHandles[j] = s_pSortedHandles[j - 1];
+			--j;
+		}
+		s_pSortedHandles[j] = i;
+	}
+
+	// First line on which each channel is free again
+	WORD pChannelFreeY[SPRITE_POOL_CHANNELS_MAX];
+	for(UBYTE ubChannel = 0; ubChannel < s_ubChannelCount; ++ubChannel) {
+		pChannelFreeY[ubChannel] = -32768;
+	}
+
+	// Going top to bottom, first free channel is always as good as any other
+	UBYTE ubUnassignedCount = 0;
+	for(UBYTE i = 0; i < s_ubEntryCount; ++i) {
+		tSpritePoolEntry *pEntry = &s_pEntries[s_pSortedHandles[i]];
+		pEntry->ubChannel = SPRITE_POOL_CHANNEL_NONE;
+		// Occluded object doesn't take its channel's lines, so that ones
+		// below it may still use it
+		UBYTE ubChannelCount = spritePoolIsOccluded(pEntry) ? 0 : s_ubChannelCount;
+		for(UBYTE ubChannel = 0; ubChannel < ubChannelCount; ++ubChannel) {
+			if(pChannelFreeY[ubChannel] <= pEntry->wY) {
+				pEntry->ubChannel = s_ubChannelFirst + ubChannel;
+				pChannelFreeY[ubChannel] = pEntry->wY + pEntry->ubHeight + SPRITE_POOL_REUSE_GAP;
+				break;
+			}
+		}
+		if(pEntry->ubChannel == SPRITE_POOL_CHANNEL_NONE) {
+			++ubUnassignedCount;
+		}
+	}
+	return ubUnassignedCount;
+}
+
+UBYTE spritePoolGetChannel(UBYTE ubHandle) {
+	if(ubHandle >= s_ubEntryCount) {
+		return SPRITE_POOL_CHANNEL_NONE;
+	}
+	return s_pEntries[ubHandle].ubChannel;
+}
+
+UBYTE spritePoolGetCount(void) {
+	return s_ubEntryCount;
+}
+
+const tSpritePoolEntry *spritePoolGetSorted(UBYTE ubIndex) {
+	return &s_pEntries[s_pSortedHandles[ubIndex]];
+}
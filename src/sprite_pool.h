@@ -0,0 +1,79 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_SPRITE_POOL_H
+#define SLIPGATES_SPRITE_POOL_H
+
+#include <ace/types.h>
+
+#define SPRITE_POOL_OBJECTS_MAX 8
+#define SPRITE_POOL_CHANNELS_MAX 8
+#define SPRITE_POOL_CHANNEL_NONE 0xFF
+#define SPRITE_POOL_OCCLUDERS_MAX 2
+#define SPRITE_POOL_SPRITE_WIDTH 16
+#define SPRITE_POOL_HANDLE_NONE 0xFF
+
+// Hardware needs one blank line after sprite to fetch next control words
+#define SPRITE_POOL_REUSE_GAP 1
+
+typedef struct tSpritePoolEntry {
+	WORD wX;
+	WORD wY;
+	UBYTE ubHeight;
+	UBYTE ubFrame;
+	UBYTE ubChannel;
+} tSpritePoolEntry;
+
+/**
+ * @brief Sets up range of hardware channels available for multiplexing.
+ * Doesn't use any hardware - allocation logic is platform-independent.
+ *
+ * @param ubChannelFirst First channel to be used.
+ * @param ubChannelCount Number of consecutive channels to be used.
+ */
+void spritePoolInit(UBYTE ubChannelFirst, UBYTE ubChannelCount);
+
+/**
+ * @brief Removes all objects and occluders requested in previous frame.
+ */
+void spritePoolReset(void);
+
+/**
+ * @brief Marks area in which objects must not get any sprite for current frame.
+ * Sprites are always displayed above playfield, so objects overlapping bobs
+ * which should be drawn over them need to be drawn as bobs too.
+ */
+void spritePoolAddOccluder(WORD wX, WORD wY, UWORD uwWidth, UWORD uwHeight);
+
+/**
+ * @brief Requests sprite for object in current frame.
+ *
+ * @return Handle to be passed to spritePoolGetChannel(),
+ * SPRITE_POOL_HANDLE_NONE if pool is full.
+ */
+UBYTE spritePoolPush(WORD wX, WORD wY, UBYTE ubHeight, UBYTE ubFrame);
+
+/**
+ * @brief Assigns channels to all pushed objects outside occluders,
+ * reusing each channel vertically when objects don't overlap.
+ *
+ * @return Number of objects which didn't get any channel.
+ */
+UBYTE spritePoolAssign(void);
+
+/**
+ * @brief Returns channel assigned to object or SPRITE_POOL_CHANNEL_NONE,
+ * in which case object needs to be drawn by other means.
+ */
+UBYTE spritePoolGetChannel(UBYTE ubHandle);
+
+UBYTE spritePoolGetCount(void);
+
+/**
+ * @brief Returns object in ascending Y order, so that objects sharing
+ * the same channel can be chained in order they appear on screen.
+ */
+const tSpritePoolEntry *spritePoolGetSorted(UBYTE ubIndex);
+
+#endif // SLIPGATES_SPRITE_POOL_H
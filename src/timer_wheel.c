@@ -0,0 +1,89 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "timer_wheel.h"
+#include "game.h"
+
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_SLOT_COUNT - 1)
+
+static tTimer *s_pSlots[TIMER_WHEEL_SLOT_COUNT];
+
+void timerWheelReset(void) {
+	for(UBYTE ubSlot = 0; ubSlot < TIMER_WHEEL_SLOT_COUNT; ++ubSlot) {
+		for(tTimer *pTimer = s_pSlots[ubSlot]; pTimer; pTimer = pTimer->pNext) {
+			pTimer->isScheduled = 0;
+		}
+		s_pSlots[ubSlot] = 0;
+	}
+}
+
+void timerWheelSchedule(
+	tTimer *pTimer, UWORD uwDelay, tCbTimer cbOnExpire, void *pData
+) {
+	if(pTimer->isScheduled) {
+		timerWheelCancel(pTimer);
+	}
+	if(!uwDelay) {
+		// Slot for current frame may be already processed
+		uwDelay = 1;
+	}
+
+	pTimer->cbOnExpire = cbOnExpire;
+	pTimer->pData = pData;
+	pTimer->uwExpireFrame = gameGetFrameIndex() + uwDelay;
+	pTimer->isScheduled = 1;
+
+	UBYTE ubSlot = pTimer->uwExpireFrame & TIMER_WHEEL_SLOT_MASK;
+	pTimer->pNext = s_pSlots[ubSlot];
+	s_pSlots[ubSlot] = pTimer;
+}
+
+void timerWheelCancel(tTimer *pTimer) {
+	if(!pTimer->isScheduled) {
+		return;
+	}
+
+	tTimer **ppLink = &s_pSlots[pTimer->uwExpireFrame & TIMER_WHEEL_SLOT_MASK];
+	while(*ppLink) {
+		if(*ppLink == pTimer) {
+			*ppLink = pTimer->pNext;
+			break;
+		}
+		ppLink = &(*ppLink)->pNext;
+	}
+	pTimer->isScheduled = 0;
+}
+
+void timerWheelMove(tTimer *pFrom, tTimer *pTo, void *pData) {
+	// Copy may have old link fields, which must not be used for unlinking
+	pTo->isScheduled = 0;
+	if(!pFrom->isScheduled) {
+		return;
+	}
+	UWORD uwDelay = pFrom->uwExpireFrame - gameGetFrameIndex();
+	tCbTimer cbOnExpire = pFrom->cbOnExpire;
+	timerWheelCancel(pFrom);
+	timerWheelSchedule(pTo, uwDelay, cbOnExpire, pData);
+}
+
+void timerWheelProcess(void) {
+	UWORD uwFrame = gameGetFrameIndex();
+	UBYTE ubSlot = uwFrame & TIMER_WHEEL_SLOT_MASK;
+	tTimer **ppLink = &s_pSlots[ubSlot];
+	while(*ppLink) {
+		tTimer *pTimer = *ppLink;
+		if(pTimer->uwExpireFrame != uwFrame) {
+			// Expires on one of next wheel revolutions
+			ppLink = &pTimer->pNext;
+			continue;
+		}
+
+		*ppLink = pTimer->pNext;
+		pTimer->isScheduled = 0;
+		pTimer->cbOnExpire(pTimer->pData);
+
+		// Callback could have (re)scheduled or cancelled timers in this slot
+		ppLink = &s_pSlots[ubSlot];
+	}
+}
@@ -0,0 +1,53 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TIMER_WHEEL_H
+#define SLIPGATES_TIMER_WHEEL_H
+
+#include <ace/types.h>
+
+#define TIMER_WHEEL_SLOT_COUNT 64
+
+typedef void (*tCbTimer)(void *pData);
+
+// Storage is owned by scheduling system, wheel only links it in its slots
+typedef struct tTimer {
+	struct tTimer *pNext;
+	tCbTimer cbOnExpire;
+	void *pData;
+	UWORD uwExpireFrame;
+	UBYTE isScheduled;
+} tTimer;
+
+/**
+ * @brief Drops all scheduled timers. Must be called whenever game frame
+ * index is reset.
+ */
+void timerWheelReset(void);
+
+/**
+ * @brief Schedules callback after given number of frames, counted by
+ * gameGetFrameIndex(). Already scheduled timer is rescheduled.
+ */
+void timerWheelSchedule(
+	tTimer *pTimer, UWORD uwDelay, tCbTimer cbOnExpire, void *pData
+);
+
+void timerWheelCancel(tTimer *pTimer);
+
+/**
+ * @brief Relinks timer after its storage was copied elsewhere, keeping its
+ * callback and remaining delay. Timer at old address is cancelled.
+ *
+ * @param pData New data passed to callback, e.g. copy's owner.
+ */
+void timerWheelMove(tTimer *pFrom, tTimer *pTo, void *pData);
+
+/**
+ * @brief Fires timers expiring in current frame. Only one slot of the wheel
+ * is visited, so frames without expiring timers cost almost nothing.
+ */
+void timerWheelProcess(void);
+
+#endif // SLIPGATES_TIMER_WHEEL_H
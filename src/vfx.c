@@ -6,6 +6,7 @@
 #include <ace/managers/bob.h>
 #include "assets.h"
 #include "anim_frame_def.h"
+#include "timer_wheel.h"
 
 #define VFX_SLIP_COOLDOWN 2
 #define VFX_SLIP_FRAME_COUNT 4
@@ -13,10 +14,27 @@
 
 static tBob s_pVfxSlipBobs[2];
 static UBYTE s_ubVfxSlipFrame;
-static UBYTE s_ubVfxSlipCooldown;
-static UBYTE s_ubVfxSlipIndexSrc;
+static tTimer s_sVfxSlipTimer;
+static UBYTE s_ubVfxSlipColorSrc;
 static tAnimFrameDef s_pVfxSlipOffsets[2][VFX_SLIP_FRAME_COUNT];
 
+static void vfxOnSlipFrame(UNUSED_ARG void *pData) {
+	if(++s_ubVfxSlipFrame >= VFX_SLIP_FRAME_COUNT) {
+		return;
+	}
+	timerWheelSchedule(&s_sVfxSlipTimer, VFX_SLIP_COOLDOWN, vfxOnSlipFrame, 0);
+	bobSetFrame(
+		&s_pVfxSlipBobs[s_ubVfxSlipColorSrc],
+		s_pVfxSlipOffsets[s_ubVfxSlipColorSrc][s_ubVfxSlipFrame].pFrame,
+		s_pVfxSlipOffsets[s_ubVfxSlipColorSrc][s_ubVfxSlipFrame].pMask
+	);
+	bobSetFrame(
+		&s_pVfxSlipBobs[!s_ubVfxSlipColorSrc],
+		s_pVfxSlipOffsets[!s_ubVfxSlipColorSrc][s_ubVfxSlipFrame].pFrame,
+		s_pVfxSlipOffsets[!s_ubVfxSlipColorSrc][s_ubVfxSlipFrame].pMask
+	);
+}
+
 void vfxInit(void) {
 	for(UBYTE i = 0; i < 2; ++i) {
 		for(UBYTE f = 0; f < 4; ++f) {
@@ -33,50 +51,39 @@ void vfxInit(void) {
 
 	bobInit(&s_pVfxSlipBobs[0], VFX_SLIP_FRAME_SIZE, VFX_SLIP_FRAME_SIZE, 1, 0, 0, 0, 0);
 	bobInit(&s_pVfxSlipBobs[1], VFX_SLIP_FRAME_SIZE, VFX_SLIP_FRAME_SIZE, 1, 0, 0, 0, 0);
+	vfxReset();
+}
+
+void vfxReset(void) {
+	timerWheelCancel(&s_sVfxSlipTimer);
 	s_ubVfxSlipFrame = VFX_SLIP_FRAME_COUNT;
 }
 
 void vfxProcess(void) {
 	if(s_ubVfxSlipFrame < VFX_SLIP_FRAME_COUNT) {
-		if(!--s_ubVfxSlipCooldown) {
-			if(++s_ubVfxSlipFrame >= VFX_SLIP_FRAME_COUNT) {
-				return;
-			}
-			s_ubVfxSlipCooldown = VFX_SLIP_COOLDOWN;
-			bobSetFrame(
-				&s_pVfxSlipBobs[s_ubVfxSlipIndexSrc],
-				s_pVfxSlipOffsets[s_ubVfxSlipIndexSrc][s_ubVfxSlipFrame].pFrame,
-				s_pVfxSlipOffsets[s_ubVfxSlipIndexSrc][s_ubVfxSlipFrame].pMask
-			);
-			bobSetFrame(
-				&s_pVfxSlipBobs[!s_ubVfxSlipIndexSrc],
-				s_pVfxSlipOffsets[!s_ubVfxSlipIndexSrc][s_ubVfxSlipFrame].pFrame,
-				s_pVfxSlipOffsets[!s_ubVfxSlipIndexSrc][s_ubVfxSlipFrame].pMask
-			);
-		}
 		bobPush(&s_pVfxSlipBobs[0]);
 		bobPush(&s_pVfxSlipBobs[1]);
 	}
 }
 
 void vfxStartSlipgate(
-	UBYTE ubIndexSrc, UWORD uwStartX, UWORD uwStartY, UWORD uwEndX, UWORD uwEndY
+	UBYTE ubColorSrc, UWORD uwStartX, UWORD uwStartY, UWORD uwEndX, UWORD uwEndY
 ) {
-	s_ubVfxSlipIndexSrc = ubIndexSrc;
-	s_pVfxSlipBobs[ubIndexSrc].sPos.uwX = uwStartX;
-	s_pVfxSlipBobs[ubIndexSrc].sPos.uwY = uwStartY;
+	s_ubVfxSlipColorSrc = ubColorSrc;
+	s_pVfxSlipBobs[ubColorSrc].sPos.uwX = uwStartX;
+	s_pVfxSlipBobs[ubColorSrc].sPos.uwY = uwStartY;
 	bobSetFrame(
-		&s_pVfxSlipBobs[ubIndexSrc],
-		s_pVfxSlipOffsets[ubIndexSrc][0].pFrame,
-		s_pVfxSlipOffsets[ubIndexSrc][0].pMask
+		&s_pVfxSlipBobs[ubColorSrc],
+		s_pVfxSlipOffsets[ubColorSrc][0].pFrame,
+		s_pVfxSlipOffsets[ubColorSrc][0].pMask
 	);
-	s_pVfxSlipBobs[!ubIndexSrc].sPos.uwX = uwEndX;
-	s_pVfxSlipBobs[!ubIndexSrc].sPos.uwY = uwEndY;
+	s_pVfxSlipBobs[!ubColorSrc].sPos.uwX = uwEndX;
+	s_pVfxSlipBobs[!ubColorSrc].sPos.uwY = uwEndY;
 	bobSetFrame(
-		&s_pVfxSlipBobs[!ubIndexSrc],
-		s_pVfxSlipOffsets[!ubIndexSrc][0].pFrame,
-		s_pVfxSlipOffsets[!ubIndexSrc][0].pMask
+		&s_pVfxSlipBobs[!ubColorSrc],
+		s_pVfxSlipOffsets[!ubColorSrc][0].pFrame,
+		s_pVfxSlipOffsets[!ubColorSrc][0].pMask
 	);
 	s_ubVfxSlipFrame = 0;
-	s_ubVfxSlipCooldown = VFX_SLIP_COOLDOWN;
+	timerWheelSchedule(&s_sVfxSlipTimer, VFX_SLIP_COOLDOWN, vfxOnSlipFrame, 0);
 }
@@ -9,10 +9,17 @@
 
 void vfxInit(void);
 
+void vfxReset(void);
+
 void vfxProcess(void);
 
+/**
+ * @brief Starts slipgate travel effect.
+ *
+ * @param ubColorSrc Color of source slipgate - SLIPGATE_A or SLIPGATE_B.
+ */
 void vfxStartSlipgate(
-	UBYTE ubIndexSrc, UWORD uwStartX, UWORD uwStartY, UWORD uwEndX, UWORD uwEndY
+	UBYTE ubColorSrc, UWORD uwStartX, UWORD uwStartY, UWORD uwEndX, UWORD uwEndY
 );
 
 #endif // SLIPGATES_VFX_H
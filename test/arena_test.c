@@ -0,0 +1,91 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "test.h"
+#include "arena.h"
+
+// Checks block alignment and bounds of arena allocations, as chip arena
+// relies on them for blitter and for its size checks.
+
+#define STORAGE_SIZE 64
+
+static ULONG s_pStorage[STORAGE_SIZE / sizeof(ULONG)];
+
+static ULONG getOffset(const tArena *pArena, const void *pBlock) {
+	return (const UBYTE*)pBlock - pArena->pBase;
+}
+
+static void testAlignment(void) {
+	tArena sArena = {0};
+	arenaInit(&sArena, s_pStorage, STORAGE_SIZE);
+
+	// Each block starts on next ARENA_ALIGNMENT boundary
+	const ULONG pSizes[] = {1, ARENA_ALIGNMENT, ARENA_ALIGNMENT + 1, 3};
+	const ULONG pOffsets[] = {0, ARENA_ALIGNMENT, 2 * ARENA_ALIGNMENT, 4 * ARENA_ALIGNMENT};
+	for(UBYTE i = 0; i < sizeof(pSizes) / sizeof(pSizes[0]); ++i) {
+		void *pBlock = arenaAlloc(&sArena, pSizes[i]);
+		TEST_CHECK(pBlock);
+		TEST_CHECK_EQUAL(getOffset(&sArena, pBlock), pOffsets[i]);
+	}
+	TEST_CHECK_EQUAL(sArena.ulUsed, 5 * ARENA_ALIGNMENT);
+
+	TEST_CHECK_EQUAL(ARENA_ALIGN(0), 0);
+	TEST_CHECK_EQUAL(ARENA_ALIGN(1), ARENA_ALIGNMENT);
+	TEST_CHECK_EQUAL(ARENA_ALIGN(ARENA_ALIGNMENT), ARENA_ALIGNMENT);
+}
+
+static void testExhaustion(void) {
+	tArena sArena = {0};
+	arenaInit(&sArena, s_pStorage, STORAGE_SIZE);
+
+	// Whole storage can be used up exactly
+	TEST_CHECK(arenaAlloc(&sArena, STORAGE_SIZE - ARENA_ALIGNMENT));
+	TEST_CHECK(!arenaAlloc(&sArena, ARENA_ALIGNMENT + 1));
+	TEST_CHECK_EQUAL(sArena.ulUsed, STORAGE_SIZE - ARENA_ALIGNMENT);
+	void *pLast = arenaAlloc(&sArena, ARENA_ALIGNMENT);
+	TEST_CHECK(pLast);
+	TEST_CHECK_EQUAL(getOffset(&sArena, pLast), STORAGE_SIZE - ARENA_ALIGNMENT);
+	TEST_CHECK_EQUAL(sArena.ulUsed, STORAGE_SIZE);
+	TEST_CHECK(!arenaAlloc(&sArena, 1));
+	TEST_CHECK_EQUAL(sArena.ulUsed, STORAGE_SIZE);
+}
+
+static void testOverflow(void) {
+	tArena sArena = {0};
+	arenaInit(&sArena, s_pStorage, STORAGE_SIZE);
+	TEST_CHECK(arenaAlloc(&sArena, 1));
+
+	// Sizes which wrap around when aligned or added to used size
+	TEST_CHECK(!arenaAlloc(&sArena, 0xFFFFFFFF));
+	TEST_CHECK(!arenaAlloc(&sArena, 0xFFFFFFFF - ARENA_ALIGNMENT + 2));
+	TEST_CHECK(!arenaAlloc(&sArena, 0xFFFFFFFF - ARENA_ALIGNMENT + 1));
+	TEST_CHECK_EQUAL(sArena.ulUsed, ARENA_ALIGNMENT);
+}
+
+static void testHighWater(void) {
+	tArena sArena = {0};
+	arenaInit(&sArena, s_pStorage, STORAGE_SIZE);
+	arenaAlloc(&sArena, 3 * ARENA_ALIGNMENT);
+	TEST_CHECK_EQUAL(sArena.ulHighWater, 3 * ARENA_ALIGNMENT);
+
+	// Mark is kept over reinit, so that it covers all uses of a scope
+	arenaInit(&sArena, s_pStorage, STORAGE_SIZE);
+	TEST_CHECK_EQUAL(sArena.ulUsed, 0);
+	arenaAlloc(&sArena, ARENA_ALIGNMENT);
+	TEST_CHECK_EQUAL(sArena.ulHighWater, 3 * ARENA_ALIGNMENT);
+	arenaAlloc(&sArena, 4 * ARENA_ALIGNMENT);
+	TEST_CHECK_EQUAL(sArena.ulHighWater, 5 * ARENA_ALIGNMENT);
+
+	// Failed allocation doesn't move it
+	arenaAlloc(&sArena, STORAGE_SIZE);
+	TEST_CHECK_EQUAL(sArena.ulHighWater, 5 * ARENA_ALIGNMENT);
+}
+
+int main(void) {
+	testAlignment();
+	testExhaustion();
+	testOverflow();
+	testHighWater();
+	return testFinish();
+}
@@ -0,0 +1,323 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ace/managers/memory.h>
+#include <ace/utils/disk_file.h>
+#include "test.h"
+#include "assets.h"
+
+// Loads bitmap bundle built by asset_bundle.py with the game's own loader
+// and compares every plane row, reached through Planes[] the same way as
+// blitter would, with source .bm files. Bundle is then cut short at various
+// points, each of which must be rejected.
+
+#define PATH_SIZE_MAX 256
+#define BM_HEADER_SIZE 9
+#define BM_FLAG_INTERLEAVED 1
+#define BUNDLE_DATA_START (8 + 16 * 32)
+#define TRUNCATION_STEP 61
+#define CHIP_FREE_PLENTY (512 * 1024)
+#define CHIP_FREE_LOW (16 * 1024)
+#define FILE_SIZE_UNLIMITED -1
+
+typedef struct tBundleBitmapRef {
+	const char *szName;
+	tBitMap **pBitMap;
+} tBundleBitmapRef;
+
+struct tFile {
+	FILE *pHostFile;
+	LONG lBytesLeft;
+};
+
+static const tBundleBitmapRef s_pBitmapRefs[] = {
+	{"player", &g_pPlayerFrames},
+	{"player_mask", &g_pPlayerMasks},
+	{"arm", &g_pArmFrames},
+	{"arm_mask", &g_pArmMasks},
+	{"box", &g_pBoxFrames},
+	{"box_mask", &g_pBoxMasks},
+	{"bouncer", &g_pBouncerFrames},
+	{"bouncer_mask", &g_pBouncerMasks},
+	{"slipgate_a", &g_pSlipgateFramesA},
+	{"slipgate_b", &g_pSlipgateFramesB},
+	{"slipgates_mask", &g_pSlipgateMasks},
+	{"aim", &g_pAim},
+	{"aim_mask", &g_pAimMasks},
+	{"slip_vfx", &g_pSlipVfx},
+	{"slip_vfx_mask", &g_pSlipVfxMasks},
+	{"tiles", &g_pBmTiles},
+};
+
+#define BUNDLE_BITMAP_COUNT (sizeof(s_pBitmapRefs) / sizeof(s_pBitmapRefs[0]))
+
+static const char *s_szBuildDir;
+static LONG s_lFileSizeLimit = FILE_SIZE_UNLIMITED;
+static UBYTE s_isChipAvailable = 1;
+static ULONG s_ulChipFree = CHIP_FREE_PLENTY;
+static UBYTE *s_pChipBlock;
+static ULONG s_ulChipBlockSize;
+static UWORD s_uwChipBlocks;
+static UWORD s_uwFastBlocks;
+static const tBitMap *s_pLastRectDst;
+static UBYTE s_ubLastRectColor;
+
+//-------------------------------------------------------------------- ACE STUBS
+
+tFile *diskFileOpen(const char *szPath, const char *szMode) {
+	char szHostPath[PATH_SIZE_MAX];
+	snprintf(szHostPath, sizeof(szHostPath), "%s/%s", s_szBuildDir, szPath);
+	FILE *pHostFile = fopen(szHostPath, szMode);
+	if(!pHostFile) {
+		return 0;
+	}
+	tFile *pFile = malloc(sizeof(*pFile));
+	pFile->pHostFile = pHostFile;
+	pFile->lBytesLeft = s_lFileSizeLimit;
+	return pFile;
+}
+
+ULONG fileRead(tFile *pFile, void *pDest, ULONG ulSize) {
+	if(pFile->lBytesLeft != FILE_SIZE_UNLIMITED) {
+		ulSize = MIN(ulSize, (ULONG)pFile->lBytesLeft);
+	}
+	ULONG ulRead = fread(pDest, 1, ulSize, pFile->pHostFile);
+	if(pFile->lBytesLeft != FILE_SIZE_UNLIMITED) {
+		pFile->lBytesLeft -= ulRead;
+	}
+	return ulRead;
+}
+
+void fileClose(tFile *pFile) {
+	fclose(pFile->pHostFile);
+	free(pFile);
+}
+
+void *memAllocChip(ULONG ulSize) {
+	if(!s_isChipAvailable) {
+		return 0;
+	}
+	s_pChipBlock = malloc(ulSize);
+	s_ulChipBlockSize = ulSize;
+	++s_uwChipBlocks;
+	return s_pChipBlock;
+}
+
+void *memAllocFast(ULONG ulSize) {
+	++s_uwFastBlocks;
+	return malloc(ulSize);
+}
+
+void memFree(void *pMem, ULONG ulSize) {
+	if(pMem == s_pChipBlock) {
+		TEST_CHECK_EQUAL(ulSize, s_ulChipBlockSize);
+		s_pChipBlock = 0;
+		--s_uwChipBlocks;
+	}
+	else {
+		TEST_CHECK(s_uwFastBlocks > 0);
+		--s_uwFastBlocks;
+	}
+	free(pMem);
+}
+
+ULONG memGetFreeChipSize(void) {
+	return s_ulChipFree;
+}
+
+UBYTE blitRect(
+	tBitMap *pDst, WORD wDstX, WORD wDstY, WORD wWidth, WORD wHeight, UBYTE ubColor
+) {
+	s_pLastRectDst = pDst;
+	s_ubLastRectColor = ubColor;
+	return 1;
+}
+
+// Only used by assetsGlobalCreate(), which isn't tested
+tBitMap *bitmapCreateFromPath(const char *szPath, UBYTE isFast) { return 0; }
+void bitmapDestroy(tBitMap *pBitMap) {}
+tFont *fontCreateFromPath(const char *szPath) { return 0; }
+void fontDestroy(tFont *pFont) {}
+tPtplayerMod *ptplayerModCreateFromPath(const char *szPath) { return 0; }
+void ptplayerModDestroy(tPtplayerMod *pMod) {}
+
+//------------------------------------------------------------------------ TESTS
+
+static UBYTE isInChipBlock(const UBYTE *pData, ULONG ulSize) {
+	return (
+		s_pChipBlock && pData >= s_pChipBlock &&
+		pData + ulSize <= s_pChipBlock + s_ulChipBlockSize
+	);
+}
+
+static void checkBitmap(const tBundleBitmapRef *pRef) {
+	char szPath[PATH_SIZE_MAX];
+	snprintf(szPath, sizeof(szPath), "%s/bundle/%s.bm", s_szBuildDir, pRef->szName);
+	FILE *pSource = fopen(szPath, "rb");
+	TEST_CHECK(pSource);
+	const tBitMap *pBitMap = *pRef->pBitMap;
+	TEST_CHECK(pBitMap);
+	if(!pSource || !pBitMap) {
+		if(pSource) {
+			fclose(pSource);
+		}
+		return;
+	}
+
+	UBYTE pHeader[BM_HEADER_SIZE];
+	TEST_CHECK_EQUAL(fread(pHeader, 1, sizeof(pHeader), pSource), sizeof(pHeader));
+	UWORD uwHeight = (pHeader[2] << 8) | pHeader[3];
+	UBYTE ubDepth = pHeader[4];
+	UBYTE isInterleaved = pHeader[6] & BM_FLAG_INTERLEAVED;
+	UWORD uwPlaneRowSize = ((((pHeader[0] << 8) | pHeader[1]) + 15) >> 4) << 1;
+	TEST_CHECK_EQUAL(pBitMap->Rows, uwHeight);
+	TEST_CHECK_EQUAL(pBitMap->Depth, ubDepth);
+	TEST_CHECK_EQUAL(!!(pBitMap->Flags & BMF_INTERLEAVED), isInterleaved);
+
+	UWORD uwBadRows = 0;
+	for(UWORD y = 0; y < uwHeight; ++y) {
+		for(UBYTE ubPlane = 0; ubPlane < ubDepth; ++ubPlane) {
+			ULONG ulRow = isInterleaved ? (y * ubDepth + ubPlane) : (ubPlane * uwHeight + y);
+			UBYTE pRow[64];
+			fseek(pSource, BM_HEADER_SIZE + ulRow * uwPlaneRowSize, SEEK_SET);
+			const UBYTE *pLoaded = &pBitMap->Planes[ubPlane][y * pBitMap->BytesPerRow];
+			if(
+				fread(pRow, 1, uwPlaneRowSize, pSource) != uwPlaneRowSize ||
+				!isInChipBlock(pLoaded, uwPlaneRowSize) ||
+				memcmp(pRow, pLoaded, uwPlaneRowSize)
+			) {
+				++uwBadRows;
+			}
+		}
+	}
+	if(uwBadRows) {
+		printf("%s: %hu plane rows differ\n", pRef->szName, uwBadRows);
+	}
+	TEST_CHECK_EQUAL(uwBadRows, 0);
+	fclose(pSource);
+}
+
+static void testLoad(void) {
+	TEST_CHECK(assetsGameCreate());
+	TEST_CHECK_EQUAL(s_uwChipBlocks, 1);
+	for(UBYTE i = 0; i < BUNDLE_BITMAP_COUNT; ++i) {
+		checkBitmap(&s_pBitmapRefs[i]);
+	}
+
+	// White frame shares arena with bundle bitmaps, but only its planes
+	TEST_CHECK(g_pPlayerWhiteFrame);
+	TEST_CHECK(g_pPlayerWhiteFrame && isInChipBlock(
+		g_pPlayerWhiteFrame->Planes[0],
+		g_pPlayerWhiteFrame->BytesPerRow * g_pPlayerWhiteFrame->Rows
+	));
+	TEST_CHECK(!isInChipBlock((const UBYTE*)g_pPlayerWhiteFrame, sizeof(tBitMap)));
+	TEST_CHECK_EQUAL(s_uwFastBlocks, 1);
+	TEST_CHECK(s_pLastRectDst == g_pPlayerWhiteFrame);
+	TEST_CHECK_EQUAL(s_ubLastRectColor, 15);
+}
+
+static void testResidency(void) {
+	tAssetsResidencyStats sBefore = *assetsGetResidencyStats();
+	const UBYTE *pChipBlock = s_pChipBlock;
+
+	// Enough chip left - next game state gets the same bitmaps
+	s_ulChipFree = CHIP_FREE_PLENTY;
+	assetsGameRelease();
+	TEST_CHECK(assetsGameCreate());
+	TEST_CHECK(s_pChipBlock == pChipBlock);
+	TEST_CHECK_EQUAL(assetsGetResidencyStats()->uwHits, sBefore.uwHits + 1);
+	TEST_CHECK_EQUAL(assetsGetResidencyStats()->uwMisses, sBefore.uwMisses);
+
+	// Low on chip - assets are freed and loaded again
+	s_ulChipFree = CHIP_FREE_LOW;
+	assetsGameRelease();
+	TEST_CHECK_EQUAL(s_uwChipBlocks, 0);
+	TEST_CHECK_EQUAL(s_uwFastBlocks, 0);
+	TEST_CHECK_EQUAL(assetsGetResidencyStats()->uwEvictions, sBefore.uwEvictions + 1);
+	TEST_CHECK(assetsGameCreate());
+	TEST_CHECK_EQUAL(assetsGetResidencyStats()->uwMisses, sBefore.uwMisses + 1);
+	checkBitmap(&s_pBitmapRefs[0]);
+	s_ulChipFree = CHIP_FREE_PLENTY;
+}
+
+static void testDestroy(void) {
+	// Freeing on exit isn't an eviction
+	TEST_CHECK(assetsGameCreate());
+	TEST_CHECK(g_pPlayerWhiteFrame);
+	UWORD uwEvictions = assetsGetResidencyStats()->uwEvictions;
+	assetsGameDestroy();
+	TEST_CHECK_EQUAL(assetsGetResidencyStats()->uwEvictions, uwEvictions);
+	TEST_CHECK_EQUAL(s_uwChipBlocks, 0);
+	TEST_CHECK_EQUAL(s_uwFastBlocks, 0);
+}
+
+static void checkLoadFails(void) {
+	assetsGameEvict();
+	TEST_CHECK(!assetsGameCreate());
+	TEST_CHECK(!g_pPlayerWhiteFrame);
+	assetsGameEvict();
+	TEST_CHECK_EQUAL(s_uwChipBlocks, 0);
+	TEST_CHECK_EQUAL(s_uwFastBlocks, 0);
+}
+
+static void testRejected(LONG lBundleSize) {
+	UWORD uwTruncations = 0;
+	UWORD uwAccepted = 0;
+	for(LONG lSize = 0; lSize < lBundleSize; lSize += TRUNCATION_STEP) {
+		// Last few bytes too, which are end of last packed stream
+		if(lSize + TRUNCATION_STEP >= lBundleSize) {
+			lSize = MAX(lSize, lBundleSize - 3);
+		}
+		s_lFileSizeLimit = lSize;
+		assetsGameEvict();
+		UBYTE isLoaded = assetsGameCreate();
+		TEST_CHECK_EQUAL(isLoaded, g_pPlayerWhiteFrame != 0);
+		if(isLoaded) {
+			printf("Bundle cut to %ld bytes was accepted\n", (long)lSize);
+			++uwAccepted;
+		}
+		++uwTruncations;
+	}
+	s_lFileSizeLimit = FILE_SIZE_UNLIMITED;
+	printf("Rejected %hu of %hu truncated bundles\n", uwTruncations - uwAccepted, uwTruncations);
+	TEST_CHECK_EQUAL(uwAccepted, 0);
+	assetsGameEvict();
+	TEST_CHECK_EQUAL(s_uwChipBlocks, 0);
+
+	// Failed loads don't leave anything behind that'd break next one
+	TEST_CHECK(assetsGameCreate());
+	checkBitmap(&s_pBitmapRefs[BUNDLE_BITMAP_COUNT - 1]);
+
+	s_isChipAvailable = 0;
+	checkLoadFails();
+	s_isChipAvailable = 1;
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 2) {
+		printf("Usage: %s build_dir\n", pArgs[0]);
+		return 1;
+	}
+	s_szBuildDir = pArgs[1];
+
+	char szBundlePath[PATH_SIZE_MAX];
+	snprintf(szBundlePath, sizeof(szBundlePath), "%s/data/game.bnd", s_szBuildDir);
+	FILE *pBundle = fopen(szBundlePath, "rb");
+	if(!pBundle) {
+		printf("Can't open %s\n", szBundlePath);
+		return 1;
+	}
+	fseek(pBundle, 0, SEEK_END);
+	LONG lBundleSize = ftell(pBundle);
+	fclose(pBundle);
+	TEST_CHECK(lBundleSize > BUNDLE_DATA_START);
+
+	testLoad();
+	testResidency();
+	testRejected(lBundleSize);
+	testDestroy();
+	return testFinish();
+}
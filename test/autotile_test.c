@@ -0,0 +1,731 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <stdlib.h>
+#include <time.h>
+#include <ace/managers/log.h>
+#include "test.h"
+#include "autotile.h"
+
+// Compares generated autotile tables and per-column bitmask recalculation
+// with branch chain they've replaced, on every tile of shipped levels, and
+// measures full-level recalculation time of each. Pass repeat count as
+// second arg for steadier timings.
+
+#define LEVEL_INDEX_LAST 100
+#define LEVEL_COUNT_MAX 64
+#define LEVEL_HEADER_SIZE 32
+#define LEVEL_VERSION 2
+#define LEVEL_FLAGS_OFFSET 29
+#define LEVEL_FLAG_PACKED_PLANES BV(0)
+
+typedef enum tRecalcMethod {
+	RECALC_METHOD_BRANCH_CHAIN,
+	RECALC_METHOD_TABLES,
+	RECALC_METHOD_COLUMN_BITMASKS,
+	RECALC_METHOD_COUNT
+} tRecalcMethod;
+
+static const char *s_pRecalcMethodNames[RECALC_METHOD_COUNT] = {
+	"branch chain", "per-tile tables", "column bitmasks"
+};
+
+static tLevel s_pLevels[LEVEL_COUNT_MAX];
+static tVisTile s_pReferenceVisTiles[MAP_TILE_WIDTH][MAP_TILE_HEIGHT];
+
+//-------------------------------------------------------------- MAP TILE CHECKS
+
+// Same as in map.c, used by both old and new code
+UBYTE mapTileIsSlipgate(tTile eTile) {
+	return (eTile & TILE_LAYER_SLIPGATES) != 0;
+}
+
+UBYTE mapTileIsLethal(tTile eTile) {
+	return (eTile & TILE_LAYER_LETHALS) != 0;
+}
+
+UBYTE mapTileIsExit(tTile eTile) {
+	return (eTile & TILE_LAYER_EXIT) != 0;
+}
+
+UBYTE mapTileIsButton(tTile eTile) {
+	return (eTile & TILE_LAYER_BUTTON) != 0;
+}
+
+UBYTE mapTileIsActiveTurret(tTile eTile) {
+	return (eTile & TILE_LAYER_ACTIVE_TURRET) != 0;
+}
+
+UBYTE mapTileIsOnWall(tTile eTile) {
+	return (
+		mapTileIsSlipgate(eTile) ||
+		mapTileIsButton(eTile) ||
+		mapTileIsExit(eTile) ||
+		eTile == TILE_WALL_BLOCKED ||
+		eTile == TILE_WALL ||
+		eTile == TILE_SPIKES_OFF_FLOOR ||
+		eTile == TILE_SPIKES_ON_FLOOR ||
+		eTile == TILE_RECEIVER ||
+		eTile == TILE_BOUNCER_SPAWNER ||
+		eTile == TILE_PIPE ||
+		0
+	);
+}
+
+//------------------------------------------------------------- OLD AUTOTILE CODE
+
+typedef enum tNeighborFlag {
+	NEIGHBOR_FLAG_N  = BV(0),
+	NEIGHBOR_FLAG_NE = BV(1),
+	NEIGHBOR_FLAG_E  = BV(2),
+	NEIGHBOR_FLAG_SE = BV(3),
+	NEIGHBOR_FLAG_S  = BV(4),
+	NEIGHBOR_FLAG_SW = BV(5),
+	NEIGHBOR_FLAG_W  = BV(6),
+	NEIGHBOR_FLAG_NW = BV(7),
+} tNeighborFlag;
+
+typedef struct tGatewayKind {
+	tTile eTileFront;
+	tVisTile eVisTileFirst;
+} tGatewayKind;
+
+static const tGatewayKind s_pGatewayKinds[] = {
+	{.eTileFront = TILE_DOOR_CLOSED, .eVisTileFirst = VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP},
+	{.eTileFront = TILE_DOOR_OPEN, .eVisTileFirst = VIS_TILE_DOOR_LEFT_OPEN_WALL_TOP},
+	{.eTileFront = TILE_GRATE, .eVisTileFirst = VIS_TILE_GRATE_LEFT_WALL_TOP},
+	{.eTileFront = TILE_DEATH_FIELD, .eVisTileFirst = VIS_TILE_DEATH_FIELD_LEFT_WALL_TOP},
+};
+#define MAP_GATEWAY_KIND_COUNT (sizeof(s_pGatewayKinds) / sizeof(s_pGatewayKinds[0]))
+
+static tNeighborFlag mapGetWallNeighborsOnLevel(
+	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY
+) {
+	tNeighborFlag eNeighbors = 0;
+	if(mapTileIsOnWall(pLevel->pTiles[ubTileX - 1][ubTileY])) {
+		eNeighbors |= NEIGHBOR_FLAG_W;
+	}
+	if(mapTileIsOnWall(pLevel->pTiles[ubTileX + 1][ubTileY])) {
+		eNeighbors |= NEIGHBOR_FLAG_E;
+	}
+	if(mapTileIsOnWall(pLevel->pTiles[ubTileX - 1][ubTileY - 1])) {
+		eNeighbors |= NEIGHBOR_FLAG_NW;
+	}
+	if(mapTileIsOnWall(pLevel->pTiles[ubTileX + 1][ubTileY - 1])) {
+		eNeighbors |= NEIGHBOR_FLAG_NE;
+	}
+	if(mapTileIsOnWall(pLevel->pTiles[ubTileX - 1][ubTileY + 1])) {
+		eNeighbors |= NEIGHBOR_FLAG_SW;
+	}
+	if(mapTileIsOnWall(pLevel->pTiles[ubTileX + 1][ubTileY + 1])) {
+		eNeighbors |= NEIGHBOR_FLAG_SE;
+	}
+	if(mapTileIsOnWall(pLevel->pTiles[ubTileX][ubTileY - 1])) {
+		eNeighbors |= NEIGHBOR_FLAG_N;
+	}
+	if(mapTileIsOnWall(pLevel->pTiles[ubTileX][ubTileY + 1])) {
+		eNeighbors |= NEIGHBOR_FLAG_S;
+	}
+
+	return eNeighbors;
+}
+
+
+static tVisTile mapCalculateVisTileForGatewayWallTiles(
+	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
+	tTile eTile, tVisTile eVisTileFirst
+) {
+	tTile eTileLeft = pLevel->pTiles[ubTileX - 1][ubTileY];
+	tTile eTileRight = pLevel->pTiles[ubTileX + 1][ubTileY];
+	tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
+	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+
+	if(eTileAbove == eTile) {
+		return (eVisTileFirst + (
+			(ubTileX < MAP_TILE_WIDTH / 2) ?
+			VIS_TILE_DOOR_LEFT_CLOSED_WALL_BOTTOM :
+			VIS_TILE_DOOR_RIGHT_CLOSED_WALL_BOTTOM
+		) - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP);
+	}
+	if(eTileBelow == eTile) {
+		return (eVisTileFirst + (
+			(ubTileX < MAP_TILE_WIDTH / 2) ?
+			VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP :
+			VIS_TILE_DOOR_RIGHT_CLOSED_WALL_TOP
+		) - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP);
+	}
+	if(eTileLeft == eTile) {
+		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_WALL_RIGHT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	}
+	if(eTileRight == eTile) {
+		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_WALL_LEFT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	}
+
+	return VIS_TILE_BG_1;
+}
+
+static tVisTile mapCalculateVisTileForGatewayBgTiles(
+	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
+	tTile eTile, tVisTile eVisTileFirst
+) {
+	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+
+	if(eTileBelow == eTile) {
+		if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] != eTile) {
+			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_LEFT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+		}
+		if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] != eTile) {
+			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_RIGHT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+		}
+		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_TOP_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	}
+	return VIS_TILE_BG_1;
+}
+
+static tVisTile mapCalculateVisTileForGatewayFrontTiles(
+	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY,
+	tTile eTile, tVisTile eVisTileFirst
+) {
+	tTile eTileLeft = pLevel->pTiles[ubTileX - 1][ubTileY];
+	tTile eTileRight = pLevel->pTiles[ubTileX + 1][ubTileY];
+	tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
+	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+
+	if(eTileLeft == eTile || eTileRight == eTile) {
+		// Horizontal gateway
+		if(eTileLeft != eTile) {
+			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_LEFT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+		}
+		if(eTileRight != eTile) {
+			return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_RIGHT - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+		}
+		return eVisTileFirst + VIS_TILE_DOOR_DOWN_CLOSED_BOTTOM_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+	}
+	else {
+		// Vertical gateway
+		if(ubTileX < MAP_TILE_WIDTH / 2) {
+			if(eTileAbove != eTile) {
+				return eVisTileFirst + VIS_TILE_DOOR_LEFT_CLOSED_TOP - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+			}
+			if(eTileBelow != eTile) {
+				return eVisTileFirst + VIS_TILE_DOOR_LEFT_CLOSED_BOTTOM - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+			}
+			return eVisTileFirst + VIS_TILE_DOOR_LEFT_CLOSED_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+		}
+		else {
+			if(eTileAbove != eTile) {
+				return eVisTileFirst + VIS_TILE_DOOR_RIGHT_CLOSED_TOP - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+			}
+			if(eTileBelow != eTile) {
+				return eVisTileFirst + VIS_TILE_DOOR_RIGHT_CLOSED_BOTTOM - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+			}
+			return eVisTileFirst + VIS_TILE_DOOR_RIGHT_CLOSED_MID - VIS_TILE_DOOR_LEFT_CLOSED_WALL_TOP;
+		}
+	}
+
+	return VIS_TILE_BG_1;
+}
+
+static tVisTile referenceGetVisTile(
+	tLevel *pLevel, UBYTE ubTileX, UBYTE ubTileY
+) {
+	if(
+		ubTileX == 0 || ubTileX == MAP_TILE_WIDTH - 1 ||
+		ubTileY == 0 || ubTileY == MAP_TILE_HEIGHT - 1
+	) {
+		return VIS_TILE_WALL_1;
+	}
+
+	tNeighborFlag eNeighbors = mapGetWallNeighborsOnLevel(pLevel, ubTileX, ubTileY);
+	tTile eTile = pLevel->pTiles[ubTileX][ubTileY];
+	tTile eTileLeft = pLevel->pTiles[ubTileX - 1][ubTileY];
+	tTile eTileRight = pLevel->pTiles[ubTileX + 1][ubTileY];
+	tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
+	tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+	switch(eTile) {
+		case TILE_DOOR_CLOSED:
+		case TILE_DOOR_OPEN:
+		case TILE_GRATE:
+		case TILE_DEATH_FIELD:
+			for(UBYTE i = 0; i < MAP_GATEWAY_KIND_COUNT; ++i) {
+				if(s_pGatewayKinds[i].eTileFront == eTile) {
+					return mapCalculateVisTileForGatewayFrontTiles(
+						pLevel, ubTileX, ubTileY, eTile, s_pGatewayKinds[i].eVisTileFirst
+					);
+				}
+			}
+			break;
+		case TILE_BOUNCER_SPAWNER:
+			if((eNeighbors & NEIGHBOR_FLAG_S) == 0) {
+				return VIS_TILE_BOUNCER_SPAWNER_WALL_DOWN;
+			}
+			if((eNeighbors & NEIGHBOR_FLAG_N) == 0) {
+				return VIS_TILE_BOUNCER_SPAWNER_WALL_UP;
+			}
+			if((eNeighbors & NEIGHBOR_FLAG_E) == 0) {
+				return VIS_TILE_BOUNCER_SPAWNER_WALL_RIGHT;
+			}
+			if((eNeighbors & NEIGHBOR_FLAG_W) == 0) {
+				return VIS_TILE_BOUNCER_SPAWNER_WALL_LEFT;
+			}
+			break;
+		case TILE_RECEIVER:
+			if((eNeighbors & NEIGHBOR_FLAG_S) == 0) {
+				return VIS_TILE_RECEIVER_WALL_DOWN;
+			}
+			if((eNeighbors & NEIGHBOR_FLAG_N) == 0) {
+				return VIS_TILE_RECEIVER_WALL_UP;
+			}
+			if((eNeighbors & NEIGHBOR_FLAG_E) == 0) {
+				return VIS_TILE_RECEIVER_WALL_RIGHT;
+			}
+			if((eNeighbors & NEIGHBOR_FLAG_W) == 0) {
+				return VIS_TILE_RECEIVER_WALL_LEFT;
+			}
+			break;
+		case TILE_PIPE:
+			if(
+				eTileAbove == TILE_PIPE && eTileBelow == TILE_PIPE &&
+				eTileLeft == TILE_PIPE && eTileRight == TILE_PIPE
+			) {
+				return VIS_TILE_PIPE_NESW;
+			}
+			if(eTileAbove == TILE_PIPE && eTileBelow == TILE_PIPE) {
+				return VIS_TILE_PIPE_NS;
+			}
+			if(eTileLeft == TILE_PIPE && eTileRight == TILE_PIPE) {
+				return VIS_TILE_PIPE_EW;
+			}
+			if(eTileAbove == TILE_PIPE) {
+				if(eTileLeft == TILE_WALL_BLOCKED) {
+					return VIS_TILE_BLOCKED_WALL_PIPE_S;
+				}
+				return VIS_TILE_WALL_PIPE_S;
+			}
+			if(eTileBelow == TILE_PIPE) {
+				if(eTileLeft == TILE_WALL_BLOCKED) {
+					return VIS_TILE_BLOCKED_WALL_PIPE_N;
+				}
+				return VIS_TILE_WALL_PIPE_N;
+			}
+			if(eTileLeft == TILE_PIPE) {
+				if(eTileBelow == TILE_WALL_BLOCKED) {
+					return VIS_TILE_BLOCKED_WALL_PIPE_E;
+				}
+				return VIS_TILE_WALL_PIPE_E;
+			}
+			if(eTileRight == TILE_PIPE) {
+				if(eTileBelow == TILE_WALL_BLOCKED) {
+					return VIS_TILE_BLOCKED_WALL_PIPE_W;
+				}
+				return VIS_TILE_WALL_PIPE_W;
+			}
+			break;
+		case TILE_BUTTON_A:
+		case TILE_BUTTON_B:
+		case TILE_BUTTON_C:
+		case TILE_BUTTON_D:
+		case TILE_BUTTON_E:
+		case TILE_BUTTON_F:
+		case TILE_BUTTON_G:
+		case TILE_BUTTON_H:
+			if(ubTileX < MAP_TILE_WIDTH / 2) {
+				if(pLevel->pTiles[ubTileX + 1][ubTileY] == eTile) {
+					return VIS_TILE_BUTTON_WALL_LEFT_1;
+				}
+				return VIS_TILE_BUTTON_WALL_LEFT_2;
+			}
+			else {
+				if(pLevel->pTiles[ubTileX + 1][ubTileY] == eTile) {
+					return VIS_TILE_BUTTON_WALL_RIGHT_1;
+				}
+				return VIS_TILE_BUTTON_WALL_RIGHT_2;
+			}
+			break;
+		case TILE_EXIT:
+		case TILE_EXIT_HUB: {
+			tTile eTileAbove = pLevel->pTiles[ubTileX][ubTileY - 1];
+			tTile eTileBelow = pLevel->pTiles[ubTileX][ubTileY + 1];
+			if(ubTileX < MAP_TILE_WIDTH / 2) {
+				if(eTileAbove != eTile) {
+					return VIS_TILE_EXIT_WALL_LEFT_TOP;
+				}
+				if(eTileBelow != eTile) {
+					return VIS_TILE_EXIT_WALL_LEFT_BOTTOM;
+				}
+				return VIS_TILE_EXIT_WALL_LEFT_MID;
+			}
+			else {
+				if(eTileAbove != eTile) {
+					return VIS_TILE_EXIT_WALL_RIGHT_TOP;
+				}
+				if(eTileBelow != eTile) {
+					return VIS_TILE_EXIT_WALL_RIGHT_BOTTOM;
+				}
+				return VIS_TILE_EXIT_WALL_RIGHT_MID;
+			}
+		} break;
+		case TILE_WALL:
+		case TILE_WALL_BLOCKED: {
+			for(UBYTE i = 0; i < MAP_GATEWAY_KIND_COUNT; ++i) {
+				tVisTile eVisTile = mapCalculateVisTileForGatewayWallTiles(
+					pLevel, ubTileX, ubTileY,
+					s_pGatewayKinds[i].eTileFront, s_pGatewayKinds[i].eVisTileFirst
+				);
+				if(eVisTile != VIS_TILE_BG_1) {
+					return eVisTile;
+				}
+			}
+
+			static const UBYTE pWallLookup[256] = {
+				0,
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_WALL_CONVEX_N,
+				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_WALL_CONVEX_NE,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONVEX_E,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONVEX_SE,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONVEX_S,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E] = VIS_TILE_WALL_CONVEX_SW,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_WALL_CONVEX_W,
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_WALL_CONVEX_NW,
+				[255] = VIS_TILE_WALL_1,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_N,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_N,
+
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_NE,
+
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_E,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_WALL_CONCAVE_E,
+
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_WALL_CONCAVE_SE,
+
+				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_WALL_CONCAVE_S,
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_WALL_CONCAVE_S,
+
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N] = VIS_TILE_WALL_CONCAVE_SW,
+
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N] = VIS_TILE_WALL_CONCAVE_W,
+				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE] = VIS_TILE_WALL_CONCAVE_W,
+
+				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E] = VIS_TILE_WALL_CONCAVE_NW,
+			};
+			if(pWallLookup[eNeighbors] != 0) {
+				if(eTile == TILE_WALL_BLOCKED) {
+					return pWallLookup[eNeighbors] + VIS_TILE_BLOCKED_WALL_CONVEX_N - VIS_TILE_WALL_CONVEX_N;
+				}
+				return pWallLookup[eNeighbors];
+			}
+
+			logWrite("Unhandled tile at %hhu,%hhu", ubTileX, ubTileY);
+		} break;
+		case TILE_BG: {
+			if(eTileAbove == TILE_BOUNCER_SPAWNER) {
+				return VIS_TILE_BOUNCER_SPAWNER_BG_DOWN;
+			}
+			if(eTileBelow == TILE_BOUNCER_SPAWNER) {
+				return VIS_TILE_BOUNCER_SPAWNER_BG_UP;
+			}
+			if(eTileLeft == TILE_BOUNCER_SPAWNER) {
+				return VIS_TILE_BOUNCER_SPAWNER_BG_RIGHT;
+			}
+			if(eTileRight == TILE_BOUNCER_SPAWNER) {
+				return VIS_TILE_BOUNCER_SPAWNER_BG_LEFT;
+			}
+			if(eTileAbove == TILE_RECEIVER) {
+				return VIS_TILE_RECEIVER_BG_DOWN;
+			}
+			if(eTileBelow == TILE_RECEIVER) {
+				return VIS_TILE_RECEIVER_BG_UP;
+			}
+			if(eTileLeft == TILE_RECEIVER) {
+				return VIS_TILE_RECEIVER_BG_RIGHT;
+			}
+			if(eTileRight == TILE_RECEIVER) {
+				return VIS_TILE_RECEIVER_BG_LEFT;
+			}
+			if(eTileAbove == TILE_PIPE) {
+				if(pLevel->pTiles[ubTileX - 1][ubTileY - 1] == TILE_WALL_BLOCKED) {
+					return VIS_TILE_BLOCKED_BG_PIPE_S;
+				}
+				return VIS_TILE_BG_PIPE_S;
+			}
+			if(eTileBelow == TILE_PIPE) {
+				if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
+					return VIS_TILE_BLOCKED_BG_PIPE_N;
+				}
+				return VIS_TILE_BG_PIPE_N;
+			}
+			if(eTileLeft == TILE_PIPE) {
+				if(pLevel->pTiles[ubTileX - 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
+					return VIS_TILE_BLOCKED_BG_PIPE_E;
+				}
+				return VIS_TILE_BG_PIPE_E;
+			}
+			if(eTileRight == TILE_PIPE) {
+				if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == TILE_WALL_BLOCKED) {
+					return VIS_TILE_BLOCKED_BG_PIPE_W;
+				}
+				return VIS_TILE_BG_PIPE_W;
+			}
+			if(mapTileIsExit(eTileLeft)) {
+				if(!mapTileIsExit(pLevel->pTiles[ubTileX - 1][ubTileY - 1])) {
+					return VIS_TILE_EXIT_BG_LEFT_TOP;
+				}
+				if(!mapTileIsExit(pLevel->pTiles[ubTileX - 1][ubTileY + 1])) {
+					return VIS_TILE_EXIT_BG_LEFT_BOTTOM;
+				}
+				return VIS_TILE_EXIT_BG_LEFT_MID;
+			}
+			if(mapTileIsExit(eTileRight)) {
+				if(!mapTileIsExit(pLevel->pTiles[ubTileX + 1][ubTileY - 1])) {
+					return VIS_TILE_EXIT_BG_RIGHT_TOP;
+				}
+				if(!mapTileIsExit(pLevel->pTiles[ubTileX + 1][ubTileY + 1])) {
+					return VIS_TILE_EXIT_BG_RIGHT_BOTTOM;
+				}
+				return VIS_TILE_EXIT_BG_RIGHT_MID;
+			}
+
+			for(UBYTE i = 0; i < MAP_GATEWAY_KIND_COUNT; ++i) {
+				tVisTile eVisTile = mapCalculateVisTileForGatewayBgTiles(
+					pLevel, ubTileX, ubTileY,
+					s_pGatewayKinds[i].eTileFront, s_pGatewayKinds[i].eVisTileFirst
+				);
+				if(eVisTile != VIS_TILE_BG_1) {
+					return eVisTile;
+				}
+			}
+
+			if(mapTileIsButton(eTileBelow)) {
+				if(ubTileX < MAP_TILE_WIDTH / 2) {
+					if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == eTileBelow) {
+						return VIS_TILE_BUTTON_BG_LEFT_1;
+					}
+					return VIS_TILE_BUTTON_BG_LEFT_2;
+				}
+				else {
+					if(pLevel->pTiles[ubTileX + 1][ubTileY + 1] == eTileBelow) {
+						return VIS_TILE_BUTTON_BG_RIGHT_1;
+					}
+					return VIS_TILE_BUTTON_BG_RIGHT_2;
+				}
+			}
+
+			static const UBYTE pBgLookup[256] = {
+				0,
+
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONVEX_N,
+				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONVEX_N,
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_BG_CONVEX_N,
+				[NEIGHBOR_FLAG_S] = VIS_TILE_BG_CONVEX_N,
+
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONCAVE_NE,
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONCAVE_NE,
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONCAVE_NE,
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONCAVE_NE,
+
+				[NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_E,
+				[NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_E,
+				[NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_BG_CONVEX_E,
+				[NEIGHBOR_FLAG_W] = VIS_TILE_BG_CONVEX_E,
+
+				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONCAVE_SE,
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONCAVE_SE,
+				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_BG_CONCAVE_SE,
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S] = VIS_TILE_BG_CONCAVE_SE,
+
+				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_S,
+				[NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_S,
+				[NEIGHBOR_FLAG_NE | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONVEX_S,
+				[NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONVEX_S,
+
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONCAVE_SW,
+				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONCAVE_SW,
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_BG_CONCAVE_SW,
+				[NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W] = VIS_TILE_BG_CONCAVE_SW,
+
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONVEX_W,
+				[NEIGHBOR_FLAG_E | NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONVEX_W,
+				[NEIGHBOR_FLAG_SE | NEIGHBOR_FLAG_E] = VIS_TILE_BG_CONVEX_W,
+				[NEIGHBOR_FLAG_E] = VIS_TILE_BG_CONVEX_W,
+
+				[NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONCAVE_NW,
+				[NEIGHBOR_FLAG_SW | NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONCAVE_NW,
+				[NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONCAVE_NW,
+				[NEIGHBOR_FLAG_W | NEIGHBOR_FLAG_NW | NEIGHBOR_FLAG_N] = VIS_TILE_BG_CONCAVE_NW,
+
+				[NEIGHBOR_FLAG_SW] = VIS_TILE_BG_CONVEX_NE,
+				[NEIGHBOR_FLAG_NW] = VIS_TILE_BG_CONVEX_SE,
+				[NEIGHBOR_FLAG_NE] = VIS_TILE_BG_CONVEX_SW,
+				[NEIGHBOR_FLAG_SE] = VIS_TILE_BG_CONVEX_NW,
+			};
+
+			if(pBgLookup[eNeighbors] != 0) {
+				if(
+					eTileAbove == TILE_WALL_BLOCKED || eTileBelow == TILE_WALL_BLOCKED ||
+					eTileLeft == TILE_WALL_BLOCKED || eTileRight == TILE_WALL_BLOCKED || (
+						(
+							eNeighbors & (
+								NEIGHBOR_FLAG_N | NEIGHBOR_FLAG_E |
+								NEIGHBOR_FLAG_S | NEIGHBOR_FLAG_W
+							)
+						) == 0 && (
+							pLevel->pTiles[ubTileX - 1][ubTileY - 1] == TILE_WALL_BLOCKED ||
+							pLevel->pTiles[ubTileX - 1][ubTileY + 1] == TILE_WALL_BLOCKED ||
+							pLevel->pTiles[ubTileX + 1][ubTileY - 1] == TILE_WALL_BLOCKED ||
+							pLevel->pTiles[ubTileX + 1][ubTileY + 1] == TILE_WALL_BLOCKED
+						)
+					)
+				) {
+					return pBgLookup[eNeighbors] + VIS_TILE_BLOCKED_BG_CONVEX_N - VIS_TILE_BG_CONVEX_N;
+				}
+				return pBgLookup[eNeighbors];
+			}
+		} break;
+		case TILE_TURRET_ACTIVE:
+			return VIS_TILE_TURRET_ACTIVE;
+		case TILE_TURRET_INACTIVE:
+			return VIS_TILE_TURRET_INACTIVE;
+		case TILE_SPIKES_OFF_BG:
+			return VIS_TILE_SPIKES_OFF_BG_1;
+		case TILE_SPIKES_OFF_FLOOR:
+			return VIS_TILE_SPIKES_OFF_FLOOR_1;
+		case TILE_SPIKES_ON_BG:
+			return VIS_TILE_SPIKES_ON_BG_1;
+		case TILE_SPIKES_ON_FLOOR:
+			return VIS_TILE_SPIKES_ON_FLOOR_1;
+		default:
+			return VIS_TILE_BG_1;
+			break;
+	}
+
+	return VIS_TILE_BG_1;
+}
+
+//---------------------------------------------------------------------- LEVELS
+
+static UBYTE loadLevelTiles(const char *szDir, UBYTE ubIndex, tLevel *pLevel) {
+	char szPath[256];
+	snprintf(szPath, sizeof(szPath), "%s/L%03hhu.dat", szDir, ubIndex);
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		return 0;
+	}
+
+	UBYTE pHeader[LEVEL_HEADER_SIZE];
+	UBYTE pPlane[MAP_TILE_HEIGHT][MAP_TILE_WIDTH][2];
+	if(fread(pHeader, sizeof(pHeader), 1, pFile) != 1 || memcmp(pHeader, "SLVL", 4)) {
+		// L100 is in layout older than v1, which game can't load either
+		printf("%s: skipped, not a v2 level\n", szPath);
+		fclose(pFile);
+		return 0;
+	}
+	UBYTE isLoaded = (
+		pHeader[4] == LEVEL_VERSION &&
+		!(pHeader[LEVEL_FLAGS_OFFSET] & LEVEL_FLAG_PACKED_PLANES) &&
+		fread(pPlane, sizeof(pPlane), 1, pFile) == 1
+	);
+	fclose(pFile);
+	if(!isLoaded) {
+		printf("%s: not an unpacked v2 level\n", szPath);
+		TEST_CHECK(0);
+		return 0;
+	}
+
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			pLevel->pTiles[ubX][ubY] = (pPlane[ubY][ubX][0] << 8) | pPlane[ubY][ubX][1];
+		}
+	}
+	return 1;
+}
+
+static void recalcLevel(tLevel *pLevel, tRecalcMethod eMethod) {
+	switch(eMethod) {
+		case RECALC_METHOD_BRANCH_CHAIN:
+			for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+				for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+					pLevel->pVisTiles[ubX][ubY] = referenceGetVisTile(pLevel, ubX, ubY);
+				}
+			}
+			break;
+		case RECALC_METHOD_TABLES:
+			for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+				for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+					pLevel->pVisTiles[ubX][ubY] = autotileGetVisTile(pLevel, ubX, ubY);
+				}
+			}
+			break;
+		case RECALC_METHOD_COLUMN_BITMASKS:
+			autotileRecalcAllVisTiles(pLevel);
+			break;
+		default:
+			break;
+	}
+}
+
+static ULONG checkLevel(tLevel *pLevel, UBYTE ubIndex) {
+	recalcLevel(pLevel, RECALC_METHOD_BRANCH_CHAIN);
+	memcpy(s_pReferenceVisTiles, pLevel->pVisTiles, sizeof(s_pReferenceVisTiles));
+
+	ULONG ulMismatches = 0;
+	for(tRecalcMethod eMethod = RECALC_METHOD_TABLES; eMethod < RECALC_METHOD_COUNT; ++eMethod) {
+		recalcLevel(pLevel, eMethod);
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+				if(pLevel->pVisTiles[ubX][ubY] != s_pReferenceVisTiles[ubX][ubY]) {
+					printf(
+						"L%03hhu %hhu,%hhu: %s gives %d, branch chain %d\n", ubIndex, ubX, ubY,
+						s_pRecalcMethodNames[eMethod], pLevel->pVisTiles[ubX][ubY],
+						s_pReferenceVisTiles[ubX][ubY]
+					);
+					++ulMismatches;
+				}
+			}
+		}
+	}
+	return ulMismatches;
+}
+
+static void benchmark(UBYTE ubLevelCount, ULONG ulRepeats) {
+	for(tRecalcMethod eMethod = 0; eMethod < RECALC_METHOD_COUNT; ++eMethod) {
+		clock_t llStart = clock();
+		for(ULONG ulRepeat = 0; ulRepeat < ulRepeats; ++ulRepeat) {
+			for(UBYTE i = 0; i < ubLevelCount; ++i) {
+				recalcLevel(&s_pLevels[i], eMethod);
+			}
+		}
+		double dSeconds = (double)(clock() - llStart) / CLOCKS_PER_SEC;
+		printf(
+			"%s: %.1f us per level recalculation\n", s_pRecalcMethodNames[eMethod],
+			dSeconds * 1e6 / (ulRepeats * ubLevelCount)
+		);
+	}
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount < 2 || lArgCount > 3) {
+		printf("Usage: %s levels_dir [benchmark_repeats]\n", pArgs[0]);
+		return 1;
+	}
+	ULONG ulRepeats = (lArgCount == 3) ? strtoul(pArgs[2], 0, 10) : 1;
+
+	UBYTE ubLevelCount = 0;
+	ULONG ulMismatches = 0;
+	for(UWORD uwIndex = 1; uwIndex <= LEVEL_INDEX_LAST && ubLevelCount < LEVEL_COUNT_MAX; ++uwIndex) {
+		tLevel *pLevel = &s_pLevels[ubLevelCount];
+		if(!loadLevelTiles(pArgs[1], uwIndex, pLevel)) {
+			continue;
+		}
+		++ubLevelCount;
+		ulMismatches += checkLevel(pLevel, uwIndex);
+	}
+	printf("%hhu levels, %lu mismatching vis tiles\n", ubLevelCount, (unsigned long)ulMismatches);
+	TEST_CHECK(ubLevelCount > 0);
+	TEST_CHECK_EQUAL(ulMismatches, 0);
+
+	if(ubLevelCount && ulRepeats) {
+		benchmark(ubLevelCount, ulRepeats);
+	}
+	return testFinish();
+}
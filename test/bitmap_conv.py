@@ -0,0 +1,151 @@
+import argparse
+import pathlib
+import struct
+import sys
+import zlib
+
+# Host stand-in for ACE's bitmap_conv, so that bitmap bundle can be built
+# for tests without ACE tools. Colors are mapped to nearest palette entry
+# instead of requiring exact match, which is enough for unpacker tests.
+
+png_magic = b"\x89PNG\r\n\x1a\n"
+png_channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4} # By color type
+
+bm_version = 0
+bm_flag_interleaved = 1
+
+class ConvError(Exception):
+    pass
+
+def png_unfilter(raw: bytes, width: int, height: int, bpp: int) -> list:
+    stride = width * bpp
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for _ in range(height):
+        filter_type = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            left = line[i - bpp] if i >= bpp else 0
+            up = prev[i]
+            up_left = prev[i - bpp] if i >= bpp else 0
+            if filter_type == 1:
+                line[i] = (line[i] + left) & 0xFF
+            elif filter_type == 2:
+                line[i] = (line[i] + up) & 0xFF
+            elif filter_type == 3:
+                line[i] = (line[i] + (left + up) // 2) & 0xFF
+            elif filter_type == 4:
+                dist_left = abs(up - up_left)
+                dist_up = abs(left - up_left)
+                dist_up_left = abs(left + up - 2 * up_left)
+                if dist_left <= dist_up and dist_left <= dist_up_left:
+                    line[i] = (line[i] + left) & 0xFF
+                elif dist_up <= dist_up_left:
+                    line[i] = (line[i] + up) & 0xFF
+                else:
+                    line[i] = (line[i] + up_left) & 0xFF
+        rows.append(bytes(line))
+        prev = line
+    return rows
+
+def read_png(path: pathlib.Path) -> tuple:
+    data = path.read_bytes()
+    if not data.startswith(png_magic):
+        raise ConvError("{}: not a PNG".format(path))
+    pos = len(png_magic)
+    idat = bytearray()
+    palette = None
+    while pos < len(data):
+        length, chunk_type = struct.unpack_from(">L4s", data, pos)
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if chunk_type == b"IHDR":
+            width, height, bit_depth, color_type, _, _, interlace = struct.unpack(">LLBBBBB", chunk)
+        elif chunk_type == b"PLTE":
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, len(chunk), 3)]
+        elif chunk_type == b"IDAT":
+            idat += chunk
+    if bit_depth != 8 or interlace or color_type not in png_channels:
+        raise ConvError("{}: only 8-bit non-interlaced PNGs are supported".format(path))
+
+    bpp = png_channels[color_type]
+    rows = png_unfilter(zlib.decompress(idat), width, height, bpp)
+    if color_type == 3:
+        pixels = [[palette[index] for index in row] for row in rows]
+    elif bpp >= 3:
+        pixels = [[tuple(row[x:x + 3]) for x in range(0, len(row), bpp)] for row in rows]
+    else:
+        pixels = [[(row[x],) * 3 for x in range(0, len(row), bpp)] for row in rows]
+    return width, height, pixels
+
+def read_gpl(path: pathlib.Path) -> list:
+    colors = []
+    for line in path.read_text().splitlines():
+        parts = line.split()
+        if len(parts) >= 3 and all(part.isdigit() for part in parts[:3]):
+            colors.append(tuple(int(part) for part in parts[:3]))
+    return colors
+
+def parse_color(text: str) -> tuple:
+    value = int(text.lstrip("#"), 16)
+    return (value >> 16, (value >> 8) & 0xFF, value & 0xFF)
+
+def write_bm(path: pathlib.Path, indices: list, depth: int, interleaved: bool):
+    width = len(indices[0])
+    height = len(indices)
+    row_size = ((width + 15) // 16) * 2
+    planes = [[bytearray(row_size) for _ in range(height)] for _ in range(depth)]
+    for y, row in enumerate(indices):
+        for x, index in enumerate(row):
+            for plane in range(depth):
+                if index & (1 << plane):
+                    planes[plane][y][x >> 3] |= 0x80 >> (x & 7)
+    if interleaved:
+        data = b"".join(planes[plane][y] for y in range(height) for plane in range(depth))
+    else:
+        data = b"".join(planes[plane][y] for plane in range(depth) for y in range(height))
+    flags = bm_flag_interleaved if interleaved else 0
+    path.write_bytes(struct.pack(">HHBBBxx", width, height, depth, bm_version, flags) + data)
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description="Convert PNG to ACE .bm bitmap")
+    parser.add_argument("palette", type=pathlib.Path, help=".gpl palette")
+    parser.add_argument("source", type=pathlib.Path, help="source PNG")
+    parser.add_argument("destination", type=pathlib.Path, help="destination .bm")
+    parser.add_argument("--mask", type=pathlib.Path, help="also write mask .bm")
+    parser.add_argument("--mask-color", type=parse_color, help="transparent color as RRGGBB hex, e.g. 993399")
+    parser.add_argument("--planar", action="store_true", help="don't interleave bitplanes")
+    args = parser.parse_args()
+
+    try:
+        palette = read_gpl(args.palette)
+        _width, _height, pixels = read_png(args.source)
+    except ConvError as error:
+        print(error, file=sys.stderr)
+        return 1
+    depth = max(1, (len(palette) - 1).bit_length())
+    nearest = {}
+    def get_index(color: tuple) -> int:
+        if color == args.mask_color:
+            return 0
+        if color not in nearest:
+            nearest[color] = min(
+                range(len(palette)),
+                key=lambda i: sum((a - b) ** 2 for a, b in zip(palette[i], color))
+            )
+        return nearest[color]
+
+    interleaved = not args.planar
+    write_bm(args.destination, [[get_index(color) for color in row] for row in pixels], depth, interleaved)
+    if args.mask:
+        # Same depth as bitmap, so that it can be used directly as blitter mask
+        mask_index = (1 << depth) - 1
+        write_bm(args.mask, [
+            [0 if color == args.mask_color else mask_index for color in row] for row in pixels
+        ], depth, interleaved)
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
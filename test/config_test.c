@@ -0,0 +1,222 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <setjmp.h>
+#include <ace/utils/disk_file.h>
+#include "test.h"
+#include "config.h"
+
+// In-memory filesystem in which every written byte, truncation, move and
+// delete is a single step. Power is cut after given number of steps, after
+// which game is rebooted and must load either last saved progress or the one
+// which was being saved.
+
+#define VFS_FILES_MAX 4
+#define VFS_FILE_SIZE_MAX 64
+#define VFS_NAME_SIZE 16
+#define VFS_HANDLES_MAX 4
+#define SAVES_PER_RUN 6
+#define SAVES_AFTER_REBOOT 3
+#define STEP_BUDGET_UNLIMITED -1
+
+typedef struct tVfsFile {
+	char szName[VFS_NAME_SIZE];
+	UBYTE pData[VFS_FILE_SIZE_MAX];
+	ULONG ulSize;
+	UBYTE isUsed;
+} tVfsFile;
+
+struct tFile {
+	tVfsFile *pVfsFile;
+	ULONG ulPos;
+};
+
+typedef enum tScenario {
+	SCENARIO_FRESH,
+	SCENARIO_LEGACY,
+	SCENARIO_NO_UPDATE_IN_PLACE, // "r+b" can't be opened, so whole file is rewritten each time
+	SCENARIO_COUNT
+} tScenario;
+
+static const char *s_pScenarioNames[SCENARIO_COUNT] = {
+	"fresh", "legacy", "no update in place"
+};
+
+static tVfsFile s_pFiles[VFS_FILES_MAX];
+static struct tFile s_pHandles[VFS_HANDLES_MAX];
+static UBYTE s_ubNextHandle;
+static UBYTE s_isUpdateInPlaceAvailable;
+static LONG s_lStepBudget;
+static ULONG s_ulSteps;
+static jmp_buf s_sPowerCut;
+
+static void vfsStep(void) {
+	++s_ulSteps;
+	if(s_lStepBudget != STEP_BUDGET_UNLIMITED && s_lStepBudget-- == 0) {
+		longjmp(s_sPowerCut, 1);
+	}
+}
+
+static tVfsFile *vfsFind(const char *szPath) {
+	for(UBYTE i = 0; i < VFS_FILES_MAX; ++i) {
+		if(s_pFiles[i].isUsed && !strcmp(s_pFiles[i].szName, szPath)) {
+			return &s_pFiles[i];
+		}
+	}
+	return 0;
+}
+
+tFile *diskFileOpen(const char *szPath, const char *szMode) {
+	tVfsFile *pVfsFile = vfsFind(szPath);
+	if(szMode[0] == 'w') {
+		vfsStep();
+		for(UBYTE i = 0; !pVfsFile && i < VFS_FILES_MAX; ++i) {
+			if(!s_pFiles[i].isUsed) {
+				pVfsFile = &s_pFiles[i];
+				pVfsFile->isUsed = 1;
+				strcpy(pVfsFile->szName, szPath);
+			}
+		}
+		pVfsFile->ulSize = 0;
+	}
+	else if(szMode[1] == '+' && !s_isUpdateInPlaceAvailable) {
+		return 0;
+	}
+	if(!pVfsFile) {
+		return 0;
+	}
+
+	tFile *pFile = &s_pHandles[s_ubNextHandle++ % VFS_HANDLES_MAX];
+	pFile->pVfsFile = pVfsFile;
+	pFile->ulPos = 0;
+	return pFile;
+}
+
+ULONG fileRead(tFile *pFile, void *pDest, ULONG ulSize) {
+	const tVfsFile *pVfsFile = pFile->pVfsFile;
+	ULONG ulRead = pVfsFile->ulSize > pFile->ulPos ? pVfsFile->ulSize - pFile->ulPos : 0;
+	ulRead = MIN(ulRead, ulSize);
+	memcpy(pDest, &pVfsFile->pData[pFile->ulPos], ulRead);
+	pFile->ulPos += ulRead;
+	return ulRead;
+}
+
+ULONG fileWrite(tFile *pFile, const void *pSrc, ULONG ulSize) {
+	tVfsFile *pVfsFile = pFile->pVfsFile;
+	for(ULONG i = 0; i < ulSize; ++i) {
+		vfsStep();
+		pVfsFile->pData[pFile->ulPos++] = ((const UBYTE*)pSrc)[i];
+		pVfsFile->ulSize = MAX(pVfsFile->ulSize, pFile->ulPos);
+	}
+	return ulSize;
+}
+
+UBYTE fileSeek(tFile *pFile, LONG lPos, WORD wMode) {
+	pFile->ulPos = lPos;
+	return 1;
+}
+
+void fileClose(tFile *pFile) {
+	pFile->pVfsFile = 0;
+}
+
+UBYTE diskFileExists(const char *szPath) {
+	return vfsFind(szPath) != 0;
+}
+
+UBYTE diskFileDelete(const char *szPath) {
+	tVfsFile *pVfsFile = vfsFind(szPath);
+	if(!pVfsFile) {
+		return 0;
+	}
+	vfsStep();
+	pVfsFile->isUsed = 0;
+	return 1;
+}
+
+UBYTE diskFileMove(const char *szSource, const char *szDest) {
+	// Same as AmigaDOS Rename(), which fails if destination exists
+	tVfsFile *pVfsFile = vfsFind(szSource);
+	if(!pVfsFile || vfsFind(szDest)) {
+		return 0;
+	}
+	vfsStep();
+	strcpy(pVfsFile->szName, szDest);
+	return 1;
+}
+
+static void vfsReset(tScenario eScenario) {
+	memset(s_pFiles, 0, sizeof(s_pFiles));
+	s_isUpdateInPlaceAvailable = (eScenario != SCENARIO_NO_UPDATE_IN_PLACE);
+	if(eScenario == SCENARIO_LEGACY) {
+		// Old format, just unlocked and current level
+		s_pFiles[0].isUsed = 1;
+		strcpy(s_pFiles[0].szName, "save.dat");
+		s_pFiles[0].pData[0] = 3;
+		s_pFiles[0].pData[1] = 3;
+		s_pFiles[0].ulSize = 2;
+	}
+}
+
+static void setProgress(UBYTE ubLevel) {
+	g_sConfig.ubUnlockedLevels = ubLevel;
+	g_sConfig.ubCurrentLevel = ubLevel;
+}
+
+// Returns number of steps taken by power cut-free run
+static ULONG runScenario(tScenario eScenario, LONG lStepBudget) {
+	vfsReset(eScenario);
+	volatile UBYTE ubCommitted = (eScenario == SCENARIO_LEGACY) ? 3 : 1;
+	volatile UBYTE ubSaving = 0;
+	s_lStepBudget = lStepBudget;
+	s_ulSteps = 0;
+	if(!setjmp(s_sPowerCut)) {
+		configLoad();
+		TEST_CHECK_EQUAL(g_sConfig.ubUnlockedLevels, ubCommitted);
+		for(UBYTE i = 0; i < SAVES_PER_RUN; ++i) {
+			ubSaving = ubCommitted + 1;
+			setProgress(ubSaving);
+			configSave();
+			ubCommitted = ubSaving;
+			ubSaving = 0;
+		}
+	}
+	ULONG ulSteps = s_ulSteps;
+
+	// Reboot - progress must be either committed or the one being saved
+	s_lStepBudget = STEP_BUDGET_UNLIMITED;
+	configLoad();
+	UBYTE ubLoaded = g_sConfig.ubUnlockedLevels;
+	if(ubLoaded != ubCommitted && (!ubSaving || ubLoaded != ubSaving)) {
+		printf(
+			"%s, power cut after %ld steps: loaded %hhu, committed %hhu, saving %hhu\n",
+			s_pScenarioNames[eScenario], (long)lStepBudget, ubLoaded, ubCommitted, ubSaving
+		);
+		TEST_CHECK(0);
+	}
+	TEST_CHECK_EQUAL(g_sConfig.ubCurrentLevel, ubLoaded);
+
+	// Saving after recovery works as usual
+	for(UBYTE i = 1; i <= SAVES_AFTER_REBOOT; ++i) {
+		setProgress(ubLoaded + i);
+		configSave();
+		configLoad();
+		TEST_CHECK_EQUAL(g_sConfig.ubUnlockedLevels, ubLoaded + i);
+	}
+	return ulSteps;
+}
+
+int main(void) {
+	for(tScenario eScenario = 0; eScenario < SCENARIO_COUNT; ++eScenario) {
+		ULONG ulSteps = runScenario(eScenario, STEP_BUDGET_UNLIMITED);
+		for(ULONG ulCut = 0; ulCut <= ulSteps; ++ulCut) {
+			runScenario(eScenario, ulCut);
+		}
+		printf(
+			"%s: power cut at each of %lu steps of %d saves\n",
+			s_pScenarioNames[eScenario], (unsigned long)ulSteps, SAVES_PER_RUN
+		);
+	}
+	return testFinish();
+}
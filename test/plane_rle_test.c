@@ -0,0 +1,220 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <stdlib.h>
+#include "test.h"
+#include "plane_rle.h"
+
+// Unpacks planes of every level in built level pack in place, the same way
+// as mapParseLevel() does, and compares them with loose level files.
+
+#define LEVEL_HEADER_SIZE 32
+#define LEVEL_PAYLOAD_SIZE_OFFSET 6
+#define LEVEL_FLAGS_OFFSET 29
+#define LEVEL_STORED_SIZE_OFFSET 30
+#define LEVEL_FLAG_PACKED_PLANES BV(0)
+#define LEVEL_PLANES_SIZE (2 * MAP_TILE_WIDTH * MAP_TILE_HEIGHT * sizeof(UWORD))
+#define PACK_HEADER_SIZE 8
+#define PACK_ENTRY_SIZE 8
+
+static UWORD readUword(const UBYTE *pData) {
+	return (pData[0] << 8) | pData[1];
+}
+
+static ULONG readUlong(const UBYTE *pData) {
+	return ((ULONG)readUword(&pData[0]) << 16) | readUword(&pData[2]);
+}
+
+static UBYTE *readFile(const char *szPath, ULONG *pSize) {
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		return 0;
+	}
+	fseek(pFile, 0, SEEK_END);
+	*pSize = ftell(pFile);
+	fseek(pFile, 0, SEEK_SET);
+	UBYTE *pData = malloc(*pSize);
+	if(fread(pData, 1, *pSize, pFile) != *pSize) {
+		free(pData);
+		pData = 0;
+	}
+	fclose(pFile);
+	return pData;
+}
+
+// Walks packed data like planeRleUnpack() does and returns how much bigger
+// than unpacked planes the buffer needs to be, so that no write in place
+// lands on packed byte which hasn't been read yet.
+static LONG getUnpackMarginNeeded(const UBYTE *pPacked, UWORD uwPackedSize) {
+	LONG lSrc = LEVEL_PLANES_SIZE - uwPackedSize; // Next unread, with no margin
+	LONG lMargin = 0;
+	ULONG ulDst = 0;
+	ULONG ulPos = 0;
+	while(ulDst < LEVEL_PLANES_SIZE && ulPos < uwPackedSize) {
+		UBYTE ubControl = pPacked[ulPos++];
+		++lSrc;
+		UWORD uwCount = ((ubControl & PLANE_RLE_COUNT_MASK) + 1) * sizeof(UWORD);
+		UBYTE ubOp = ubControl & PLANE_RLE_OP_MASK;
+		if(ubOp == PLANE_RLE_FILL) {
+			ulPos += sizeof(UWORD);
+			lSrc += sizeof(UWORD);
+		}
+		for(UWORD i = 0; i < uwCount; ++i) {
+			if(ubOp == PLANE_RLE_LITERAL) {
+				++ulPos;
+				++lSrc;
+			}
+			lMargin = MAX(lMargin, (LONG)ulDst + 1 - lSrc);
+			++ulDst;
+		}
+	}
+	return lMargin;
+}
+
+static void testSyntheticMargin(void) {
+	// Fills first, then incompressible literals - in place it gets closest
+	// to unread data at the end of fills.
+	static UBYTE pPacked[LEVEL_PLANES_SIZE];
+	static UBYTE pExpected[LEVEL_PLANES_SIZE];
+	UWORD uwOpWords = PLANE_RLE_COUNT_MASK + 1;
+	UWORD uwOpCount = LEVEL_PLANES_SIZE / sizeof(UWORD) / uwOpWords / 2;
+	UWORD uwPos = 0;
+	UWORD uwDst = 0;
+	for(UWORD i = 0; i < uwOpCount; ++i) {
+		pPacked[uwPos++] = PLANE_RLE_FILL | PLANE_RLE_COUNT_MASK;
+		pPacked[uwPos++] = i;
+		pPacked[uwPos++] = 0x55;
+		for(UWORD j = 0; j < uwOpWords; ++j) {
+			pExpected[uwDst++] = i;
+			pExpected[uwDst++] = 0x55;
+		}
+	}
+	for(UWORD i = 0; i < uwOpCount; ++i) {
+		pPacked[uwPos++] = PLANE_RLE_LITERAL | PLANE_RLE_COUNT_MASK;
+		for(UWORD j = 0; j < uwOpWords * sizeof(UWORD); ++j) {
+			pPacked[uwPos++] = pExpected[uwDst++] = rand();
+		}
+	}
+
+	// Fills end 20 bytes past what was read, literals lag 1 byte less each
+	LONG lMargin = getUnpackMarginNeeded(pPacked, uwPos);
+	TEST_CHECK_EQUAL(lMargin, uwOpCount);
+
+	UBYTE *pBuffer = malloc(LEVEL_PLANES_SIZE + lMargin);
+	UBYTE *pData = &pBuffer[LEVEL_PLANES_SIZE + lMargin - uwPos];
+	memcpy(pData, pPacked, uwPos);
+	TEST_CHECK(planeRleUnpack(pData, &pData[uwPos], pBuffer, LEVEL_PLANES_SIZE) == &pData[uwPos]);
+	TEST_CHECK(!memcmp(pBuffer, pExpected, LEVEL_PLANES_SIZE));
+	free(pBuffer);
+}
+
+static void checkLevel(
+	const UBYTE *pStored, UWORD uwEntrySize, const UBYTE *pLoose, ULONG ulLooseSize,
+	UBYTE ubIndex, LONG *pMarginMax
+) {
+	UWORD uwPayloadSize = readUword(&pStored[LEVEL_PAYLOAD_SIZE_OFFSET]);
+	UBYTE isPacked = pStored[LEVEL_FLAGS_OFFSET] & LEVEL_FLAG_PACKED_PLANES;
+	UWORD uwStoredSize = isPacked ? readUword(&pStored[LEVEL_STORED_SIZE_OFFSET]) : uwPayloadSize;
+	TEST_CHECK_EQUAL(uwEntrySize, LEVEL_HEADER_SIZE + uwStoredSize);
+	TEST_CHECK_EQUAL(ulLooseSize, LEVEL_HEADER_SIZE + uwPayloadSize);
+	if(
+		uwEntrySize != LEVEL_HEADER_SIZE + uwStoredSize ||
+		ulLooseSize != LEVEL_HEADER_SIZE + (ULONG)uwPayloadSize
+	) {
+		return;
+	}
+	if(!isPacked) {
+		TEST_CHECK(!memcmp(pStored, pLoose, ulLooseSize));
+		return;
+	}
+
+	// Same buffer layout as mapLoadLevelV2(): stored data at the end
+	UWORD uwSectionsSize = uwPayloadSize - LEVEL_PLANES_SIZE;
+	UWORD uwPackedSize = uwStoredSize - uwSectionsSize;
+	UWORD uwBufferSize = uwPayloadSize + PLANE_RLE_UNPACK_MARGIN;
+	UBYTE *pBuffer = malloc(uwBufferSize);
+	UBYTE *pData = &pBuffer[uwBufferSize - uwStoredSize];
+	const UBYTE *pSections = &pBuffer[uwBufferSize - uwSectionsSize];
+	memcpy(pData, &pStored[LEVEL_HEADER_SIZE], uwStoredSize);
+
+	LONG lMargin = getUnpackMarginNeeded(pData, uwPackedSize);
+	*pMarginMax = MAX(*pMarginMax, lMargin);
+	if(lMargin > PLANE_RLE_UNPACK_MARGIN) {
+		printf("L%03hhu needs unpack margin of %ld bytes\n", ubIndex, (long)lMargin);
+		TEST_CHECK(0);
+	}
+
+	const UBYTE *pPackedEnd = planeRleUnpack(pData, pSections, pBuffer, LEVEL_PLANES_SIZE);
+	TEST_CHECK(pPackedEnd == pSections);
+	if(memcmp(pBuffer, &pLoose[LEVEL_HEADER_SIZE], LEVEL_PLANES_SIZE)) {
+		printf("L%03hhu planes differ from loose file\n", ubIndex);
+		TEST_CHECK(0);
+	}
+	TEST_CHECK(!memcmp(pSections, &pLoose[LEVEL_HEADER_SIZE + LEVEL_PLANES_SIZE], uwSectionsSize));
+
+	// Truncated data must be rejected, not read past
+	TEST_CHECK(planeRleUnpack(
+		&pStored[LEVEL_HEADER_SIZE], &pStored[LEVEL_HEADER_SIZE + uwPackedSize / 2],
+		pBuffer, LEVEL_PLANES_SIZE
+	) == 0);
+	free(pBuffer);
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount != 3) {
+		printf("Usage: %s levels.pak levels_dir\n", pArgs[0]);
+		return 1;
+	}
+
+	ULONG ulPackSize;
+	UBYTE *pPack = readFile(pArgs[1], &ulPackSize);
+	if(!pPack || ulPackSize < PACK_HEADER_SIZE || memcmp(pPack, "SLPK", 4)) {
+		printf("Can't read level pack %s\n", pArgs[1]);
+		return 1;
+	}
+
+	testSyntheticMargin();
+
+	UWORD uwEntryCount = readUword(&pPack[4]);
+	UBYTE ubPackedCount = 0;
+	LONG lMarginMax = 0;
+	for(UWORD i = 0; i < uwEntryCount; ++i) {
+		const UBYTE *pEntry = &pPack[PACK_HEADER_SIZE + i * PACK_ENTRY_SIZE];
+		UBYTE ubIndex = pEntry[0];
+		UWORD uwSize = readUword(&pEntry[2]);
+		ULONG ulOffset = readUlong(&pEntry[4]);
+		const UBYTE *pStored = &pPack[ulOffset];
+		if(ulOffset + uwSize > ulPackSize) {
+			printf("L%03hhu entry out of pack bounds\n", ubIndex);
+			TEST_CHECK(0);
+			continue;
+		}
+
+		char szPath[256];
+		snprintf(szPath, sizeof(szPath), "%s/L%03hhu.dat", pArgs[2], ubIndex);
+		ULONG ulLooseSize;
+		UBYTE *pLoose = readFile(szPath, &ulLooseSize);
+		TEST_CHECK(pLoose != 0);
+		if(!pLoose) {
+			continue;
+		}
+		if(uwSize < LEVEL_HEADER_SIZE || memcmp(pStored, "SLVL", 4)) {
+			// Levels older than v2 are stored as is
+			TEST_CHECK(uwSize == ulLooseSize && !memcmp(pStored, pLoose, uwSize));
+		}
+		else {
+			ubPackedCount += (pStored[LEVEL_FLAGS_OFFSET] & LEVEL_FLAG_PACKED_PLANES) != 0;
+			checkLevel(pStored, uwSize, pLoose, ulLooseSize, ubIndex, &lMarginMax);
+		}
+		free(pLoose);
+	}
+	free(pPack);
+
+	printf(
+		"%hu levels, %hhu with packed planes, unpack margin needed %ld of %d\n",
+		uwEntryCount, ubPackedCount, (long)lMarginMax, PLANE_RLE_UNPACK_MARGIN
+	);
+	TEST_CHECK(ubPackedCount > 0);
+	return testFinish();
+}
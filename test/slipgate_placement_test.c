@@ -0,0 +1,261 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <stdlib.h>
+#include "test.h"
+#include "slipgate_placement.h"
+
+// Compares placement table with per-case checks it has replaced, on every
+// slipgatable tile of shipped levels, for every normal.
+
+#define LEVEL_INDEX_LAST 100
+#define LEVEL_HEADER_SIZE 32
+#define LEVEL_VERSION 2
+#define LEVEL_FLAGS_OFFSET 29
+#define LEVEL_FLAG_PACKED_PLANES BV(0)
+
+typedef struct tReferencePlacement {
+	tDirection eNormal;
+	tBCoordYX pTileOffsets[4];
+} tReferencePlacement;
+
+static tLevel s_sLevel;
+static ULONG s_ulPlacementCount;
+
+//------------------------------------------------------------ OLD PLACEMENT CODE
+
+// Old code read outside the map on edges, here those tiles are solid
+static UBYTE isEmptyAt(WORD wX, WORD wY) {
+	if(wX < 0 || wX >= MAP_TILE_WIDTH || wY < 0 || wY >= MAP_TILE_HEIGHT) {
+		return 0;
+	}
+	return s_sLevel.pTiles[wX][wY] == TILE_BG;
+}
+
+static UBYTE isSlipgatableAt(WORD wX, WORD wY) {
+	if(wX < 0 || wX >= MAP_TILE_WIDTH || wY < 0 || wY >= MAP_TILE_HEIGHT) {
+		return 0;
+	}
+	return (s_sLevel.pTiles[wX][wY] & TILE_LAYER_SLIPGATABLE) != 0;
+}
+
+static void setReference(
+	tReferencePlacement *pPlacement, tDirection eNormal,
+	BYTE bX0, BYTE bY0, BYTE bX1, BYTE bY1, BYTE bX2, BYTE bY2, BYTE bX3, BYTE bY3
+) {
+	pPlacement->eNormal = eNormal;
+	pPlacement->pTileOffsets[0] = (tBCoordYX){.bX = bX0, .bY = bY0};
+	pPlacement->pTileOffsets[1] = (tBCoordYX){.bX = bX1, .bY = bY1};
+	pPlacement->pTileOffsets[2] = (tBCoordYX){.bX = bX2, .bY = bY2};
+	pPlacement->pTileOffsets[3] = (tBCoordYX){.bX = bX3, .bY = bY3};
+}
+
+static UBYTE tryLeftBelow(tReferencePlacement *pPlacement, WORD x, WORD y) {
+	if(
+		!isEmptyAt(x, y - 1) && isEmptyAt(x - 1, y) && isSlipgatableAt(x, y + 1) &&
+		isEmptyAt(x - 1, y + 1) && !isEmptyAt(x, y + 2)
+	) {
+		setReference(pPlacement, DIRECTION_LEFT, 0, 0, 0, 1, -1, 0, -1, 1);
+		return 1;
+	}
+	return 0;
+}
+
+static UBYTE tryLeftAbove(tReferencePlacement *pPlacement, WORD x, WORD y) {
+	if(
+		!isEmptyAt(x, y - 2) && isEmptyAt(x - 1, y - 1) && isSlipgatableAt(x, y - 1) &&
+		isEmptyAt(x - 1, y) && !isEmptyAt(x - 1, y + 1)
+	) {
+		setReference(pPlacement, DIRECTION_LEFT, 0, -1, 0, 0, -1, -1, -1, 0);
+		return 1;
+	}
+	return 0;
+}
+
+static UBYTE tryRightBelow(tReferencePlacement *pPlacement, WORD x, WORD y) {
+	if(
+		!isEmptyAt(x, y - 1) && isEmptyAt(x + 1, y) && isSlipgatableAt(x, y + 1) &&
+		isEmptyAt(x + 1, y + 1) && !isEmptyAt(x, y + 2)
+	) {
+		setReference(pPlacement, DIRECTION_RIGHT, 0, 0, 0, 1, 1, 0, 1, 1);
+		return 1;
+	}
+	return 0;
+}
+
+static UBYTE tryRightAbove(tReferencePlacement *pPlacement, WORD x, WORD y) {
+	if(
+		!isEmptyAt(x, y - 2) && isEmptyAt(x + 1, y - 1) && isSlipgatableAt(x, y - 1) &&
+		isEmptyAt(x + 1, y) && !isEmptyAt(x, y + 1)
+	) {
+		setReference(pPlacement, DIRECTION_RIGHT, 0, -1, 0, 0, 1, -1, 1, 0);
+		return 1;
+	}
+	return 0;
+}
+
+static UBYTE tryUpRight(tReferencePlacement *pPlacement, WORD x, WORD y) {
+	if(
+		!isEmptyAt(x - 1, y) && isEmptyAt(x, y - 1) && isSlipgatableAt(x + 1, y) &&
+		isEmptyAt(x + 1, y - 1) && !isEmptyAt(x + 2, y)
+	) {
+		setReference(pPlacement, DIRECTION_UP, 0, 0, 1, 0, 0, -1, 1, -1);
+		return 1;
+	}
+	return 0;
+}
+
+static UBYTE tryUpLeft(tReferencePlacement *pPlacement, WORD x, WORD y) {
+	if(
+		!isEmptyAt(x - 2, y) && isEmptyAt(x - 1, y - 1) && isSlipgatableAt(x - 1, y) &&
+		isEmptyAt(x, y - 1) && !isEmptyAt(x + 1, y)
+	) {
+		setReference(pPlacement, DIRECTION_UP, -1, 0, 0, 0, -1, -1, 0, -1);
+		return 1;
+	}
+	return 0;
+}
+
+static UBYTE tryDownRight(tReferencePlacement *pPlacement, WORD x, WORD y) {
+	if(
+		!isEmptyAt(x - 1, y) && isEmptyAt(x, y + 1) && isSlipgatableAt(x + 1, y) &&
+		isEmptyAt(x + 1, y + 1) && !isEmptyAt(x + 2, y)
+	) {
+		setReference(pPlacement, DIRECTION_DOWN, 0, 0, 1, 0, 0, 1, 1, 1);
+		return 1;
+	}
+	return 0;
+}
+
+static UBYTE tryDownLeft(tReferencePlacement *pPlacement, WORD x, WORD y) {
+	if(
+		!isEmptyAt(x - 2, y) && isEmptyAt(x - 1, y + 1) && isSlipgatableAt(x - 1, y) &&
+		isEmptyAt(x, y + 1) && !isEmptyAt(x + 1, y)
+	) {
+		setReference(pPlacement, DIRECTION_DOWN, -1, 0, 0, 0, -1, 1, 0, 1);
+		return 1;
+	}
+	return 0;
+}
+
+static UBYTE findReference(
+	tReferencePlacement *pPlacement, WORD x, WORD y, tDirection eNormal
+) {
+	switch(eNormal) {
+		case DIRECTION_LEFT:
+			return tryLeftAbove(pPlacement, x, y) || tryLeftBelow(pPlacement, x, y);
+		case DIRECTION_RIGHT:
+			return tryRightAbove(pPlacement, x, y) || tryRightBelow(pPlacement, x, y);
+		case DIRECTION_UP:
+			return tryUpRight(pPlacement, x, y) || tryUpLeft(pPlacement, x, y);
+		case DIRECTION_DOWN:
+			return tryDownRight(pPlacement, x, y) || tryDownLeft(pPlacement, x, y);
+		default:
+			return 0;
+	}
+}
+
+//---------------------------------------------------------------------- LEVELS
+
+static UBYTE loadLevelTiles(const char *szDir, UBYTE ubIndex) {
+	char szPath[256];
+	snprintf(szPath, sizeof(szPath), "%s/L%03hhu.dat", szDir, ubIndex);
+	FILE *pFile = fopen(szPath, "rb");
+	if(!pFile) {
+		return 0;
+	}
+
+	UBYTE pHeader[LEVEL_HEADER_SIZE];
+	UBYTE pPlane[MAP_TILE_HEIGHT][MAP_TILE_WIDTH][2];
+	if(fread(pHeader, sizeof(pHeader), 1, pFile) != 1 || memcmp(pHeader, "SLVL", 4)) {
+		// L100 is in layout older than v1, which game can't load either
+		printf("%s: skipped, not a v2 level\n", szPath);
+		fclose(pFile);
+		return 0;
+	}
+	UBYTE isLoaded = (
+		pHeader[4] == LEVEL_VERSION &&
+		!(pHeader[LEVEL_FLAGS_OFFSET] & LEVEL_FLAG_PACKED_PLANES) &&
+		fread(pPlane, sizeof(pPlane), 1, pFile) == 1
+	);
+	fclose(pFile);
+	if(!isLoaded) {
+		printf("%s: not an unpacked v2 level\n", szPath);
+		TEST_CHECK(0);
+		return 0;
+	}
+
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			s_sLevel.pTiles[ubX][ubY] = (pPlane[ubY][ubX][0] << 8) | pPlane[ubY][ubX][1];
+		}
+	}
+	return 1;
+}
+
+static ULONG checkLevel(UBYTE ubIndex) {
+	static const tDirection pNormals[] = {
+		DIRECTION_UP, DIRECTION_DOWN, DIRECTION_LEFT, DIRECTION_RIGHT
+	};
+
+	ULONG ulChecked = 0;
+	for(UBYTE ubY = 0; ubY < MAP_TILE_HEIGHT; ++ubY) {
+		for(UBYTE ubX = 0; ubX < MAP_TILE_WIDTH; ++ubX) {
+			if(!isSlipgatableAt(ubX, ubY)) {
+				continue;
+			}
+			for(UBYTE i = 0; i < sizeof(pNormals) / sizeof(pNormals[0]); ++i) {
+				tReferencePlacement sReference;
+				UBYTE isFound = findReference(&sReference, ubX, ubY, pNormals[i]);
+				const tSlipgatePlacement *pPlacement = slipgatePlacementFind(
+					&s_sLevel, ubX, ubY, pNormals[i]
+				);
+				++ulChecked;
+				if(isFound != (pPlacement != 0)) {
+					printf(
+						"L%03hhu %hhu,%hhu normal %d: reference %s placement, table %s\n",
+						ubIndex, ubX, ubY, pNormals[i], isFound ? "has" : "has no",
+						pPlacement ? "has" : "doesn't"
+					);
+					TEST_CHECK(0);
+					continue;
+				}
+				if(!isFound) {
+					continue;
+				}
+				++s_ulPlacementCount;
+				TEST_CHECK_EQUAL(pPlacement->eNormal, sReference.eNormal);
+				for(UBYTE ubTile = 0; ubTile < 4; ++ubTile) {
+					TEST_CHECK_EQUAL(pPlacement->pTileOffsets[ubTile].bX, sReference.pTileOffsets[ubTile].bX);
+					TEST_CHECK_EQUAL(pPlacement->pTileOffsets[ubTile].bY, sReference.pTileOffsets[ubTile].bY);
+				}
+			}
+		}
+	}
+	return ulChecked;
+}
+
+int main(int lArgCount, char *pArgs[]) {
+	if(lArgCount != 2) {
+		printf("Usage: %s levels_dir\n", pArgs[0]);
+		return 1;
+	}
+
+	UBYTE ubLevelCount = 0;
+	ULONG ulChecked = 0;
+	for(UWORD uwIndex = 1; uwIndex <= LEVEL_INDEX_LAST; ++uwIndex) {
+		if(!loadLevelTiles(pArgs[1], uwIndex)) {
+			continue;
+		}
+		++ubLevelCount;
+		ulChecked += checkLevel(uwIndex);
+	}
+	printf(
+		"%hhu levels, %lu tile sides checked, %lu placements found\n",
+		ubLevelCount, (unsigned long)ulChecked, (unsigned long)s_ulPlacementCount
+	);
+	TEST_CHECK(ubLevelCount > 0);
+	TEST_CHECK(s_ulPlacementCount > 0);
+	return testFinish();
+}
@@ -0,0 +1,134 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <stdlib.h>
+#include "test.h"
+#include "sprite_pool.h"
+
+#define CHANNEL_FIRST 1
+#define CHANNEL_COUNT 5
+#define RANDOM_ROUNDS 10000
+
+static void testChannelRange(void) {
+	spritePoolInit(6, 5);
+	spritePoolReset();
+	UBYTE pHandles[3];
+	for(UBYTE i = 0; i < 3; ++i) {
+		pHandles[i] = spritePoolPush(i * 20, 0, 8, 0);
+	}
+	TEST_CHECK_EQUAL(spritePoolAssign(), 1);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(pHandles[0]), 6);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(pHandles[1]), 7);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(pHandles[2]), SPRITE_POOL_CHANNEL_NONE);
+}
+
+static void testVerticalReuse(void) {
+	spritePoolInit(CHANNEL_FIRST, 1);
+	spritePoolReset();
+	// Pushed out of order, so that sorting is needed too
+	UBYTE ubTooClose = spritePoolPush(0, 2 * 8 + SPRITE_POOL_REUSE_GAP, 8, 0);
+	UBYTE ubAfterGap = spritePoolPush(0, 8 + SPRITE_POOL_REUSE_GAP, 8, 0);
+	UBYTE ubFirst = spritePoolPush(0, 0, 8, 0);
+	TEST_CHECK_EQUAL(spritePoolAssign(), 1);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(ubFirst), CHANNEL_FIRST);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(ubAfterGap), CHANNEL_FIRST);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(ubTooClose), SPRITE_POOL_CHANNEL_NONE);
+
+	TEST_CHECK_EQUAL(spritePoolGetCount(), 3);
+	TEST_CHECK_EQUAL(spritePoolGetSorted(0)->wY, 0);
+	TEST_CHECK_EQUAL(spritePoolGetSorted(1)->wY, 8 + SPRITE_POOL_REUSE_GAP);
+	TEST_CHECK_EQUAL(spritePoolGetSorted(2)->wY, 2 * 8 + SPRITE_POOL_REUSE_GAP);
+}
+
+static void testPoolFull(void) {
+	spritePoolInit(CHANNEL_FIRST, CHANNEL_COUNT);
+	spritePoolReset();
+	for(UBYTE i = 0; i < SPRITE_POOL_OBJECTS_MAX; ++i) {
+		TEST_CHECK_EQUAL(spritePoolPush(0, i * 20, 16, 0), i);
+	}
+	TEST_CHECK_EQUAL(spritePoolPush(0, 0, 16, 0), SPRITE_POOL_HANDLE_NONE);
+	TEST_CHECK_EQUAL(spritePoolAssign(), 0);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(SPRITE_POOL_HANDLE_NONE), SPRITE_POOL_CHANNEL_NONE);
+}
+
+static void testOccluders(void) {
+	spritePoolInit(CHANNEL_FIRST, 1);
+	spritePoolReset();
+	spritePoolAddOccluder(100, 50, 20, 20);
+	UBYTE ubInside = spritePoolPush(110, 40, 16, 0);
+	UBYTE ubTouchingLeft = spritePoolPush(100 - SPRITE_POOL_SPRITE_WIDTH + 1, 69, 8, 0);
+	UBYTE ubLeft = spritePoolPush(100 - SPRITE_POOL_SPRITE_WIDTH, 40, 16, 0);
+	UBYTE ubBelow = spritePoolPush(100, 70, 8, 0);
+	TEST_CHECK_EQUAL(spritePoolAssign(), 2);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(ubInside), SPRITE_POOL_CHANNEL_NONE);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(ubTouchingLeft), SPRITE_POOL_CHANNEL_NONE);
+	// Occluded objects don't take lines of the only channel
+	TEST_CHECK_EQUAL(spritePoolGetChannel(ubLeft), CHANNEL_FIRST);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(ubBelow), CHANNEL_FIRST);
+
+	// Occluders last for single frame
+	spritePoolReset();
+	ubInside = spritePoolPush(110, 40, 16, 0);
+	TEST_CHECK_EQUAL(spritePoolAssign(), 0);
+	TEST_CHECK_EQUAL(spritePoolGetChannel(ubInside), CHANNEL_FIRST);
+}
+
+static UBYTE isLineTaken(const tSpritePoolEntry *pEntry, UBYTE ubChannel, WORD wY) {
+	return (
+		pEntry->ubChannel == ubChannel && pEntry->wY <= wY &&
+		wY < pEntry->wY + pEntry->ubHeight + SPRITE_POOL_REUSE_GAP
+	);
+}
+
+static void testRandomFrames(void) {
+	spritePoolInit(CHANNEL_FIRST, CHANNEL_COUNT);
+	srand(1234);
+	for(ULONG ulRound = 0; ulRound < RANDOM_ROUNDS; ++ulRound) {
+		spritePoolReset();
+		UBYTE ubCount = rand() % (SPRITE_POOL_OBJECTS_MAX + 1);
+		for(UBYTE i = 0; i < ubCount; ++i) {
+			spritePoolPush(rand() % 320, rand() % 64, 1 + rand() % 16, 0);
+		}
+		UBYTE ubUnassigned = spritePoolAssign();
+
+		UBYTE ubUnassignedCounted = 0;
+		for(UBYTE i = 0; i < ubCount; ++i) {
+			const tSpritePoolEntry *pEntry = spritePoolGetSorted(i);
+			if(i) {
+				TEST_CHECK(spritePoolGetSorted(i - 1)->wY <= pEntry->wY);
+			}
+			if(pEntry->ubChannel == SPRITE_POOL_CHANNEL_NONE) {
+				// Object may be left out only if all channels are busy on its first line
+				++ubUnassignedCounted;
+				for(UBYTE ubChannel = CHANNEL_FIRST; ubChannel < CHANNEL_FIRST + CHANNEL_COUNT; ++ubChannel) {
+					UBYTE isTaken = 0;
+					for(UBYTE j = 0; j < i; ++j) {
+						isTaken |= isLineTaken(spritePoolGetSorted(j), ubChannel, pEntry->wY);
+					}
+					TEST_CHECK(isTaken);
+				}
+				continue;
+			}
+
+			TEST_CHECK(
+				CHANNEL_FIRST <= pEntry->ubChannel &&
+				pEntry->ubChannel < CHANNEL_FIRST + CHANNEL_COUNT
+			);
+			// Previous object on the same channel must end before this one starts
+			for(UBYTE j = 0; j < i; ++j) {
+				TEST_CHECK(!isLineTaken(spritePoolGetSorted(j), pEntry->ubChannel, pEntry->wY));
+			}
+		}
+		TEST_CHECK_EQUAL(ubUnassigned, ubUnassignedCounted);
+	}
+}
+
+int main(void) {
+	testChannelRange();
+	testVerticalReuse();
+	testPoolFull();
+	testOccluders();
+	testRandomFrames();
+	return testFinish();
+}
@@ -0,0 +1,14 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_BLIT_H
+#define SLIPGATES_TEST_STUB_ACE_BLIT_H
+
+#include <ace/utils/bitmap.h>
+
+UBYTE blitRect(
+	tBitMap *pDst, WORD wDstX, WORD wDstY, WORD wWidth, WORD wHeight, UBYTE ubColor
+);
+
+#endif // SLIPGATES_TEST_STUB_ACE_BLIT_H
@@ -0,0 +1,13 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_LOG_H
+#define SLIPGATES_TEST_STUB_ACE_LOG_H
+
+#include <stdio.h>
+#include <ace/types.h>
+
+#define logWrite(...) printf(__VA_ARGS__)
+
+#endif // SLIPGATES_TEST_STUB_ACE_LOG_H
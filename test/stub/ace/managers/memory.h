@@ -0,0 +1,19 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_MEMORY_H
+#define SLIPGATES_TEST_STUB_ACE_MEMORY_H
+
+#include <ace/types.h>
+#include <ace/managers/log.h>
+
+void *memAllocChip(ULONG ulSize);
+
+void *memAllocFast(ULONG ulSize);
+
+void memFree(void *pMem, ULONG ulSize);
+
+ULONG memGetFreeChipSize(void);
+
+#endif // SLIPGATES_TEST_STUB_ACE_MEMORY_H
@@ -0,0 +1,17 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_PTPLAYER_H
+#define SLIPGATES_TEST_STUB_ACE_PTPLAYER_H
+
+#include <ace/types.h>
+
+// Contents aren't used by tested code
+typedef struct tPtplayerMod tPtplayerMod;
+
+tPtplayerMod *ptplayerModCreateFromPath(const char *szPath);
+
+void ptplayerModDestroy(tPtplayerMod *pMod);
+
+#endif // SLIPGATES_TEST_STUB_ACE_PTPLAYER_H
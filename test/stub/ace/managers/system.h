@@ -0,0 +1,13 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_SYSTEM_H
+#define SLIPGATES_TEST_STUB_ACE_SYSTEM_H
+
+#include <ace/types.h>
+
+static inline void systemUse(void) {}
+static inline void systemUnuse(void) {}
+
+#endif // SLIPGATES_TEST_STUB_ACE_SYSTEM_H
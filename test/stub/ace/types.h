@@ -0,0 +1,46 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_TYPES_H
+#define SLIPGATES_TEST_STUB_ACE_TYPES_H
+
+// Host stand-in for ACE types, just enough for game code under test
+
+#include <stdint.h>
+#include <string.h>
+#include <ace/macros.h>
+
+typedef uint8_t UBYTE;
+typedef int8_t BYTE;
+typedef uint16_t UWORD;
+typedef int16_t WORD;
+typedef uint32_t ULONG;
+typedef int32_t LONG;
+
+// Field order as on big endian Amiga isn't needed by code under test
+typedef union tUbCoordYX {
+	struct {
+		UBYTE ubY;
+		UBYTE ubX;
+	};
+	UWORD uwYX;
+} tUbCoordYX;
+
+typedef union tUwCoordYX {
+	struct {
+		UWORD uwY;
+		UWORD uwX;
+	};
+	ULONG ulYX;
+} tUwCoordYX;
+
+typedef union tBCoordYX {
+	struct {
+		BYTE bY;
+		BYTE bX;
+	};
+	UWORD uwYX;
+} tBCoordYX;
+
+#endif // SLIPGATES_TEST_STUB_ACE_TYPES_H
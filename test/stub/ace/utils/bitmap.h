@@ -0,0 +1,27 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_BITMAP_H
+#define SLIPGATES_TEST_STUB_ACE_BITMAP_H
+
+#include <ace/types.h>
+
+#define BMF_CLEAR 1
+#define BMF_INTERLEAVED 4
+
+// Same fields as graphics.library struct BitMap used by ACE
+typedef struct tBitMap {
+	UWORD BytesPerRow;
+	UWORD Rows;
+	UBYTE Flags;
+	UBYTE Depth;
+	UWORD pad;
+	UBYTE *Planes[8];
+} tBitMap;
+
+tBitMap *bitmapCreateFromPath(const char *szPath, UBYTE isFast);
+
+void bitmapDestroy(tBitMap *pBitMap);
+
+#endif // SLIPGATES_TEST_STUB_ACE_BITMAP_H
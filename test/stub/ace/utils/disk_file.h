@@ -0,0 +1,18 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_DISK_FILE_H
+#define SLIPGATES_TEST_STUB_ACE_DISK_FILE_H
+
+#include <ace/utils/file.h>
+
+tFile *diskFileOpen(const char *szPath, const char *szMode);
+
+UBYTE diskFileExists(const char *szPath);
+
+UBYTE diskFileMove(const char *szSource, const char *szDest);
+
+UBYTE diskFileDelete(const char *szPath);
+
+#endif // SLIPGATES_TEST_STUB_ACE_DISK_FILE_H
@@ -0,0 +1,25 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_FILE_H
+#define SLIPGATES_TEST_STUB_ACE_FILE_H
+
+#include <ace/types.h>
+
+// Defined by test or by host implementation in stub/file.c
+typedef struct tFile tFile;
+
+#define FILE_SEEK_SET 0
+#define FILE_SEEK_CURRENT 1
+#define FILE_SEEK_END 2
+
+ULONG fileRead(tFile *pFile, void *pDest, ULONG ulSize);
+
+ULONG fileWrite(tFile *pFile, const void *pSrc, ULONG ulSize);
+
+UBYTE fileSeek(tFile *pFile, LONG lPos, WORD wMode);
+
+void fileClose(tFile *pFile);
+
+#endif // SLIPGATES_TEST_STUB_ACE_FILE_H
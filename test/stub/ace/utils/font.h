@@ -0,0 +1,24 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_ACE_FONT_H
+#define SLIPGATES_TEST_STUB_ACE_FONT_H
+
+#include <ace/utils/bitmap.h>
+#include <ace/managers/blit.h>
+
+// Contents aren't used by tested code
+typedef struct tFont tFont;
+
+typedef struct tTextBitMap {
+	tBitMap *pBitMap;
+	UWORD uwActualWidth;
+	UWORD uwActualHeight;
+} tTextBitMap;
+
+tFont *fontCreateFromPath(const char *szPath);
+
+void fontDestroy(tFont *pFont);
+
+#endif // SLIPGATES_TEST_STUB_ACE_FONT_H
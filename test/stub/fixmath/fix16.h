@@ -0,0 +1,15 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_STUB_FIX16_H
+#define SLIPGATES_TEST_STUB_FIX16_H
+
+#include <stdint.h>
+
+typedef int32_t fix16_t;
+
+#define fix16_one 0x00010000
+#define F16(x) ((fix16_t)((x) * fix16_one))
+
+#endif // SLIPGATES_TEST_STUB_FIX16_H
@@ -0,0 +1,40 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#ifndef SLIPGATES_TEST_H
+#define SLIPGATES_TEST_H
+
+#include <stdio.h>
+
+static unsigned g_uTestFailures;
+
+#define TEST_CHECK(isOk) do { \
+	if(!(isOk)) { \
+		++g_uTestFailures; \
+		printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #isOk); \
+	} \
+} while(0)
+
+#define TEST_CHECK_EQUAL(lActual, lExpected) do { \
+	long lTestActual = (long)(lActual); \
+	long lTestExpected = (long)(lExpected); \
+	if(lTestActual != lTestExpected) { \
+		++g_uTestFailures; \
+		printf( \
+			"%s:%d: %s is %ld, expected %ld\n", \
+			__FILE__, __LINE__, #lActual, lTestActual, lTestExpected \
+		); \
+	} \
+} while(0)
+
+static inline int testFinish(void) {
+	if(g_uTestFailures) {
+		printf("%u checks failed\n", g_uTestFailures);
+		return 1;
+	}
+	printf("All checks passed\n");
+	return 0;
+}
+
+#endif // SLIPGATES_TEST_H